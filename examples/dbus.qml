@@ -43,6 +43,59 @@ Window {
         }
     }
 //! [DBusMessage]
+
+//! [DBusBatch]
+    DBusBatch {
+        id: batch
+        
+        DBusMessage {
+            serviceName: "com.nokia.mce"
+            path: "/com/nokia/mce/request"
+            interfaceName: "com.nokia.mce.request"
+            methodName: "get_display_status"
+            timeout: 2000
+            coalesce: true
+        }
+        
+        DBusMessage {
+            serviceName: "com.nokia.mce"
+            path: "/com/nokia/mce/request"
+            interfaceName: "com.nokia.mce.request"
+            methodName: "get_device_mode"
+            timeout: 2000
+            coalesce: true
+        }
+        
+        onStatusChanged: {
+            switch (status) {
+            case DBusMessage.Ready:
+            case DBusMessage.Error:
+                console.log(replies);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+//! [DBusBatch]
+
+//! [DBusPropertyCache]
+    DBusPropertyCache {
+        id: accountManager
+        
+        serviceName: "org.freedesktop.Telepathy.AccountManager"
+        path: "/org/freedesktop/Telepathy/AccountManager"
+        interfaceName: "org.freedesktop.Telepathy.AccountManager"
+    }
+    
+    Label {
+        anchors {
+            top: parent.top
+            horizontalCenter: parent.horizontalCenter
+        }
+        text: qsTr("Accounts") + ": " + (accountManager.properties["ValidAccounts"] ? accountManager.properties["ValidAccounts"].length : 0)
+    }
+//! [DBusPropertyCache]
     
     Button {
         id: button
@@ -54,6 +54,8 @@ public:
     }
     
     void setRoleNames() {
+        resetCache();
+        
         if (!model) {
             return;
         }
@@ -79,6 +81,44 @@ public:
         emit q->roleNamesChanged();
     }
     
+    void resetCache() {
+        Q_Q(QchDeclarativeListModelProxy);
+        const int count = q->rowCount();
+        cache.clear();
+        cache.reserve(count);
+        
+        for (int i = 0; i < count; i++) {
+            cache << QVariantList();
+        }
+    }
+    
+    // Converts all roles of a row in a single call to the source model's get() method.
+    const QVariantList& rowValues(int row) const {
+        QVariantList &values = cache[row];
+        
+        if (!values.isEmpty()) {
+            return values;
+        }
+        
+        QScriptValue val;
+        QMetaObject::invokeMethod(model, "get", Qt::DirectConnection, Q_RETURN_ARG(QScriptValue, val), Q_ARG(int, row));
+        
+        if ((!val.isValid()) || (val.isNull())) {
+            return values;
+        }
+        
+        Q_Q(const QchDeclarativeListModelProxy);
+        const QHash<int, QByteArray> roles = q->roleNames();
+        const int count = roles.size();
+        values.reserve(count);
+        
+        for (int i = 0; i < count; i++) {
+            values << val.property(QString::fromUtf8(roles.value(Qt::UserRole + 1 + i))).toVariant();
+        }
+        
+        return values;
+    }
+    
     void _q_onItemsInserted(int index, int count) {
         Q_Q(QchDeclarativeListModelProxy);
         
@@ -86,6 +126,11 @@ public:
             // Set role names when first items are added
             setRoleNames();
         }
+        else {
+            for (int i = 0; i < count; i++) {
+                cache.insert(index, QVariantList());
+            }
+        }
         
         q->beginInsertRows(QModelIndex(), index, index + count - 1);
         q->endInsertRows();
@@ -94,23 +139,51 @@ public:
     void _q_onItemsRemoved(int index, int count) {
         Q_Q(QchDeclarativeListModelProxy);
         q->beginRemoveRows(QModelIndex(), index, index + count - 1);
+        
+        for (int i = 0; (i < count) && (index < cache.size()); i++) {
+            cache.removeAt(index);
+        }
+        
         q->endRemoveRows();
     }
     
     void _q_onItemsMoved(int from, int to, int count) {
         Q_Q(QchDeclarativeListModelProxy);
         q->beginMoveRows(QModelIndex(), from, from + count - 1, QModelIndex(), to);
+        
+        if ((from + count <= cache.size()) && (to + count <= cache.size())) {
+            QList<QVariantList> moved = cache.mid(from, count);
+            
+            for (int i = 0; i < count; i++) {
+                cache.removeAt(from);
+            }
+            
+            for (int i = 0; i < count; i++) {
+                cache.insert(to + i, moved.at(i));
+            }
+        }
+        else {
+            resetCache();
+        }
+        
         q->endMoveRows();
     }
     
     void _q_onItemsChanged(int index, int count) {
         Q_Q(QchDeclarativeListModelProxy);
+        
+        for (int i = index; (i < index + count) && (i < cache.size()); i++) {
+            cache[i].clear();
+        }
+        
         emit q->dataChanged(q->index(index, 0, QModelIndex()), q->index(index + count - 1, 0, QModelIndex()));
     }
     
     QchDeclarativeListModelProxy *q_ptr;
     QObject *model;
     
+    mutable QList<QVariantList> cache;
+    
     Q_DECLARE_PUBLIC(QchDeclarativeListModelProxy)
 };
 
@@ -146,15 +219,36 @@ QVariant QchDeclarativeListModelProxy::data(const QModelIndex &index, int role)
         return QVariant();
     }
     
-    QScriptValue val;
-    QMetaObject::invokeMethod(sourceModel(), "get", Qt::DirectConnection, Q_RETURN_ARG(QScriptValue, val),
-                              Q_ARG(int, index.row()));
+    Q_D(const QchDeclarativeListModelProxy);
     
-    if ((!val.isValid()) || (val.isNull())) {
+    if (index.row() >= d->cache.size()) {
         return QVariant();
     }
     
-    return val.property(QString::fromUtf8(roleNames().value(role))).toVariant();
+    return d->rowValues(index.row()).value(role - Qt::UserRole - 1);
+}
+
+/*!
+    \brief Converts and caches the values of all roles for the rows from \a start to \a end.
+    
+    Each row that is not cached yet is read with one call to the source model's get() method, 
+    as when it is read by data(). This is used before the rows are sorted, so that the sort 
+    reads only cached values.
+*/
+void QchDeclarativeListModelProxy::fillCache(int start, int end) {
+    if (!sourceModel()) {
+        return;
+    }
+    
+    Q_D(QchDeclarativeListModelProxy);
+    
+    if (end < 0) {
+        end = d->cache.size() - 1;
+    }
+    
+    for (int i = qMax(0, start); i <= qMin(end, d->cache.size() - 1); i++) {
+        d->rowValues(i);
+    }
 }
 
 #include "moc_qchdeclarativelistmodelproxy.cpp"
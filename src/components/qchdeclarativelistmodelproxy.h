@@ -36,6 +36,8 @@ public:
     
     virtual QVariant data(const QModelIndex &index, int role) const;
     
+    void fillCache(int start = 0, int end = -1);
+    
 Q_SIGNALS:
     void roleNamesChanged();
 
@@ -96,12 +96,14 @@ void QchPlugin::registerTypes(const char *uri) {
     qmlRegisterType<QchDialog>(uri, 1, 0, "Dialog");
     qmlRegisterType<QchExclusiveGroup>(uri, 1, 0, "ExclusiveGroup");
     qmlRegisterType<QchFileDialog>(uri, 1, 0, "FileDialog");
+    qmlRegisterType<QchFilterRule>(uri, 1, 0, "FilterRule");
     qmlRegisterType<QchFontMetrics>(uri, 1, 0, "FontMetrics");
     qmlRegisterType<QchInformationBox>(uri, 1, 0, "InformationBox");
     qmlRegisterType<QchMenu>(uri, 1, 0, "Menu");
     qmlRegisterType<QchMenuBar>(uri, 1, 0, "MenuBar");
     qmlRegisterType<QchMenuItem>(uri, 1, 0, "MenuItem");
     qmlRegisterType<QchSortFilterProxyModel>(uri, 1, 0, "SortFilterProxyModel");
+    qmlRegisterType<QchSortRule>(uri, 1, 0, "SortRule");
     qmlRegisterType<QchSyntaxHighlighter>(uri, 1, 0, "SyntaxHighlighter");
     qmlRegisterType<QchSyntaxHighlightRule>(uri, 1, 0, "SyntaxHighlightRule");
     qmlRegisterType<QchTextCharFormat>(uri, 1, 0, "TextCharFormat");
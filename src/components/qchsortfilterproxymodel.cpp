@@ -18,6 +18,794 @@
 #include "qchdeclarativelistmodelproxy.h"
 #include "qchvariantlistmodel.h"
 #include <QDeclarativeInfo>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QTimerEvent>
+#include <QtConcurrentRun>
+#include <algorithm>
+#include <string.h>
+
+// Time (in ms) spent testing rows before control is returned to the event loop.
+static const int FILTER_TIME_SLICE = 10;
+
+// Number of times an asynchronous sort is restarted because the source model changed, before the items are
+// sorted synchronously instead.
+static const int MAX_SORT_RESTARTS = 3;
+
+struct QchSortKey
+{
+    enum Type {
+        Unknown = 0,
+        Invalid,
+        Number,
+        String,
+        Collation
+    };
+    
+    QchSortKey() :
+        type(Unknown),
+        number(0)
+    {
+    }
+    
+    Type type;
+    double number;
+    QString string;
+    QByteArray collation;
+};
+
+// Returns a key that compares with strcmp() as the string compares with QString::localeAwareCompare().
+static QByteArray collationKey(const QString &s) {
+    const QByteArray local = s.toLocal8Bit();
+    const size_t size = strxfrm(0, local.constData(), 0);
+    QByteArray key(int(size) + 1, '\0');
+    strxfrm(key.data(), local.constData(), size + 1);
+    key.resize(int(size));
+    return key;
+}
+
+static QchSortKey sortKey(const QVariant &value, Qt::CaseSensitivity cs, bool localeAware) {
+    QchSortKey key;
+    
+    switch (value.userType()) {
+    case QVariant::Invalid:
+        key.type = QchSortKey::Invalid;
+        break;
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Double:
+    case QMetaType::Float:
+    case QVariant::Char:
+        key.type = QchSortKey::Number;
+        key.number = value.toDouble();
+        break;
+    case QVariant::Date:
+        key.type = QchSortKey::Number;
+        key.number = QDateTime(value.toDate()).toMSecsSinceEpoch();
+        break;
+    case QVariant::Time:
+        key.type = QchSortKey::Number;
+        key.number = QTime(0, 0).msecsTo(value.toTime());
+        break;
+    case QVariant::DateTime:
+        key.type = QchSortKey::Number;
+        key.number = value.toDateTime().toMSecsSinceEpoch();
+        break;
+    default:
+        if (localeAware) {
+            key.type = QchSortKey::Collation;
+            key.collation = collationKey(value.toString());
+        }
+        else {
+            key.type = QchSortKey::String;
+            key.string = cs == Qt::CaseSensitive ? value.toString() : value.toString().toCaseFolded();
+        }
+        
+        break;
+    }
+    
+    return key;
+}
+
+// Returns a negative value, zero or a positive value if a is less than, equal to or greater than b.
+// Keys of different types are ordered by type, so invalid values come first.
+static int compareSortKeys(const QchSortKey &a, const QchSortKey &b) {
+    if (a.type != b.type) {
+        return a.type < b.type ? -1 : 1;
+    }
+    
+    switch (a.type) {
+    case QchSortKey::Number:
+        return a.number < b.number ? -1 : a.number > b.number ? 1 : 0;
+    case QchSortKey::String:
+        return a.string < b.string ? -1 : b.string < a.string ? 1 : 0;
+    case QchSortKey::Collation:
+        return qstrcmp(a.collation, b.collation);
+    default:
+        return 0;
+    }
+}
+
+struct QchSortSpec
+{
+    QchSortSpec() :
+        role(-1),
+        caseSensitivity(Qt::CaseSensitive),
+        localeAware(false),
+        order(Qt::AscendingOrder)
+    {
+    }
+    
+    QchSortSpec(int r, Qt::CaseSensitivity cs, bool la, Qt::SortOrder o) :
+        role(r),
+        caseSensitivity(cs),
+        localeAware(la),
+        order(o)
+    {
+    }
+    
+    bool operator==(const QchSortSpec &other) const {
+        return (role == other.role) && (caseSensitivity == other.caseSensitivity)
+            && (localeAware == other.localeAware) && (order == other.order);
+    }
+    
+    int role;
+    Qt::CaseSensitivity caseSensitivity;
+    bool localeAware;
+    Qt::SortOrder order;
+};
+
+typedef QVector< QVector<QchSortKey> > QchSortKeyTable;
+
+class QchSortKeyLessThan
+{
+
+public:
+    QchSortKeyLessThan(const QchSortKeyTable &keys, const QList<QchSortSpec> &specs) :
+        m_keys(keys),
+        m_specs(specs)
+    {
+    }
+    
+    bool operator()(int left, int right) const {
+        const QVector<QchSortKey> &l = m_keys.at(left);
+        const QVector<QchSortKey> &r = m_keys.at(right);
+        
+        for (int i = 0; i < m_specs.size(); i++) {
+            const int result = compareSortKeys(l.at(i), r.at(i));
+            
+            if (result != 0) {
+                return m_specs.at(i).order == Qt::AscendingOrder ? result < 0 : result > 0;
+            }
+        }
+        
+        return false;
+    }
+
+private:
+    const QchSortKeyTable &m_keys;
+    const QList<QchSortSpec> &m_specs;
+};
+
+// Runs in a worker thread. Returns the sort position of each source row.
+static QVector<int> sortRows(const QchSortKeyTable &keys, const QList<QchSortSpec> &specs) {
+    QVector<int> rows(keys.size());
+    
+    for (int i = 0; i < rows.size(); i++) {
+        rows[i] = i;
+    }
+    
+    qStableSort(rows.begin(), rows.end(), QchSortKeyLessThan(keys, specs));
+    QVector<int> positions(rows.size());
+    
+    for (int i = 0; i < rows.size(); i++) {
+        positions[rows.at(i)] = i;
+    }
+    
+    return positions;
+}
+
+struct QchFilterSpec
+{
+    int role;
+    QchFilterRule::Comparison comparison;
+    Qt::CaseSensitivity caseSensitivity;
+    QchSortKey value;
+    QchSortKey minimum;
+    QchSortKey maximum;
+    QString string;
+    QRegExp regExp;
+    
+    bool matches(const QVariant &v) const {
+        switch (comparison) {
+        case QchFilterRule::Contains:
+            return v.toString().contains(string, caseSensitivity);
+        case QchFilterRule::StartsWith:
+            return v.toString().startsWith(string, caseSensitivity);
+        case QchFilterRule::Wildcard:
+        case QchFilterRule::RegExp:
+            return v.toString().contains(regExp);
+        default:
+            break;
+        }
+        
+        const QchSortKey key = sortKey(v, caseSensitivity, false);
+        
+        if (comparison == QchFilterRule::InRange) {
+            return ((minimum.type == QchSortKey::Invalid)
+                    || ((key.type == minimum.type) && (compareSortKeys(key, minimum) >= 0)))
+                && ((maximum.type == QchSortKey::Invalid)
+                    || ((key.type == maximum.type) && (compareSortKeys(key, maximum) <= 0)));
+        }
+        
+        // Values of different types are never equal, less or greater
+        if (key.type != value.type) {
+            return comparison == QchFilterRule::NotEqual;
+        }
+        
+        const int result = compareSortKeys(key, value);
+        
+        switch (comparison) {
+        case QchFilterRule::Equal:
+            return result == 0;
+        case QchFilterRule::NotEqual:
+            return result != 0;
+        case QchFilterRule::LessThan:
+            return result < 0;
+        case QchFilterRule::LessThanOrEqual:
+            return result <= 0;
+        case QchFilterRule::GreaterThan:
+            return result > 0;
+        case QchFilterRule::GreaterThanOrEqual:
+            return result >= 0;
+        default:
+            return false;
+        }
+    }
+};
+
+class QchFilterRulePrivate
+{
+
+public:
+    QchFilterRulePrivate() :
+        enabled(true),
+        comparison(QchFilterRule::Equal),
+        caseSensitivity(Qt::CaseSensitive)
+    {
+    }
+    
+    bool enabled;
+    
+    QString roleName;
+    
+    QchFilterRule::Comparison comparison;
+    
+    QVariant value;
+    QVariant minimumValue;
+    QVariant maximumValue;
+    
+    Qt::CaseSensitivity caseSensitivity;
+};
+
+/*!
+    \class FilterRule
+    \brief Defines a condition used by a SortFilterProxyModel when filtering items.
+    
+    \ingroup components
+    
+    The FilterRule compares the value of an item's \link role\endlink with the rule's \link value\endlink. 
+    Several rules can be combined using SortFilterProxyModel::filterMode. The rules are compiled by the 
+    SortFilterProxyModel, so no script is evaluated when items are filtered.
+    
+    \sa SortFilterProxyModel, SortRule
+*/
+QchFilterRule::QchFilterRule(QObject *parent) :
+    QObject(parent),
+    d_ptr(new QchFilterRulePrivate)
+{
+}
+
+QchFilterRule::~QchFilterRule() {}
+
+/*!
+    \brief Whether the rule is applied.
+    
+    The default value is \c true.
+*/
+bool QchFilterRule::isEnabled() const {
+    Q_D(const QchFilterRule);
+    return d->enabled;
+}
+
+void QchFilterRule::setEnabled(bool enabled) {
+    if (enabled != isEnabled()) {
+        Q_D(QchFilterRule);
+        d->enabled = enabled;
+        emit enabledChanged();
+        emit changed();
+    }
+}
+
+/*!
+    \property string FilterRule::role
+    \brief The item role whose value is tested by the rule.
+*/
+QString QchFilterRule::roleName() const {
+    Q_D(const QchFilterRule);
+    return d->roleName;
+}
+
+void QchFilterRule::setRoleName(const QString &roleName) {
+    if (roleName != this->roleName()) {
+        Q_D(QchFilterRule);
+        d->roleName = roleName;
+        emit roleChanged();
+        emit changed();
+    }
+}
+
+/*!
+    \brief The comparison used to test the item's value.
+    
+    Possible values are:
+    
+    <table>
+        <tr>
+            <th>Name</th>
+            <th>Description</th>
+        </tr>
+        <tr>
+            <td>FilterRule.Equal</td>
+            <td>The value is equal to \link value\endlink (default).</td>
+        </tr>
+        <tr>
+            <td>FilterRule.NotEqual</td>
+            <td>The value is not equal to \link value\endlink.</td>
+        </tr>
+        <tr>
+            <td>FilterRule.LessThan</td>
+            <td>The value is less than \link value\endlink.</td>
+        </tr>
+        <tr>
+            <td>FilterRule.LessThanOrEqual</td>
+            <td>The value is less than or equal to \link value\endlink.</td>
+        </tr>
+        <tr>
+            <td>FilterRule.GreaterThan</td>
+            <td>The value is greater than \link value\endlink.</td>
+        </tr>
+        <tr>
+            <td>FilterRule.GreaterThanOrEqual</td>
+            <td>The value is greater than or equal to \link value\endlink.</td>
+        </tr>
+        <tr>
+            <td>FilterRule.InRange</td>
+            <td>The value is between \link minimumValue\endlink and \link maximumValue\endlink inclusive.</td>
+        </tr>
+        <tr>
+            <td>FilterRule.Contains</td>
+            <td>The value contains the string \link value\endlink.</td>
+        </tr>
+        <tr>
+            <td>FilterRule.StartsWith</td>
+            <td>The value starts with the string \link value\endlink.</td>
+        </tr>
+        <tr>
+            <td>FilterRule.Wildcard</td>
+            <td>The value matches the wildcard expression \link value\endlink.</td>
+        </tr>
+        <tr>
+            <td>FilterRule.RegExp</td>
+            <td>The value matches the regular expression \link value\endlink.</td>
+        </tr>
+    </table>
+    
+    Numbers, dates and times are compared numerically. Values of different types are never equal.
+*/
+QchFilterRule::Comparison QchFilterRule::comparison() const {
+    Q_D(const QchFilterRule);
+    return d->comparison;
+}
+
+void QchFilterRule::setComparison(QchFilterRule::Comparison comparison) {
+    if (comparison != this->comparison()) {
+        Q_D(QchFilterRule);
+        d->comparison = comparison;
+        emit comparisonChanged();
+        emit changed();
+    }
+}
+
+/*!
+    \brief The value that the item's value is compared with.
+    
+    \sa comparison
+*/
+QVariant QchFilterRule::value() const {
+    Q_D(const QchFilterRule);
+    return d->value;
+}
+
+void QchFilterRule::setValue(const QVariant &value) {
+    if (value != this->value()) {
+        Q_D(QchFilterRule);
+        d->value = value;
+        emit valueChanged();
+        emit changed();
+    }
+}
+
+/*!
+    \brief The lower bound used when comparison is \c FilterRule.InRange.
+    
+    If no value is set, there is no lower bound.
+    
+    \sa maximumValue
+*/
+QVariant QchFilterRule::minimumValue() const {
+    Q_D(const QchFilterRule);
+    return d->minimumValue;
+}
+
+void QchFilterRule::setMinimumValue(const QVariant &value) {
+    if (value != minimumValue()) {
+        Q_D(QchFilterRule);
+        d->minimumValue = value;
+        emit minimumValueChanged();
+        emit changed();
+    }
+}
+
+/*!
+    \brief The upper bound used when comparison is \c FilterRule.InRange.
+    
+    If no value is set, there is no upper bound.
+    
+    \sa minimumValue
+*/
+QVariant QchFilterRule::maximumValue() const {
+    Q_D(const QchFilterRule);
+    return d->maximumValue;
+}
+
+void QchFilterRule::setMaximumValue(const QVariant &value) {
+    if (value != maximumValue()) {
+        Q_D(QchFilterRule);
+        d->maximumValue = value;
+        emit maximumValueChanged();
+        emit changed();
+    }
+}
+
+/*!
+    \brief The case sensitivity used when comparing strings.
+    
+    The default value is \c Qt.CaseSensitive.
+*/
+Qt::CaseSensitivity QchFilterRule::caseSensitivity() const {
+    Q_D(const QchFilterRule);
+    return d->caseSensitivity;
+}
+
+void QchFilterRule::setCaseSensitivity(Qt::CaseSensitivity cs) {
+    if (cs != caseSensitivity()) {
+        Q_D(QchFilterRule);
+        d->caseSensitivity = cs;
+        emit caseSensitivityChanged();
+        emit changed();
+    }
+}
+
+class QchSortRulePrivate
+{
+
+public:
+    QchSortRulePrivate() :
+        enabled(true),
+        order(Qt::AscendingOrder),
+        caseSensitivity(Qt::CaseSensitive)
+    {
+    }
+    
+    bool enabled;
+    
+    QString roleName;
+    
+    Qt::SortOrder order;
+    
+    Qt::CaseSensitivity caseSensitivity;
+};
+
+/*!
+    \class SortRule
+    \brief Defines a key used by a SortFilterProxyModel when sorting items.
+    
+    \ingroup components
+    
+    When a SortFilterProxyModel has several sort rules, items are compared using each rule in turn until they 
+    differ, and each rule has its own \link order\endlink.
+    
+    \sa SortFilterProxyModel, FilterRule
+*/
+QchSortRule::QchSortRule(QObject *parent) :
+    QObject(parent),
+    d_ptr(new QchSortRulePrivate)
+{
+}
+
+QchSortRule::~QchSortRule() {}
+
+/*!
+    \brief Whether the rule is applied.
+    
+    The default value is \c true.
+*/
+bool QchSortRule::isEnabled() const {
+    Q_D(const QchSortRule);
+    return d->enabled;
+}
+
+void QchSortRule::setEnabled(bool enabled) {
+    if (enabled != isEnabled()) {
+        Q_D(QchSortRule);
+        d->enabled = enabled;
+        emit enabledChanged();
+        emit changed();
+    }
+}
+
+/*!
+    \property string SortRule::role
+    \brief The item role whose value is used as the sort key.
+*/
+QString QchSortRule::roleName() const {
+    Q_D(const QchSortRule);
+    return d->roleName;
+}
+
+void QchSortRule::setRoleName(const QString &roleName) {
+    if (roleName != this->roleName()) {
+        Q_D(QchSortRule);
+        d->roleName = roleName;
+        emit roleChanged();
+        emit changed();
+    }
+}
+
+/*!
+    \brief The order in which items are sorted by the rule.
+    
+    The default value is \c Qt.AscendingOrder.
+*/
+Qt::SortOrder QchSortRule::order() const {
+    Q_D(const QchSortRule);
+    return d->order;
+}
+
+void QchSortRule::setOrder(Qt::SortOrder order) {
+    if (order != this->order()) {
+        Q_D(QchSortRule);
+        d->order = order;
+        emit orderChanged();
+        emit changed();
+    }
+}
+
+/*!
+    \brief The case sensitivity used when comparing strings.
+    
+    The default value is \c Qt.CaseSensitive.
+*/
+Qt::CaseSensitivity QchSortRule::caseSensitivity() const {
+    Q_D(const QchSortRule);
+    return d->caseSensitivity;
+}
+
+void QchSortRule::setCaseSensitivity(Qt::CaseSensitivity cs) {
+    if (cs != caseSensitivity()) {
+        Q_D(QchSortRule);
+        d->caseSensitivity = cs;
+        emit caseSensitivityChanged();
+        emit changed();
+    }
+}
+
+class QchFilterIndex
+{
+
+public:
+    QchFilterIndex() :
+        valid(false),
+        caseSensitivity(Qt::CaseSensitive),
+        deadCount(0)
+    {
+    }
+    
+    void clear() {
+        valid = false;
+        rowIds.clear();
+        idRows.clear();
+        idTexts.clear();
+        postings.clear();
+        deadCount = 0;
+    }
+    
+    int size() const {
+        return rowIds.size();
+    }
+    
+    const QString& text(int row) const {
+        return idTexts.at(rowIds.at(row));
+    }
+    
+    void insertRows(int start, const QStringList &texts) {
+        const int count = texts.size();
+        rowIds.insert(start, count, -1);
+        
+        for (int i = 0; i < count; i++) {
+            rowIds[start + i] = addText(texts.at(i));
+        }
+        
+        updateRows(start + count);
+    }
+    
+    void removeRows(int start, int count) {
+        for (int i = start; i < start + count; i++) {
+            removeId(rowIds.at(i));
+        }
+        
+        rowIds.remove(start, count);
+        updateRows(start);
+        
+        if (deadCount > rowIds.size()) {
+            compact();
+        }
+    }
+    
+    void setText(int row, const QString &text) {
+        removeId(rowIds.at(row));
+        rowIds[row] = addText(text);
+        idRows[rowIds.at(row)] = row;
+        
+        // Every change retires an id, so frequently changing rows would otherwise grow the index without bound
+        if (deadCount > rowIds.size()) {
+            compact();
+        }
+    }
+    
+    // Returns the rows whose text contains pattern. Trigram posting lists narrow the candidates for patterns of
+    // three or more characters, and every candidate is verified against the stored text.
+    QList<int> rowsContaining(const QString &pattern) const {
+        const QString p = fold(pattern);
+        QList<int> rows;
+        
+        if (p.size() < 3) {
+            for (int i = 0; i < rowIds.size(); i++) {
+                if (idTexts.at(rowIds.at(i)).contains(p)) {
+                    rows << i;
+                }
+            }
+            
+            return rows;
+        }
+        
+        const QVector<int> *candidates = 0;
+        
+        for (int i = 0; i + 2 < p.size(); i++) {
+            QHash<quint64, QVector<int> >::const_iterator iterator = postings.constFind(trigram(p.constData() + i));
+            
+            if (iterator == postings.constEnd()) {
+                return rows;
+            }
+            
+            if ((!candidates) || (iterator.value().size() < candidates->size())) {
+                candidates = &iterator.value();
+            }
+        }
+        
+        foreach (const int id, *candidates) {
+            const int row = idRows.at(id);
+            
+            if ((row >= 0) && (idTexts.at(id).contains(p))) {
+                rows << row;
+            }
+        }
+        
+        return rows;
+    }
+    
+    bool valid;
+    
+    Qt::CaseSensitivity caseSensitivity;
+
+private:
+    static quint64 trigram(const QChar *c) {
+        return (quint64(c[0].unicode()) << 32) | (quint64(c[1].unicode()) << 16) | quint64(c[2].unicode());
+    }
+    
+    QString fold(const QString &text) const {
+        return caseSensitivity == Qt::CaseSensitive ? text : text.toCaseFolded();
+    }
+    
+    int addText(const QString &text) {
+        const int id = idTexts.size();
+        const QString folded = fold(text);
+        idTexts << folded;
+        idRows << -1;
+        
+        for (int i = 0; i + 2 < folded.size(); i++) {
+            QVector<int> &ids = postings[trigram(folded.constData() + i)];
+            
+            if ((ids.isEmpty()) || (ids.last() != id)) {
+                ids << id;
+            }
+        }
+        
+        return id;
+    }
+    
+    void removeId(int id) {
+        // Posting lists are not updated. Dead ids are skipped when looking up rows, and purged by compact().
+        idRows[id] = -1;
+        idTexts[id] = QString();
+        deadCount++;
+    }
+    
+    void updateRows(int start) {
+        for (int i = start; i < rowIds.size(); i++) {
+            idRows[rowIds.at(i)] = i;
+        }
+    }
+    
+    void compact() {
+        QVector<QString> texts;
+        texts.reserve(rowIds.size());
+        
+        for (int i = 0; i < rowIds.size(); i++) {
+            texts << idTexts.at(rowIds.at(i));
+        }
+        
+        const Qt::CaseSensitivity cs = caseSensitivity;
+        clear();
+        // The texts are already folded
+        caseSensitivity = Qt::CaseSensitive;
+        
+        for (int i = 0; i < texts.size(); i++) {
+            rowIds << addText(texts.at(i));
+        }
+        
+        updateRows(0);
+        caseSensitivity = cs;
+        valid = true;
+    }
+    
+    QVector<int> rowIds;
+    QVector<int> idRows;
+    QVector<QString> idTexts;
+    QHash<quint64, QVector<int> > postings;
+    int deadCount;
+};
+
+class QchSortFilterProxyModelPrivate;
+
+class QchWindowLessThan
+{
+
+public:
+    explicit QchWindowLessThan(const QchSortFilterProxyModelPrivate *d) :
+        m_d(d)
+    {
+    }
+    
+    inline bool operator()(int left, int right) const;
+
+private:
+    const QchSortFilterProxyModelPrivate *m_d;
+};
 
 class QchSortFilterProxyModelPrivate
 {
@@ -29,76 +817,1057 @@ public:
         sortRoleName("modelData"),
         sortColumn(0),
         sortOrder(Qt::AscendingOrder),
+        filterSyntax(QRegExp::FixedString),
+        filterStateRole(-1),
+        filterStateColumn(0),
+        filterStateCaseSensitivity(Qt::CaseSensitive),
+        filterTimerId(0),
+        filterPosition(0),
+        filtering(false),
+        filterIndexed(false),
+        sortKeyColumn(0),
+        sourceRevision(0),
+        sortRevision(0),
+        sortRestarts(0),
+        asynchronousSort(false),
+        sorting(false),
+        filterMode(QchSortFilterProxyModel::MatchAll),
+        limit(-1),
+        offset(0),
+        windowValid(false),
+        windowUpdatePending(false),
         ownModel(false),
         complete(false)
     {
     }
     
-    void loadSourceModel() {                
+    enum FilterState {
+        Unknown = 0,
+        Rejected,
+        Accepted
+    };
+    
+    enum FilterChange {
+        Unrelated = 0,
+        Narrowing,
+        Widening
+    };
+    
+    enum WindowState {
+        WindowUnknown = 0,
+        OutsideWindow,
+        InsideWindow
+    };
+    
+    void loadSourceModel() {                
+        Q_Q(QchSortFilterProxyModel);
+        QAbstractItemModel *oldModel = q->sourceModel();
+                
+        if (QObject *obj = qvariant_cast<QObject*>(sourceModelVariant)) {
+            if (QAbstractItemModel *itemModel = qobject_cast<QAbstractItemModel*>(obj)) {
+                q->setSourceModel(itemModel);
+                
+                if ((ownModel) && (oldModel)) {
+                    oldModel->deleteLater();
+                }
+                
+                ownModel = false;
+            }
+            else if ((obj->inherits("QDeclarativeListModel")) || (obj->inherits("QDeclarativeXmlListModel"))) {
+                QchDeclarativeListModelProxy *proxy = new QchDeclarativeListModelProxy(q);
+                proxy->setSourceModel(obj);
+                q->setSourceModel(proxy);
+                q->connect(proxy, SIGNAL(roleNamesChanged()), q, SLOT(_q_updateRoleNames()));
+                
+                if ((ownModel) && (oldModel)) {
+                    oldModel->deleteLater();
+                }
+                
+                ownModel = true;
+            }
+            else {
+                qmlInfo(q) << QchSortFilterProxyModel::tr("Source model type is not supported");
+                return;
+            }
+        }
+        else {
+            QchVariantListModel *model = new QchVariantListModel(q);            
+            model->setSourceVariant(sourceModelVariant);
+            q->setSourceModel(model);
+            
+            if ((ownModel) && (oldModel)) {
+                oldModel->deleteLater();
+            }
+            
+            ownModel = true;
+        }
+        
+        q->setFilterRole(q->roleNames().key(filterRoleName.toUtf8()));
+        q->setSortRole(q->roleNames().key(sortRoleName.toUtf8()));
+        
+        if (q->dynamicSortFilter()) {
+            q->sort();
+        }
+    }
+
+    void _q_updateRoleNames() {
+        Q_Q(QchSortFilterProxyModel);
+
+        if (!q->sourceModel()) {
+            return;
+        }
+
+        q->setRoleNames(q->sourceModel()->roleNames());
+        q->setFilterRole(q->sourceModel()->roleNames().key(filterRoleName.toUtf8()));
+        q->setSortRole(q->sourceModel()->roleNames().key(sortRoleName.toUtf8()));
+        
+        if ((!filterRules.isEmpty()) || (!sortRules.isEmpty())) {
+            compileRules(q->sourceModel());
+            refilter();
+        }
+
+        if (q->dynamicSortFilter()) {
+            q->sort();
+        }
+    }
+    
+    void connectSourceModel(QAbstractItemModel *model) {
+        if (!model) {
+            return;
+        }
+        
+        Q_Q(QchSortFilterProxyModel);
+        q->connect(model, SIGNAL(rowsAboutToBeInserted(QModelIndex, int, int)),
+                   q, SLOT(_q_onSourceRowsAboutToBeInserted(QModelIndex, int, int)));
+        q->connect(model, SIGNAL(rowsInserted(QModelIndex, int, int)),
+                   q, SLOT(_q_onSourceRowsInserted(QModelIndex, int, int)));
+        q->connect(model, SIGNAL(rowsRemoved(QModelIndex, int, int)),
+                   q, SLOT(_q_onSourceRowsRemoved(QModelIndex, int, int)));
+        q->connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)),
+                   q, SLOT(_q_onSourceDataChanged(QModelIndex, QModelIndex)));
+        q->connect(model, SIGNAL(rowsAboutToBeMoved(QModelIndex, int, int, QModelIndex, int)),
+                   q, SLOT(_q_resetRowCaches()));
+        q->connect(model, SIGNAL(layoutAboutToBeChanged()), q, SLOT(_q_resetRowCaches()));
+        q->connect(model, SIGNAL(modelAboutToBeReset()), q, SLOT(_q_resetRowCaches()));
+    }
+    
+    void disconnectSourceModel(QAbstractItemModel *model) {
+        if (!model) {
+            return;
+        }
+        
+        Q_Q(QchSortFilterProxyModel);
+        model->disconnect(q, SLOT(_q_onSourceRowsAboutToBeInserted(QModelIndex, int, int)));
+        model->disconnect(q, SLOT(_q_onSourceRowsInserted(QModelIndex, int, int)));
+        model->disconnect(q, SLOT(_q_onSourceRowsRemoved(QModelIndex, int, int)));
+        model->disconnect(q, SLOT(_q_onSourceDataChanged(QModelIndex, QModelIndex)));
+        model->disconnect(q, SLOT(_q_resetRowCaches()));
+    }
+    
+    FilterChange filterChange(const QString &pattern, QRegExp::PatternSyntax syntax) const {
+        if ((syntax != filterSyntax) || (filterPattern.isEmpty())) {
+            return Unrelated;
+        }
+        
+        if (pattern.isEmpty()) {
+            return Widening;
+        }
+        
+        if ((syntax != QRegExp::FixedString) && (syntax != QRegExp::Wildcard)) {
+            return Unrelated;
+        }
+        
+        Q_Q(const QchSortFilterProxyModel);
+        const Qt::CaseSensitivity cs = q->filterCaseSensitivity();
+        
+        if (syntax == QRegExp::FixedString) {
+            // Any row matching the longer string also matches the shorter one
+            if (pattern.contains(filterPattern, cs)) {
+                return Narrowing;
+            }
+            
+            if (filterPattern.contains(pattern, cs)) {
+                return Widening;
+            }
+            
+            return Unrelated;
+        }
+        
+        // Appending to a wildcard expression can only narrow the matches, provided that the shorter expression
+        // does not end inside an escape sequence or a character set
+        if ((filterPattern.contains(QLatin1Char('['))) || (filterPattern.contains(QLatin1Char('\\')))
+            || (pattern.contains(QLatin1Char('['))) || (pattern.contains(QLatin1Char('\\')))) {
+            return Unrelated;
+        }
+        
+        if (pattern.startsWith(filterPattern, cs)) {
+            return Narrowing;
+        }
+        
+        if (filterPattern.startsWith(pattern, cs)) {
+            return Widening;
+        }
+        
+        return Unrelated;
+    }
+    
+    void setFilterPattern(const QString &pattern, QRegExp::PatternSyntax syntax) {
+        if ((pattern == filterPattern) && (syntax == filterSyntax)) {
+            return;
+        }
+        
+        Q_Q(QchSortFilterProxyModel);
+        
+        if (!q->sourceModel()) {
+            filterPattern = pattern;
+            filterSyntax = syntax;
+            filterRegExp = QRegExp(pattern, q->filterCaseSensitivity(), syntax);
+            return;
+        }
+        
+        validateFilterStates();
+        syncFilterStates();
+        
+        if (pattern.isEmpty()) {
+            // Every row is accepted when there is no pattern
+            filterStates.fill(Accepted);
+        }
+        else if ((syntax == QRegExp::FixedString) && (ensureFilterIndex())) {
+            // The matching rows are looked up in the index, so no rows need to be tested
+            filterStates.fill(Rejected);
+            
+            foreach (const int row, filterIndex.rowsContaining(pattern)) {
+                if (row < filterStates.size()) {
+                    filterStates[row] = Accepted;
+                }
+            }
+        }
+        else {
+            const FilterChange change = filterChange(pattern, syntax);
+            
+            // Only rows whose state may differ under the new pattern are retested
+            for (int i = 0; i < filterStates.size(); i++) {
+                char &state = filterStates[i];
+                
+                switch (change) {
+                case Narrowing:
+                    if (state == Accepted) {
+                        state = Unknown;
+                    }
+                    
+                    break;
+                case Widening:
+                    if (state == Rejected) {
+                        state = Unknown;
+                    }
+                    
+                    break;
+                default:
+                    state = Unknown;
+                    break;
+                }
+            }
+        }
+        
+        filterPattern = pattern;
+        filterSyntax = syntax;
+        filterRegExp = QRegExp(pattern, q->filterCaseSensitivity(), syntax);
+        filterPosition = 0;
+        
+        if (filterTimerId != 0) {
+            q->killTimer(filterTimerId);
+            filterTimerId = 0;
+        }
+        
+        processFilterStates();
+    }
+    
+    // Tests rows with an unknown state until the time slice is used up, then continues from the event loop.
+    void processFilterStates() {
+        Q_Q(QchSortFilterProxyModel);
+        QElapsedTimer timer;
+        timer.start();
+        syncFilterStates();
+        
+        while (filterPosition < filterStates.size()) {
+            char &state = filterStates[filterPosition];
+            
+            if (state == Unknown) {
+                state = testRow(filterPosition, QModelIndex()) ? Accepted : Rejected;
+                
+                // The clock is read after every tested row, since a row of a script model can be slow to read
+                if (timer.elapsed() >= FILTER_TIME_SLICE) {
+                    filterPosition++;
+                    
+                    if (filterTimerId == 0) {
+                        filterTimerId = q->startTimer(0);
+                    }
+                    
+                    setFiltering(true);
+                    return;
+                }
+            }
+            
+            filterPosition++;
+        }
+        
+        if (filterTimerId != 0) {
+            q->killTimer(filterTimerId);
+            filterTimerId = 0;
+        }
+        
+        // All states are known, so the proxy mapping is rebuilt without querying the source model
+        refilter();
+        setFiltering(false);
+        emit q->filterFinished();
+    }
+    
+    void setFiltering(bool isFiltering) {
+        if (isFiltering != filtering) {
+            Q_Q(QchSortFilterProxyModel);
+            filtering = isFiltering;
+            emit q->filteringChanged();
+        }
+    }
+    
+    bool testRow(int row, const QModelIndex &parent) const {
+        if ((filterIndex.valid) && (filterSyntax == QRegExp::FixedString) && (!parent.isValid())
+            && (row < filterIndex.size())) {
+            return filterIndex.text(row).contains(filterPattern, filterIndex.caseSensitivity);
+        }
+        
+        Q_Q(const QchSortFilterProxyModel);
+        const QAbstractItemModel *model = q->sourceModel();
+        const int column = q->filterKeyColumn();
+        const int role = q->filterRole();
+        
+        if (column == -1) {
+            const int columns = model->columnCount(parent);
+            
+            for (int i = 0; i < columns; i++) {
+                if (model->index(row, i, parent).data(role).toString().contains(filterRegExp)) {
+                    return true;
+                }
+            }
+            
+            return false;
+        }
+        
+        return model->index(row, column, parent).data(role).toString().contains(filterRegExp);
+    }
+    
+    bool acceptsRow(int row, const QModelIndex &parent) const {
+        if (filterPattern.isEmpty()) {
+            return true;
+        }
+        
+        if (parent.isValid()) {
+            return testRow(row, parent);
+        }
+        
+        validateFilterStates();
+        
+        if (row >= filterStates.size()) {
+            syncFilterStates();
+            
+            if (row >= filterStates.size()) {
+                return testRow(row, parent);
+            }
+        }
+        
+        char &state = filterStates[row];
+        
+        if (state == Unknown) {
+            state = testRow(row, parent) ? Accepted : Rejected;
+        }
+        
+        return state == Accepted;
+    }
+    
+    // Discards the filter states if the role, column or case sensitivity have changed since they were computed.
+    void validateFilterStates() const {
+        Q_Q(const QchSortFilterProxyModel);
+        const int role = q->filterRole();
+        const int column = q->filterKeyColumn();
+        const Qt::CaseSensitivity cs = q->filterCaseSensitivity();
+        
+        if ((role != filterStateRole) || (column != filterStateColumn) || (cs != filterStateCaseSensitivity)) {
+            filterStateRole = role;
+            filterStateColumn = column;
+            filterStateCaseSensitivity = cs;
+            filterRegExp.setCaseSensitivity(cs);
+            filterStates.fill(Unknown);
+            filterPosition = 0;
+            filterIndex.clear();
+            windowValid = false;
+        }
+    }
+    
+    QString filterText(int row) const {
+        Q_Q(const QchSortFilterProxyModel);
+        return q->sourceModel()->index(row, filterStateColumn).data(filterStateRole).toString();
+    }
+    
+    // Builds the filter index if enabled. Returns true if the index can be used.
+    bool ensureFilterIndex() {
+        if ((!filterIndexed) || (filterStateColumn < 0)) {
+            return false;
+        }
+        
+        if (!filterIndex.valid) {
+            Q_Q(QchSortFilterProxyModel);
+            const int count = q->sourceModel()->rowCount();
+            QStringList texts;
+            texts.reserve(count);
+            
+            for (int i = 0; i < count; i++) {
+                texts << filterText(i);
+            }
+            
+            filterIndex.clear();
+            filterIndex.caseSensitivity = filterStateCaseSensitivity;
+            filterIndex.insertRows(0, texts);
+            filterIndex.valid = true;
+        }
+        
+        return true;
+    }
+    
+    void syncFilterStates() const {
+        Q_Q(const QchSortFilterProxyModel);
+        const int count = q->sourceModel() ? q->sourceModel()->rowCount() : 0;
+        
+        if (count > filterStates.size()) {
+            filterStates.insert(filterStates.size(), count - filterStates.size(), Unknown);
+        }
+        else if (count < filterStates.size()) {
+            filterStates.resize(count);
+        }
+    }
+    
+    // Discards the sort keys if the sort rules, role, column, case sensitivity or locale awareness have changed
+    // since they were computed. The source model is only queried when the keys are discarded, since the keys
+    // follow the source rows as they are inserted and removed.
+    void validateSortKeys(int column) const {
+        Q_Q(const QchSortFilterProxyModel);
+        bool valid = column == sortKeyColumn;
+        
+        if (sortSpecs.isEmpty()) {
+            // The order is applied by QSortFilterProxyModel when there are no sort rules
+            const QchSortSpec spec(q->sortRole(), q->sortCaseSensitivity(), q->isSortLocaleAware(),
+                                   Qt::AscendingOrder);
+            
+            if ((!valid) || (sortKeySpecs.size() != 1) || (!(sortKeySpecs.first() == spec))) {
+                valid = false;
+                sortKeySpecs.clear();
+                sortKeySpecs << spec;
+            }
+        }
+        else if ((!valid) || (!(sortKeySpecs == sortSpecs))) {
+            valid = false;
+            sortKeySpecs = sortSpecs;
+        }
+        
+        if (!valid) {
+            sortKeyColumn = column;
+            sortKeys.clear();
+            sortKeys.resize(q->sourceModel() ? q->sourceModel()->rowCount() : 0);
+        }
+    }
+    
+    const QchSortKey& sortKeyAt(int row, int spec) const {
+        QVector<QchSortKey> &keys = sortKeys[row];
+        
+        if (keys.size() != sortKeySpecs.size()) {
+            keys.resize(sortKeySpecs.size());
+        }
+        
+        QchSortKey &key = keys[spec];
+        
+        if (key.type == QchSortKey::Unknown) {
+            Q_Q(const QchSortFilterProxyModel);
+            const QchSortSpec &s = sortKeySpecs.at(spec);
+            key = sortKey(q->sourceModel()->index(row, sortKeyColumn).data(s.role), s.caseSensitivity,
+                          s.localeAware);
+        }
+        
+        return key;
+    }
+    
+    // Compares the cached keys of two source rows. Returns false in ok if the keys cannot be compared directly.
+    bool sortKeyLessThan(const QModelIndex &left, const QModelIndex &right, bool *ok) const {
+        *ok = false;
+        
+        if ((left.parent().isValid()) || (right.parent().isValid()) || (left.column() != right.column())) {
+            return false;
+        }
+        
+        if (!sortPositions.isEmpty()) {
+            // Applying the result of an asynchronous sort
+            if ((left.row() < sortPositions.size()) && (right.row() < sortPositions.size())) {
+                *ok = true;
+                return sortPositions.at(left.row()) < sortPositions.at(right.row());
+            }
+            
+            return false;
+        }
+        
+        validateSortKeys(left.column());
+        
+        if ((left.row() >= sortKeys.size()) || (right.row() >= sortKeys.size())) {
+            return false;
+        }
+        
+        for (int i = 0; i < sortKeySpecs.size(); i++) {
+            const QchSortKey &l = sortKeyAt(left.row(), i);
+            const QchSortKey &r = sortKeyAt(right.row(), i);
+            
+            // Keys of different types are ordered by type, as they are by an asynchronous sort
+            const int result = compareSortKeys(l, r);
+            
+            if (result != 0) {
+                *ok = true;
+                return sortKeySpecs.at(i).order == Qt::AscendingOrder ? result < 0 : result > 0;
+            }
+        }
+        
+        *ok = true;
+        return false;
+    }
+    
+    // Computes the keys of all rows in the GUI thread and sorts them in a worker thread.
+    void startAsynchronousSort() {
         Q_Q(QchSortFilterProxyModel);
-        QAbstractItemModel *oldModel = q->sourceModel();
-                
-        if (QObject *obj = qvariant_cast<QObject*>(sourceModelVariant)) {
-            if (QAbstractItemModel *itemModel = qobject_cast<QAbstractItemModel*>(obj)) {
-                q->setSourceModel(itemModel);
-                
-                if ((ownModel) && (oldModel)) {
-                    oldModel->deleteLater();
+        validateSortKeys(sortColumn);
+        
+        for (int row = 0; row < sortKeys.size(); row++) {
+            for (int i = 0; i < sortKeySpecs.size(); i++) {
+                sortKeyAt(row, i);
+            }
+        }
+        
+        sortRevision = sourceRevision;
+        
+        if (!sortWatcher) {
+            sortWatcher.reset(new QFutureWatcher< QVector<int> >);
+            q->connect(sortWatcher.data(), SIGNAL(finished()), q, SLOT(_q_onSortFinished()));
+        }
+        
+        // Replacing the future discards the result of a sort that is still running
+        sortWatcher->setFuture(QtConcurrent::run(sortRows, QchSortKeyTable(sortKeys),
+                                                 QList<QchSortSpec>(sortKeySpecs)));
+        setSorting(true);
+    }
+    
+    void setSorting(bool isSorting) {
+        if (isSorting != sorting) {
+            Q_Q(QchSortFilterProxyModel);
+            sorting = isSorting;
+            emit q->sortingChanged();
+        }
+    }
+    
+    void _q_onSortFinished() {
+        Q_Q(QchSortFilterProxyModel);
+        
+        if (sortRevision != sourceRevision) {
+            // The source model has changed since the keys were computed
+            if (sortRestarts < MAX_SORT_RESTARTS) {
+                sortRestarts++;
+                startAsynchronousSort();
+                return;
+            }
+            
+            // The source model keeps changing, so the items are sorted with the current keys instead
+            validateSortKeys(sortColumn);
+            applySort();
+        }
+        else {
+            // Apply the positions with a single layout change. The comparisons are now integer compares.
+            sortPositions = sortWatcher->result();
+            applySort();
+            sortPositions.clear();
+        }
+        
+        sortRestarts = 0;
+        
+        if (isWindowed()) {
+            refilter();
+        }
+        
+        setSorting(false);
+        emit q->sortFinished();
+    }
+    
+    // Sorts the items by sortColumn and sortOrder. QSortFilterProxyModel::sort() does nothing when dynamicSortFilter
+    // is enabled and the column and order are unchanged, so in that case the mapping is rebuilt, which sorts the
+    // items again with a single layout change.
+    void applySort() {
+        Q_Q(QchSortFilterProxyModel);
+        const Qt::SortOrder order = sortSpecs.isEmpty() ? sortOrder : Qt::AscendingOrder;
+        
+        if ((q->dynamicSortFilter()) && (sortColumn == q->QSortFilterProxyModel::sortColumn())
+            && (order == q->QSortFilterProxyModel::sortOrder())) {
+            q->invalidate();
+            // Build the mapping now, while the sort positions are set
+            q->rowCount();
+        }
+        else {
+            q->QSortFilterProxyModel::sort(sortColumn, order);
+        }
+    }
+    
+    // Refilters the rows, recomputing the window if limit or offset are set.
+    void refilter() {
+        Q_Q(QchSortFilterProxyModel);
+        windowValid = false;
+        q->invalidateFilter();
+    }
+    
+    bool isWindowed() const {
+        return (limit >= 0) || (offset > 0);
+    }
+    
+    // Orders source rows as they are sorted by the proxy, with ties broken by source row.
+    bool windowLessThan(int left, int right) const {
+        Q_Q(const QchSortFilterProxyModel);
+        const int column = q->QSortFilterProxyModel::sortColumn();
+        
+        if (column >= 0) {
+            const QModelIndex l = q->sourceModel()->index(left, column);
+            const QModelIndex r = q->sourceModel()->index(right, column);
+            
+            if (q->QSortFilterProxyModel::sortOrder() == Qt::AscendingOrder) {
+                if (q->lessThan(l, r)) {
+                    return true;
                 }
                 
-                ownModel = false;
+                if (q->lessThan(r, l)) {
+                    return false;
+                }
             }
-            else if ((obj->inherits("QDeclarativeListModel")) || (obj->inherits("QDeclarativeXmlListModel"))) {
-                QchDeclarativeListModelProxy *proxy = new QchDeclarativeListModelProxy(q);
-                proxy->setSourceModel(obj);
-                q->setSourceModel(proxy);
-                q->connect(proxy, SIGNAL(roleNamesChanged()), q, SLOT(_q_updateRoleNames()));
-                
-                if ((ownModel) && (oldModel)) {
-                    oldModel->deleteLater();
+            else {
+                if (q->lessThan(r, l)) {
+                    return true;
                 }
                 
-                ownModel = true;
+                if (q->lessThan(l, r)) {
+                    return false;
+                }
+            }
+        }
+        
+        return left < right;
+    }
+    
+    // Selects the accepted rows from offset to offset + limit in sort order. Only the rows at the window
+    // boundaries are partitioned, so the accepted rows are not fully sorted.
+    void computeWindow() const {
+        Q_Q(const QchSortFilterProxyModel);
+        const int count = q->sourceModel() ? q->sourceModel()->rowCount() : 0;
+        QVector<int> rows;
+        windowStates.fill(OutsideWindow, count);
+        windowStart = QPersistentModelIndex();
+        windowEnd = QPersistentModelIndex();
+        windowValid = true;
+        
+        for (int i = 0; i < count; i++) {
+            if ((q->QSortFilterProxyModel::filterAcceptsRow(i, QModelIndex())) && (acceptsRow(i, QModelIndex()))
+                && (rulesAcceptRow(i, QModelIndex()))) {
+                rows << i;
+            }
+        }
+        
+        const int first = qMin(offset, rows.size());
+        const int last = limit < 0 ? rows.size() : qMin(rows.size(), first + limit);
+        const QchWindowLessThan lessThan(this);
+        
+        if (last < rows.size()) {
+            // The rows before last are not ordered, so the end of the window is the greatest of all of them
+            std::nth_element(rows.begin(), rows.begin() + last, rows.end(), lessThan);
+            
+            if (last > 0) {
+                windowEnd = q->sourceModel()->index(*std::max_element(rows.begin(), rows.begin() + last, lessThan),
+                                                    0);
+            }
+        }
+        
+        if (first > 0) {
+            std::nth_element(rows.begin(), rows.begin() + first, rows.begin() + last, lessThan);
+            
+            if (first < last) {
+                windowStart = q->sourceModel()->index(*std::min_element(rows.begin() + first,
+                                                                        rows.begin() + last, lessThan), 0);
+            }
+        }
+        
+        for (int i = first; i < last; i++) {
+            windowStates[rows.at(i)] = InsideWindow;
+        }
+    }
+    
+    bool windowAcceptsRow(int row, const QModelIndex &parent) const {
+        if ((!isWindowed()) || (parent.isValid())) {
+            return true;
+        }
+        
+        if (!windowValid) {
+            computeWindow();
+        }
+        
+        if (row >= windowStates.size()) {
+            return false;
+        }
+        
+        char &state = windowStates[row];
+        
+        if (state == WindowUnknown) {
+            // A row sorted after the end of a full window does not affect it, so the view is not changed
+            if ((windowEnd.isValid()) && (windowLessThan(windowEnd.row(), row))) {
+                state = OutsideWindow;
             }
             else {
-                qmlInfo(q) << QchSortFilterProxyModel::tr("Source model type is not supported");
-                return;
+                scheduleWindowUpdate();
+                return false;
+            }
+        }
+        
+        return state == InsideWindow;
+    }
+    
+    // Returns true if a change to the row may move it into or out of the window.
+    bool windowAffectedByRow(int row) const {
+        if ((row >= windowStates.size()) || (row == windowStart.row()) || (row == windowEnd.row())) {
+            return true;
+        }
+        
+        Q_Q(const QchSortFilterProxyModel);
+        const bool accepted = (q->QSortFilterProxyModel::filterAcceptsRow(row, QModelIndex()))
+                              && (acceptsRow(row, QModelIndex())) && (rulesAcceptRow(row, QModelIndex()));
+        
+        if (windowStates.at(row) == InsideWindow) {
+            return (!accepted) || ((windowStart.isValid()) && (windowLessThan(row, windowStart.row())))
+                || ((windowEnd.isValid()) && (windowLessThan(windowEnd.row(), row)));
+        }
+        
+        return (accepted) && ((!windowEnd.isValid()) || (windowLessThan(row, windowEnd.row())));
+    }
+    
+    void scheduleWindowUpdate() const {
+        if (!windowUpdatePending) {
+            Q_Q(const QchSortFilterProxyModel);
+            windowUpdatePending = true;
+            QMetaObject::invokeMethod(const_cast<QchSortFilterProxyModel*>(q), "_q_updateWindow",
+                                      Qt::QueuedConnection);
+        }
+    }
+    
+    void _q_updateWindow() {
+        windowUpdatePending = false;
+        
+        if (isWindowed()) {
+            refilter();
+        }
+    }
+    
+    // Resolves the role names of the enabled rules against the source model.
+    void compileRules(const QAbstractItemModel *model) {
+        filterSpecs.clear();
+        sortSpecs.clear();
+        
+        if (!model) {
+            return;
+        }
+        
+        Q_Q(QchSortFilterProxyModel);
+        const QHash<int, QByteArray> roles = model->roleNames();
+        
+        if (roles.isEmpty()) {
+            // The roles of a QML ListModel are not known until it has items, and the rules are compiled again
+            // when they are announced
+            return;
+        }
+        
+        foreach (const QchFilterRule *rule, filterRules) {
+            if (!rule->isEnabled()) {
+                continue;
+            }
+            
+            const int role = roles.key(rule->roleName().toUtf8(), -1);
+            
+            if (role == -1) {
+                qmlInfo(q) << QchSortFilterProxyModel::tr("Role %1 does not exist").arg(rule->roleName());
+                continue;
+            }
+            
+            QchFilterSpec spec;
+            spec.role = role;
+            spec.comparison = rule->comparison();
+            spec.caseSensitivity = rule->caseSensitivity();
+            spec.value = sortKey(rule->value(), spec.caseSensitivity, false);
+            spec.minimum = sortKey(rule->minimumValue(), spec.caseSensitivity, false);
+            spec.maximum = sortKey(rule->maximumValue(), spec.caseSensitivity, false);
+            spec.string = rule->value().toString();
+            
+            if (spec.comparison == QchFilterRule::Wildcard) {
+                spec.regExp = QRegExp(spec.string, spec.caseSensitivity, QRegExp::Wildcard);
+            }
+            else if (spec.comparison == QchFilterRule::RegExp) {
+                spec.regExp = QRegExp(spec.string, spec.caseSensitivity);
+            }
+            
+            filterSpecs << spec;
+        }
+        
+        foreach (const QchSortRule *rule, sortRules) {
+            if (!rule->isEnabled()) {
+                continue;
+            }
+            
+            const int role = roles.key(rule->roleName().toUtf8(), -1);
+            
+            if (role == -1) {
+                qmlInfo(q) << QchSortFilterProxyModel::tr("Role %1 does not exist").arg(rule->roleName());
+                continue;
+            }
+            
+            sortSpecs << QchSortSpec(role, rule->caseSensitivity(), q->isSortLocaleAware(), rule->order());
+        }
+    }
+    
+    bool rulesAcceptRow(int row, const QModelIndex &parent) const {
+        if (filterSpecs.isEmpty()) {
+            return true;
+        }
+        
+        Q_Q(const QchSortFilterProxyModel);
+        const QModelIndex index = q->sourceModel()->index(row, 0, parent);
+        
+        if (filterMode == QchSortFilterProxyModel::MatchAny) {
+            foreach (const QchFilterSpec &spec, filterSpecs) {
+                if (spec.matches(index.data(spec.role))) {
+                    return true;
+                }
+            }
+            
+            return false;
+        }
+        
+        foreach (const QchFilterSpec &spec, filterSpecs) {
+            if (!spec.matches(index.data(spec.role))) {
+                return false;
+            }
+        }
+        
+        return true;
+    }
+    
+    void _q_onRulesChanged() {
+        if (!complete) {
+            return;
+        }
+        
+        Q_Q(QchSortFilterProxyModel);
+        compileRules(q->sourceModel());
+        refilter();
+        
+        if (q->dynamicSortFilter()) {
+            q->sort();
+        }
+    }
+    
+    void _q_onRuleDestroyed(QObject *obj) {
+        filterRules.removeOne(static_cast<QchFilterRule*>(obj));
+        sortRules.removeOne(static_cast<QchSortRule*>(obj));
+        _q_onRulesChanged();
+    }
+    
+    static void filterRulesAppend(QDeclarativeListProperty<QchFilterRule> *list, QchFilterRule *rule) {
+        if (!rule) {
+            return;
+        }
+        
+        if (QchSortFilterProxyModel *model = qobject_cast<QchSortFilterProxyModel*>(list->object)) {
+            model->d_func()->filterRules << rule;
+            model->connect(rule, SIGNAL(changed()), model, SLOT(_q_onRulesChanged()));
+            model->connect(rule, SIGNAL(destroyed(QObject*)), model, SLOT(_q_onRuleDestroyed(QObject*)));
+            model->d_func()->_q_onRulesChanged();
+        }
+    }
+    
+    static QchFilterRule* filterRulesAt(QDeclarativeListProperty<QchFilterRule> *list, int index) {
+        if (QchSortFilterProxyModel *model = qobject_cast<QchSortFilterProxyModel*>(list->object)) {
+            return model->d_func()->filterRules.value(index);
+        }
+        
+        return 0;
+    }
+    
+    static int filterRulesCount(QDeclarativeListProperty<QchFilterRule> *list) {
+        if (QchSortFilterProxyModel *model = qobject_cast<QchSortFilterProxyModel*>(list->object)) {
+            return model->d_func()->filterRules.size();
+        }
+        
+        return 0;
+    }
+    
+    static void sortRulesAppend(QDeclarativeListProperty<QchSortRule> *list, QchSortRule *rule) {
+        if (!rule) {
+            return;
+        }
+        
+        if (QchSortFilterProxyModel *model = qobject_cast<QchSortFilterProxyModel*>(list->object)) {
+            model->d_func()->sortRules << rule;
+            model->connect(rule, SIGNAL(changed()), model, SLOT(_q_onRulesChanged()));
+            model->connect(rule, SIGNAL(destroyed(QObject*)), model, SLOT(_q_onRuleDestroyed(QObject*)));
+            model->d_func()->_q_onRulesChanged();
+        }
+    }
+    
+    static QchSortRule* sortRulesAt(QDeclarativeListProperty<QchSortRule> *list, int index) {
+        if (QchSortFilterProxyModel *model = qobject_cast<QchSortFilterProxyModel*>(list->object)) {
+            return model->d_func()->sortRules.value(index);
+        }
+        
+        return 0;
+    }
+    
+    static int sortRulesCount(QDeclarativeListProperty<QchSortRule> *list) {
+        if (QchSortFilterProxyModel *model = qobject_cast<QchSortFilterProxyModel*>(list->object)) {
+            return model->d_func()->sortRules.size();
+        }
+        
+        return 0;
+    }
+    
+    void _q_onSourceRowsAboutToBeInserted(const QModelIndex &parent, int start, int end) {
+        if (parent.isValid()) {
+            return;
+        }
+        
+        if (start <= filterStates.size()) {
+            filterStates.insert(start, end - start + 1, Unknown);
+            
+            if (start < filterPosition) {
+                filterPosition += end - start + 1;
+            }
+        }
+        
+        if (start <= sortKeys.size()) {
+            sortKeys.insert(start, end - start + 1, QVector<QchSortKey>());
+        }
+        
+        if (start <= windowStates.size()) {
+            windowStates.insert(start, end - start + 1, WindowUnknown);
+        }
+        
+        sourceRevision++;
+    }
+    
+    void _q_onSourceRowsRemoved(const QModelIndex &parent, int start, int end) {
+        if (parent.isValid()) {
+            return;
+        }
+        
+        if (start < filterStates.size()) {
+            filterStates.remove(start, qMin(end, filterStates.size() - 1) - start + 1);
+            
+            if (start < filterPosition) {
+                filterPosition = qMax(start, filterPosition - (end - start + 1));
             }
         }
-        else {
-            QchVariantListModel *model = new QchVariantListModel(q);            
-            model->setSourceVariant(sourceModelVariant);
-            q->setSourceModel(model);
+        
+        if (start < sortKeys.size()) {
+            sortKeys.remove(start, qMin(end, sortKeys.size() - 1) - start + 1);
+        }
+        
+        if (start < windowStates.size()) {
+            const int last = qMin(end, windowStates.size() - 1);
             
-            if ((ownModel) && (oldModel)) {
-                oldModel->deleteLater();
+            // Rows below the window move into it when a row inside it is removed
+            for (int i = start; i <= last; i++) {
+                if (windowStates.at(i) == InsideWindow) {
+                    scheduleWindowUpdate();
+                    break;
+                }
             }
             
-            ownModel = true;
+            windowStates.remove(start, last - start + 1);
         }
         
-        q->setFilterRole(q->roleNames().key(filterRoleName.toUtf8()));
-        q->setSortRole(q->roleNames().key(sortRoleName.toUtf8()));
+        if (filterIndex.valid) {
+            if (end < filterIndex.size()) {
+                filterIndex.removeRows(start, end - start + 1);
+            }
+            else {
+                filterIndex.clear();
+            }
+        }
         
-        if (q->dynamicSortFilter()) {
-            q->sort();
+        sourceRevision++;
+    }
+    
+    void _q_onSourceRowsInserted(const QModelIndex &parent, int start, int end) {
+        if ((parent.isValid()) || (!filterIndex.valid)) {
+            return;
+        }
+        
+        if (start > filterIndex.size()) {
+            filterIndex.clear();
+            return;
         }
+        
+        QStringList texts;
+        
+        for (int i = start; i <= end; i++) {
+            texts << filterText(i);
+        }
+        
+        filterIndex.insertRows(start, texts);
     }
-
-    void _q_updateRoleNames() {
-        Q_Q(QchSortFilterProxyModel);
-
-        if (!q->sourceModel()) {
+    
+    void _q_onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        if (topLeft.parent().isValid()) {
             return;
         }
-
-        q->setRoleNames(q->sourceModel()->roleNames());
-        q->setFilterRole(q->sourceModel()->roleNames().key(filterRoleName.toUtf8()));
-        q->setSortRole(q->sourceModel()->roleNames().key(sortRoleName.toUtf8()));
-
-        if (q->dynamicSortFilter()) {
-            q->sort();
+        
+        for (int i = topLeft.row(); (i <= bottomRight.row()) && (i < filterStates.size()); i++) {
+            filterStates[i] = Unknown;
+        }
+        
+        for (int i = topLeft.row(); (i <= bottomRight.row()) && (i < sortKeys.size()); i++) {
+            sortKeys[i].clear();
+        }
+        
+        if (filterIndex.valid) {
+            for (int i = topLeft.row(); (i <= bottomRight.row()) && (i < filterIndex.size()); i++) {
+                filterIndex.setText(i, filterText(i));
+            }
+        }
+        
+        if ((isWindowed()) && (windowValid)) {
+            // The window is only recomputed if a changed row crosses one of its boundaries
+            for (int i = topLeft.row(); i <= bottomRight.row(); i++) {
+                if (windowAffectedByRow(i)) {
+                    scheduleWindowUpdate();
+                    break;
+                }
+            }
         }
+        
+        sourceRevision++;
+    }
+    
+    void _q_resetRowCaches() {
+        filterStates.clear();
+        filterPosition = 0;
+        filterIndex.clear();
+        windowStates.clear();
+        windowValid = false;
+        sortKeys.clear();
+        // The keys are resized to the new row count when they are next validated
+        sortKeyColumn = -1;
+        sourceRevision++;
     }
     
     QchSortFilterProxyModel *q_ptr;
@@ -112,12 +1881,57 @@ public:
     
     Qt::SortOrder sortOrder;
     
+    QString filterPattern;
+    QRegExp::PatternSyntax filterSyntax;
+    mutable QRegExp filterRegExp;
+    mutable QVector<char> filterStates;
+    mutable int filterStateRole;
+    mutable int filterStateColumn;
+    mutable Qt::CaseSensitivity filterStateCaseSensitivity;
+    int filterTimerId;
+    mutable int filterPosition;
+    bool filtering;
+    
+    bool filterIndexed;
+    mutable QchFilterIndex filterIndex;
+    
+    mutable QVector< QVector<QchSortKey> > sortKeys;
+    mutable QList<QchSortSpec> sortKeySpecs;
+    mutable int sortKeyColumn;
+    
+    QScopedPointer< QFutureWatcher< QVector<int> > > sortWatcher;
+    QVector<int> sortPositions;
+    int sourceRevision;
+    int sortRevision;
+    int sortRestarts;
+    bool asynchronousSort;
+    bool sorting;
+    
+    QchSortFilterProxyModel::FilterMode filterMode;
+    
+    QList<QchFilterRule*> filterRules;
+    QList<QchSortRule*> sortRules;
+    QList<QchFilterSpec> filterSpecs;
+    QList<QchSortSpec> sortSpecs;
+    
+    int limit;
+    int offset;
+    mutable QVector<char> windowStates;
+    mutable QPersistentModelIndex windowStart;
+    mutable QPersistentModelIndex windowEnd;
+    mutable bool windowValid;
+    mutable bool windowUpdatePending;
+    
     bool ownModel;
     bool complete;
     
     Q_DECLARE_PUBLIC(QchSortFilterProxyModel)
 };
 
+inline bool QchWindowLessThan::operator()(int left, int right) const {
+    return m_d->windowLessThan(left, right);
+}
+
 /*!
     \class SortFilterProxyModel
     \brief Provides support for sorting and filtering data passed between another model and a view.
@@ -179,20 +1993,33 @@ QchSortFilterProxyModel::~QchSortFilterProxyModel() {}
     The default value is \c 0. If the value is \c -1, the keys will be read from all columns.
 */
 
-/*!
-    \property QRegExp SortFilterProxyModel::filterRegExp
-    \brief The regular expression used to filter the contents of the source model.
-    
-    \sa filterFixedString, filterWildcard
-*/
 
 /*!
     \property bool SortFilterProxyModel::isSortLocaleAware
     \brief The locale aware setting used for comparing strings when sorting.
     
+    The sort key of each item is computed once and cached until the item changes, so locale aware sorting does 
+    not repeat the string collation for every comparison.
+    
     The default value is \c false.
 */
 
+void QchSortFilterProxyModel::setSortLocaleAware(bool on) {
+    if (on != isSortLocaleAware()) {
+        Q_D(QchSortFilterProxyModel);
+        QSortFilterProxyModel::setSortLocaleAware(on);
+        
+        // The locale awareness of the sort rules is resolved when they are compiled
+        if ((d->complete) && (!d->sortRules.isEmpty())) {
+            d->compileRules(sourceModel());
+            
+            if (dynamicSortFilter()) {
+                sort();
+            }
+        }
+    }
+}
+
 /*!
     \property enumeration SortFilterProxyModel::sortCaseSensitivity
     \brief The case sensitivity setting used for comparing strings when sorting.
@@ -240,13 +2067,42 @@ void QchSortFilterProxyModel::setFilterRoleName(const QString &roleName) {
     }
 }
 
+/*!
+    \brief The regular expression used to filter the contents of the source model.
+    
+    Setting the filterFixedString or filterWildcard also sets the pattern and syntax of this property.
+    
+    \sa filterFixedString, filterWildcard
+*/
+QRegExp QchSortFilterProxyModel::filterRegExp() const {
+    Q_D(const QchSortFilterProxyModel);
+    return QRegExp(d->filterPattern, filterCaseSensitivity(), d->filterSyntax);
+}
+
+void QchSortFilterProxyModel::setFilterRegExp(const QRegExp &regExp) {
+    Q_D(QchSortFilterProxyModel);
+    setFilterCaseSensitivity(regExp.caseSensitivity());
+    d->setFilterPattern(regExp.pattern(), regExp.patternSyntax());
+}
+
+void QchSortFilterProxyModel::setFilterRegExp(const QString &pattern) {
+    Q_D(QchSortFilterProxyModel);
+    d->setFilterPattern(pattern, QRegExp::RegExp);
+}
+
 /*!
     \brief The fixed string used to filter the contents of the source model.
     
     \sa filterRegExp, filterWildcard
 */
 QString QchSortFilterProxyModel::filterFixedString() const {
-    return filterRegExp().pattern();
+    Q_D(const QchSortFilterProxyModel);
+    return d->filterPattern;
+}
+
+void QchSortFilterProxyModel::setFilterFixedString(const QString &pattern) {
+    Q_D(QchSortFilterProxyModel);
+    d->setFilterPattern(pattern, QRegExp::FixedString);
 }
 
 /*!
@@ -255,9 +2111,191 @@ QString QchSortFilterProxyModel::filterFixedString() const {
     \sa filterRegExp, filterFixedString
 */
 QString QchSortFilterProxyModel::filterWildcard() const {
-    return filterRegExp().pattern();
+    Q_D(const QchSortFilterProxyModel);
+    return d->filterPattern;
+}
+
+void QchSortFilterProxyModel::setFilterWildcard(const QString &pattern) {
+    Q_D(QchSortFilterProxyModel);
+    d->setFilterPattern(pattern, QRegExp::Wildcard);
+}
+
+/*!
+    \property bool SortFilterProxyModel::filtering
+    \brief Whether the items are currently being filtered.
+    
+    When the filterFixedString or filterWildcard is changed, only the items that may be affected by the change are 
+    tested. If the new string extends the previous one, only the currently accepted items are tested, and if it 
+    shortens the previous one, only the currently rejected items are tested. Large numbers of items are tested in 
+    several passes so that the user interface remains responsive. The filterFinished() signal is emitted when the 
+    new filter has been applied.
+    
+    \sa filterFixedString, filterWildcard
+*/
+bool QchSortFilterProxyModel::isFiltering() const {
+    Q_D(const QchSortFilterProxyModel);
+    return d->filtering;
+}
+
+/*!
+    \property bool SortFilterProxyModel::filterIndexed
+    \brief Whether an index of the filterRole values is used when filtering with filterFixedString.
+    
+    When enabled, the filterRole value of every item is read from the source model once and stored in a 
+    trigram index, which is kept up to date as items are inserted, removed and changed. Changes to the 
+    filterFixedString are then resolved by looking up the index instead of testing every item.
+    
+    The index is not used when filterKeyColumn is \c -1.
+    
+    The default value is \c false.
+    
+    \sa filterFixedString, filterRole
+*/
+bool QchSortFilterProxyModel::isFilterIndexed() const {
+    Q_D(const QchSortFilterProxyModel);
+    return d->filterIndexed;
+}
+
+void QchSortFilterProxyModel::setFilterIndexed(bool indexed) {
+    if (indexed != isFilterIndexed()) {
+        Q_D(QchSortFilterProxyModel);
+        d->filterIndexed = indexed;
+        
+        if (!indexed) {
+            d->filterIndex.clear();
+        }
+        
+        emit filterIndexedChanged();
+    }
+}
+
+/*!
+    \brief The maximum number of items provided by the model.
+    
+    When set, only the accepted items from offset to offset + limit in sort order are provided. The window is 
+    selected without fully sorting the accepted items, so only the provided items are sorted and mapped. Source 
+    items that are inserted after the end of a full window do not change the model.
+    
+    The default value is \c -1 (no limit).
+    
+    \sa offset
+*/
+int QchSortFilterProxyModel::limit() const {
+    Q_D(const QchSortFilterProxyModel);
+    return d->limit;
+}
+
+void QchSortFilterProxyModel::setLimit(int limit) {
+    if (limit != this->limit()) {
+        Q_D(QchSortFilterProxyModel);
+        d->limit = limit;
+        emit limitChanged();
+        
+        if (sourceModel()) {
+            d->refilter();
+        }
+    }
+}
+
+/*!
+    \brief The number of accepted items, in sort order, that are skipped by the model.
+    
+    The default value is \c 0.
+    
+    \sa limit
+*/
+int QchSortFilterProxyModel::offset() const {
+    Q_D(const QchSortFilterProxyModel);
+    return d->offset;
+}
+
+void QchSortFilterProxyModel::setOffset(int offset) {
+    offset = qMax(0, offset);
+    
+    if (offset != this->offset()) {
+        Q_D(QchSortFilterProxyModel);
+        d->offset = offset;
+        emit offsetChanged();
+        
+        if (sourceModel()) {
+            d->refilter();
+        }
+    }
+}
+
+/*!
+    \brief How the filterRules are combined.
+    
+    Possible values are:
+    
+    <table>
+        <tr>
+            <th>Name</th>
+            <th>Description</th>
+        </tr>
+        <tr>
+            <td>SortFilterProxyModel.MatchAll</td>
+            <td>An item is accepted if it matches all of the rules (default).</td>
+        </tr>
+        <tr>
+            <td>SortFilterProxyModel.MatchAny</td>
+            <td>An item is accepted if it matches any of the rules.</td>
+        </tr>
+    </table>
+    
+    \sa filterRules
+*/
+QchSortFilterProxyModel::FilterMode QchSortFilterProxyModel::filterMode() const {
+    Q_D(const QchSortFilterProxyModel);
+    return d->filterMode;
+}
+
+void QchSortFilterProxyModel::setFilterMode(QchSortFilterProxyModel::FilterMode mode) {
+    if (mode != filterMode()) {
+        Q_D(QchSortFilterProxyModel);
+        d->filterMode = mode;
+        emit filterModeChanged();
+        
+        if ((d->complete) && (!d->filterSpecs.isEmpty())) {
+            d->refilter();
+        }
+    }
+}
+
+/*!
+    \property list<FilterRule> SortFilterProxyModel::filterRules
+    \brief The list of FilterRule used to filter the contents of the source model.
+    
+    The rules are applied in addition to the filterFixedString or filterWildcard, and are combined according to 
+    the filterMode.
+    
+    \sa filterMode, sortRules
+*/
+QDeclarativeListProperty<QchFilterRule> QchSortFilterProxyModel::filterRules() {
+    return QDeclarativeListProperty<QchFilterRule>(this, 0, QchSortFilterProxyModelPrivate::filterRulesAppend,
+            QchSortFilterProxyModelPrivate::filterRulesCount, QchSortFilterProxyModelPrivate::filterRulesAt);
+}
+
+/*!
+    \property list<SortRule> SortFilterProxyModel::sortRules
+    \brief The list of SortRule used to sort the items.
+    
+    If any sort rules are enabled, they are used instead of the sortRole and sortOrder.
+    
+    \sa filterRules, sort()
+*/
+QDeclarativeListProperty<QchSortRule> QchSortFilterProxyModel::sortRules() {
+    return QDeclarativeListProperty<QchSortRule>(this, 0, QchSortFilterProxyModelPrivate::sortRulesAppend,
+            QchSortFilterProxyModelPrivate::sortRulesCount, QchSortFilterProxyModelPrivate::sortRulesAt);
 }
 
+/*!
+    \fn void SortFilterProxyModel::filterFinished()
+    \brief Emitted when a change to the filterFixedString or filterWildcard has been applied.
+    
+    \sa filtering
+*/
+
 /*!
     \brief The column to which any sorting should be applied.
     
@@ -317,6 +2355,9 @@ void QchSortFilterProxyModel::setSortOrder(Qt::SortOrder order) {
     \property string SortFilterProxyModel::sortRole
     \brief The item role that is used to query the source model's data when sorting items.
     
+    Numbers, dates and times are compared by value, and other values as strings. Items whose values have 
+    different types are ordered by type, with empty values first.
+    
     The default value is \c modelData.
     
     \sa sortColumn, sortOrder, sort()
@@ -369,6 +2410,48 @@ void QchSortFilterProxyModel::setSourceModelVariant(const QVariant &variant) {
     }
 }
 
+/*!
+    \brief Whether sort() sorts the items in a background thread.
+    
+    When enabled, the sort keys are read from the source model in the user interface thread, the items are 
+    sorted in a background thread, and the new order is applied in a single layout change. A call to sort() while 
+    a previous sort is in progress supersedes it.
+    
+    The default value is \c false.
+    
+    \sa sorting, sort()
+*/
+bool QchSortFilterProxyModel::asynchronousSort() const {
+    Q_D(const QchSortFilterProxyModel);
+    return d->asynchronousSort;
+}
+
+void QchSortFilterProxyModel::setAsynchronousSort(bool enabled) {
+    if (enabled != asynchronousSort()) {
+        Q_D(QchSortFilterProxyModel);
+        d->asynchronousSort = enabled;
+        emit asynchronousSortChanged();
+    }
+}
+
+/*!
+    \property bool SortFilterProxyModel::sorting
+    \brief Whether an asynchronous sort is in progress.
+    
+    \sa asynchronousSort, sortFinished()
+*/
+bool QchSortFilterProxyModel::isSorting() const {
+    Q_D(const QchSortFilterProxyModel);
+    return d->sorting;
+}
+
+/*!
+    \fn void SortFilterProxyModel::sortFinished()
+    \brief Emitted when the items have been sorted by sort().
+    
+    \sa sorting
+*/
+
 /*!
     \brief Maps \a proxyIndex to the source model.
 */
@@ -386,10 +2469,69 @@ int QchSortFilterProxyModel::mapRowToSource(int proxyRow) const {
 /*!
     \brief Sorts the items according to the sortColumn, sortOrder and sortRole.
     
+    If asynchronousSort is enabled, the items are sorted in a background thread.
+    
     \sa sortColumn, sortOrder, sortRole
 */
 void QchSortFilterProxyModel::sort() {
-    QSortFilterProxyModel::sort(sortColumn(), sortOrder());
+    if (QchDeclarativeListModelProxy *proxy = qobject_cast<QchDeclarativeListModelProxy*>(sourceModel())) {
+        proxy->fillCache();
+    }
+    
+    Q_D(QchSortFilterProxyModel);
+    
+    if ((d->asynchronousSort) && (sourceModel())) {
+        d->sortRestarts = 0;
+        d->startAsynchronousSort();
+        return;
+    }
+    
+    d->validateSortKeys(sortColumn());
+    // Each sort rule applies its own order
+    d->applySort();
+    
+    if (d->isWindowed()) {
+        d->refilter();
+    }
+    
+    emit sortFinished();
+}
+
+void QchSortFilterProxyModel::setSourceModel(QAbstractItemModel *model) {
+    Q_D(QchSortFilterProxyModel);
+    // Connect before the base class, so that the filter states are updated before the source changes are handled
+    d->disconnectSourceModel(sourceModel());
+    d->_q_resetRowCaches();
+    d->connectSourceModel(model);
+    d->compileRules(model);
+    QSortFilterProxyModel::setSourceModel(model);
+}
+
+bool QchSortFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const {
+    if (!QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent)) {
+        return false;
+    }
+    
+    Q_D(const QchSortFilterProxyModel);
+    return (d->acceptsRow(sourceRow, sourceParent)) && (d->rulesAcceptRow(sourceRow, sourceParent))
+        && (d->windowAcceptsRow(sourceRow, sourceParent));
+}
+
+bool QchSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const {
+    Q_D(const QchSortFilterProxyModel);
+    bool ok = false;
+    const bool result = d->sortKeyLessThan(left, right, &ok);
+    return ok ? result : QSortFilterProxyModel::lessThan(left, right);
+}
+
+void QchSortFilterProxyModel::timerEvent(QTimerEvent *event) {
+    Q_D(QchSortFilterProxyModel);
+    
+    if (event->timerId() == d->filterTimerId) {
+        d->processFilterStates();
+    }
+    
+    QSortFilterProxyModel::timerEvent(event);
 }
 
 void QchSortFilterProxyModel::classBegin() {}
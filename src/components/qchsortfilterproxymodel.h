@@ -18,9 +18,125 @@
 #define QCHSORTFILTERPROXYMODEL_H
 
 #include <QSortFilterProxyModel>
+#include <QDeclarativeListProperty>
 #include <QDeclarativeParserStatus>
 #include <qdeclarative.h>
 
+class QchFilterRulePrivate;
+
+class QchFilterRule : public QObject
+{
+    Q_OBJECT
+    
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(QString role READ roleName WRITE setRoleName NOTIFY roleChanged)
+    Q_PROPERTY(Comparison comparison READ comparison WRITE setComparison NOTIFY comparisonChanged)
+    Q_PROPERTY(QVariant value READ value WRITE setValue NOTIFY valueChanged)
+    Q_PROPERTY(QVariant minimumValue READ minimumValue WRITE setMinimumValue NOTIFY minimumValueChanged)
+    Q_PROPERTY(QVariant maximumValue READ maximumValue WRITE setMaximumValue NOTIFY maximumValueChanged)
+    Q_PROPERTY(Qt::CaseSensitivity caseSensitivity READ caseSensitivity WRITE setCaseSensitivity
+               NOTIFY caseSensitivityChanged)
+    
+    Q_ENUMS(Comparison)
+    
+public:
+    enum Comparison {
+        Equal = 0,
+        NotEqual,
+        LessThan,
+        LessThanOrEqual,
+        GreaterThan,
+        GreaterThanOrEqual,
+        InRange,
+        Contains,
+        StartsWith,
+        Wildcard,
+        RegExp
+    };
+    
+    explicit QchFilterRule(QObject *parent = 0);
+    ~QchFilterRule();
+    
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+    
+    QString roleName() const;
+    void setRoleName(const QString &roleName);
+    
+    Comparison comparison() const;
+    void setComparison(Comparison comparison);
+    
+    QVariant value() const;
+    void setValue(const QVariant &value);
+    
+    QVariant minimumValue() const;
+    void setMinimumValue(const QVariant &value);
+    
+    QVariant maximumValue() const;
+    void setMaximumValue(const QVariant &value);
+    
+    Qt::CaseSensitivity caseSensitivity() const;
+    void setCaseSensitivity(Qt::CaseSensitivity cs);
+
+Q_SIGNALS:
+    void changed();
+    void enabledChanged();
+    void roleChanged();
+    void comparisonChanged();
+    void valueChanged();
+    void minimumValueChanged();
+    void maximumValueChanged();
+    void caseSensitivityChanged();
+
+private:
+    QScopedPointer<QchFilterRulePrivate> d_ptr;
+    
+    Q_DECLARE_PRIVATE(QchFilterRule)
+    Q_DISABLE_COPY(QchFilterRule)
+};
+
+class QchSortRulePrivate;
+
+class QchSortRule : public QObject
+{
+    Q_OBJECT
+    
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(QString role READ roleName WRITE setRoleName NOTIFY roleChanged)
+    Q_PROPERTY(Qt::SortOrder order READ order WRITE setOrder NOTIFY orderChanged)
+    Q_PROPERTY(Qt::CaseSensitivity caseSensitivity READ caseSensitivity WRITE setCaseSensitivity
+               NOTIFY caseSensitivityChanged)
+    
+public:
+    explicit QchSortRule(QObject *parent = 0);
+    ~QchSortRule();
+    
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+    
+    QString roleName() const;
+    void setRoleName(const QString &roleName);
+    
+    Qt::SortOrder order() const;
+    void setOrder(Qt::SortOrder order);
+    
+    Qt::CaseSensitivity caseSensitivity() const;
+    void setCaseSensitivity(Qt::CaseSensitivity cs);
+
+Q_SIGNALS:
+    void changed();
+    void enabledChanged();
+    void roleChanged();
+    void orderChanged();
+    void caseSensitivityChanged();
+
+private:
+    QScopedPointer<QchSortRulePrivate> d_ptr;
+    
+    Q_DECLARE_PRIVATE(QchSortRule)
+    Q_DISABLE_COPY(QchSortRule)
+};
+
 class QchSortFilterProxyModelPrivate;
 
 class QchSortFilterProxyModel : public QSortFilterProxyModel, public QDeclarativeParserStatus
@@ -29,25 +145,61 @@ class QchSortFilterProxyModel : public QSortFilterProxyModel, public QDeclarativ
     
     Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
     Q_PROPERTY(QString filterRole READ filterRoleName WRITE setFilterRoleName NOTIFY filterRoleChanged)
+    Q_PROPERTY(QRegExp filterRegExp READ filterRegExp WRITE setFilterRegExp)
     Q_PROPERTY(QString filterFixedString READ filterFixedString WRITE setFilterFixedString)
     Q_PROPERTY(QString filterWildcard READ filterWildcard WRITE setFilterWildcard)
+    Q_PROPERTY(bool filtering READ isFiltering NOTIFY filteringChanged)
+    Q_PROPERTY(bool filterIndexed READ isFilterIndexed WRITE setFilterIndexed NOTIFY filterIndexedChanged)
+    Q_PROPERTY(FilterMode filterMode READ filterMode WRITE setFilterMode NOTIFY filterModeChanged)
+    Q_PROPERTY(QDeclarativeListProperty<QchFilterRule> filterRules READ filterRules)
+    Q_PROPERTY(QDeclarativeListProperty<QchSortRule> sortRules READ sortRules)
+    Q_PROPERTY(int limit READ limit WRITE setLimit NOTIFY limitChanged)
+    Q_PROPERTY(int offset READ offset WRITE setOffset NOTIFY offsetChanged)
     Q_PROPERTY(int sortColumn READ sortColumn WRITE setSortColumn NOTIFY sortColumnChanged)
     Q_PROPERTY(Qt::SortOrder sortOrder READ sortOrder WRITE setSortOrder NOTIFY sortOrderChanged)
     Q_PROPERTY(QString sortRole READ sortRoleName WRITE setSortRoleName NOTIFY sortRoleChanged)
+    Q_PROPERTY(bool isSortLocaleAware READ isSortLocaleAware WRITE setSortLocaleAware)
+    Q_PROPERTY(bool asynchronousSort READ asynchronousSort WRITE setAsynchronousSort NOTIFY asynchronousSortChanged)
+    Q_PROPERTY(bool sorting READ isSorting NOTIFY sortingChanged)
     Q_PROPERTY(QVariant sourceModel READ sourceModelVariant WRITE setSourceModelVariant NOTIFY sourceModelChanged)
     
+    Q_ENUMS(FilterMode)
+    
     Q_INTERFACES(QDeclarativeParserStatus)
 
 public:
+    enum FilterMode {
+        MatchAll = 0,
+        MatchAny
+    };
+    
     explicit QchSortFilterProxyModel(QObject *parent = 0);
     ~QchSortFilterProxyModel();
     
     QString filterRoleName() const;
     void setFilterRoleName(const QString &roleName);
     
+    QRegExp filterRegExp() const;
     QString filterFixedString() const;    
     QString filterWildcard() const;
     
+    bool isFiltering() const;
+    
+    bool isFilterIndexed() const;
+    void setFilterIndexed(bool indexed);
+    
+    FilterMode filterMode() const;
+    void setFilterMode(FilterMode mode);
+    
+    QDeclarativeListProperty<QchFilterRule> filterRules();
+    QDeclarativeListProperty<QchSortRule> sortRules();
+    
+    int limit() const;
+    void setLimit(int limit);
+    
+    int offset() const;
+    void setOffset(int offset);
+    
     int sortColumn() const;
     void setSortColumn(int column);
     
@@ -57,10 +209,24 @@ public:
     QString sortRoleName() const;
     void setSortRoleName(const QString &roleName);
     
+    bool asynchronousSort() const;
+    void setAsynchronousSort(bool enabled);
+    
+    bool isSorting() const;
+    
     QVariant sourceModelVariant() const;
     void setSourceModelVariant(const QVariant &variant);
+    
+    virtual void setSourceModel(QAbstractItemModel *model);
 
 public Q_SLOTS:
+    void setFilterRegExp(const QRegExp &regExp);
+    void setFilterRegExp(const QString &pattern);
+    void setFilterFixedString(const QString &pattern);
+    void setFilterWildcard(const QString &pattern);
+    
+    void setSortLocaleAware(bool on);
+    
     QVariant mapIndexToSource(const QVariant &proxyIndex) const;
     int mapRowToSource(int proxyRow) const;
     
@@ -68,12 +234,27 @@ public Q_SLOTS:
         
 Q_SIGNALS:
     void countChanged();
+    void filterFinished();
+    void filteringChanged();
+    void filterIndexedChanged();
+    void filterModeChanged();
+    void limitChanged();
+    void offsetChanged();
     void filterRoleChanged();
     void sortColumnChanged();
     void sortOrderChanged();
     void sortRoleChanged();
+    void asynchronousSortChanged();
+    void sortingChanged();
+    void sortFinished();
     void sourceModelChanged();
 
+protected:
+    virtual bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const;
+    virtual bool lessThan(const QModelIndex &left, const QModelIndex &right) const;
+    
+    virtual void timerEvent(QTimerEvent *event);
+
 private:
     virtual void classBegin();
     virtual void componentComplete();
@@ -84,8 +265,19 @@ private:
     Q_DISABLE_COPY(QchSortFilterProxyModel)    
 
     Q_PRIVATE_SLOT(d_func(), void _q_updateRoleNames())
+    Q_PRIVATE_SLOT(d_func(), void _q_onSourceRowsAboutToBeInserted(QModelIndex, int, int))
+    Q_PRIVATE_SLOT(d_func(), void _q_onSourceRowsInserted(QModelIndex, int, int))
+    Q_PRIVATE_SLOT(d_func(), void _q_onSourceRowsRemoved(QModelIndex, int, int))
+    Q_PRIVATE_SLOT(d_func(), void _q_onSourceDataChanged(QModelIndex, QModelIndex))
+    Q_PRIVATE_SLOT(d_func(), void _q_resetRowCaches())
+    Q_PRIVATE_SLOT(d_func(), void _q_onRulesChanged())
+    Q_PRIVATE_SLOT(d_func(), void _q_onRuleDestroyed(QObject*))
+    Q_PRIVATE_SLOT(d_func(), void _q_onSortFinished())
+    Q_PRIVATE_SLOT(d_func(), void _q_updateWindow())
 };
 
+QML_DECLARE_TYPE(QchFilterRule)
+QML_DECLARE_TYPE(QchSortRule)
 QML_DECLARE_TYPE(QchSortFilterProxyModel)
 Q_DECLARE_METATYPE(QModelIndex)
 
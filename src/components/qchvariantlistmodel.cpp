@@ -24,7 +24,8 @@ class QchVariantListModelPrivate
 
 public:
     QchVariantListModelPrivate(QchVariantListModel *parent) :
-        q_ptr(parent)
+        q_ptr(parent),
+        removalPending(false)
     {
     }
     
@@ -68,51 +69,77 @@ public:
     }
     
     void loadDataFromDeclarativeList(const QDeclarativeListReference &declarativeList) {
-        for (int i = 0; i < declarativeList.count(); i++) {            
+        const int count = declarativeList.count();
+        QVariantList variants;
+        variants.reserve(count);
+        
+        for (int i = 0; i < count; i++) {            
             if (QObject *obj = declarativeList.at(i)) {
-                appendObjectToModel(obj);
+                variants << QVariant::fromValue(obj);
             }
         }
+        
+        appendVariantsToModel(variants);
     }
     
     void loadDataFromList(const QVariantList &variantlist) {
+        QVariantList variants;
+        variants.reserve(variantlist.size());
+        
         foreach (const QVariant &v, variantlist) {
             if (QObject *obj = qvariant_cast<QObject*>(v)) {
-                appendObjectToModel(obj);
+                variants << QVariant::fromValue(obj);
             }
             else {
-                appendVariantToModel(v);
+                variants << v;
             }
         }
+        
+        appendVariantsToModel(variants);
     }
     
     void loadDataFromStringList(const QStringList &stringlist) {
+        QVariantList variants;
+        variants.reserve(stringlist.size());
+        
         foreach (const QString &s, stringlist) {
-            appendVariantToModel(s);
+            variants << s;
         }
+        
+        appendVariantsToModel(variants);
     }
     
     void loadDataFromInteger(int length) {
+        QVariantList variants;
+        variants.reserve(qMax(0, length));
+        
         for (int i = 0; i < length; i++) {
-            appendVariantToModel(i);
+            variants << i;
         }
+        
+        appendVariantsToModel(variants);
     }
     
-    void appendVariantToModel(const QVariant &v) {
-        Q_Q(QchVariantListModel);
-        const int size = list.size();
-        q->beginInsertRows(QModelIndex(), size, size);
-        list << v;
-        q->endInsertRows();
-    }
-    
-    void appendObjectToModel(QObject *obj) {
+    void appendVariantsToModel(const QVariantList &variants) {
+        if (variants.isEmpty()) {
+            return;
+        }
+        
         Q_Q(QchVariantListModel);
         const int size = list.size();
-        q->beginInsertRows(QModelIndex(), size, size);
-        list << QVariant::fromValue(obj);
+        q->beginInsertRows(QModelIndex(), size, size + variants.size() - 1);
+        list.reserve(size + variants.size());
+        list += variants;
         q->endInsertRows();
-        q->connect(obj, SIGNAL(destroyed(QObject*)), q, SLOT(_q_onObjectDestroyed(QObject*)));
+        
+        for (int i = size; i < list.size(); i++) {
+            if (QObject *obj = qvariant_cast<QObject*>(list.at(i))) {
+                // An object may appear in more than one row, but is only connected once
+                objectRows.insert(obj, i);
+                q->connect(obj, SIGNAL(destroyed(QObject*)), q, SLOT(_q_onObjectDestroyed(QObject*)),
+                           Qt::UniqueConnection);
+            }
+        }
     }
     
     void unloadData() {
@@ -122,14 +149,14 @@ public:
         
         Q_Q(QchVariantListModel);
         
-        foreach (const QVariant &v, list) {
-            if (QObject *obj = qvariant_cast<QObject*>(v)) {
-                q->disconnect(obj, SIGNAL(destroyed(QObject*)), q, SLOT(_q_onObjectDestroyed(QObject*)));
-            }
+        foreach (QObject *obj, objectRows.uniqueKeys()) {
+            q->disconnect(obj, SIGNAL(destroyed(QObject*)), q, SLOT(_q_onObjectDestroyed(QObject*)));
         }
         
         q->beginResetModel();
         list.clear();
+        objectRows.clear();
+        destroyedRows.clear();
         q->endResetModel();
     }
     
@@ -138,13 +165,61 @@ public:
             return;
         }
         
-        const int i = list.indexOf(QVariant::fromValue(obj));
+        // Clear the row now so that the dangling pointer is never returned by data(), but defer the removal so that
+        // a batch of destroyed objects (e.g. when the source list is torn down) is removed in a single pass.
+        const QList<int> rows = objectRows.values(obj);
         
-        if (i != -1) {
-            Q_Q(QchVariantListModel);
-            q->beginRemoveRows(QModelIndex(), i, i);
-            list.removeAt(i);
+        if (!rows.isEmpty()) {
+            objectRows.remove(obj);
+            
+            foreach (int i, rows) {
+                list[i] = QVariant();
+                destroyedRows << i;
+            }
+            
+            if (!removalPending) {
+                Q_Q(QchVariantListModel);
+                removalPending = true;
+                QMetaObject::invokeMethod(q, "_q_removeDestroyedObjects", Qt::QueuedConnection);
+            }
+        }
+    }
+    
+    void _q_removeDestroyedObjects() {
+        removalPending = false;
+        
+        if (destroyedRows.isEmpty()) {
+            return;
+        }
+        
+        Q_Q(QchVariantListModel);
+        qSort(destroyedRows);
+        
+        // Remove contiguous ranges from the end so that the remaining rows stay valid.
+        int last = destroyedRows.size() - 1;
+        
+        while (last >= 0) {
+            int first = last;
+            
+            while ((first > 0) && (destroyedRows.at(first - 1) == destroyedRows.at(first) - 1)) {
+                first--;
+            }
+            
+            const int start = destroyedRows.at(first);
+            const int end = destroyedRows.at(last);
+            q->beginRemoveRows(QModelIndex(), start, end);
+            list.erase(list.begin() + start, list.begin() + end + 1);
             q->endRemoveRows();
+            last = first - 1;
+        }
+        
+        destroyedRows.clear();
+        objectRows.clear();
+        
+        for (int i = 0; i < list.size(); i++) {
+            if (QObject *obj = qvariant_cast<QObject*>(list.at(i))) {
+                objectRows.insert(obj, i);
+            }
         }
     }
     
@@ -153,6 +228,11 @@ public:
     QVariant sourceVariant;
     QVariantList list;
     
+    QMultiHash<QObject*, int> objectRows;
+    QList<int> destroyedRows;
+    
+    bool removalPending;
+    
     Q_DECLARE_PUBLIC(QchVariantListModel)
 };
 
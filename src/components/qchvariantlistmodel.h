@@ -43,6 +43,7 @@ private:
     Q_DISABLE_COPY(QchVariantListModel)
     
     Q_PRIVATE_SLOT(d_func(), void _q_onObjectDestroyed(QObject*))
+    Q_PRIVATE_SLOT(d_func(), void _q_removeDestroyedObjects())
 };
 
 #endif // QCHVARIANTLISTMODEL_H
@@ -6,14 +6,22 @@ TARGET = qchdbus
 
 HEADERS += \
     qchdbus.h \
+    qchdbusbatch.h \
     qchdbusconnections.h \
+    qchdbusintrospection.h \
     qchdbusmessage.h \
+    qchdbuspendingcalls.h \
+    qchdbuspropertycache.h \
     qchdbusutils.h \
     qchplugin.h
 
 SOURCES += \
+    qchdbusbatch.cpp \
     qchdbusconnections.cpp \
+    qchdbusintrospection.cpp \
     qchdbusmessage.cpp \
+    qchdbuspendingcalls.cpp \
+    qchdbuspropertycache.cpp \
     qchdbusutils.cpp \
     qchplugin.cpp
 
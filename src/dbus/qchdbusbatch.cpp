@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2016 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qchdbusbatch.h"
+
+class QchDBusBatchPrivate
+{
+
+public:
+    QchDBusBatchPrivate(QchDBusBatch *parent) :
+        q_ptr(parent),
+        status(QchDBusMessage::Null),
+        sending(false)
+    {
+    }
+
+    static void messages_append(QDeclarativeListProperty<QchDBusMessage> *list, QchDBusMessage *message) {
+        if (!message) {
+            return;
+        }
+
+        if (QchDBusBatch *batch = qobject_cast<QchDBusBatch*>(list->object)) {
+            message->setParent(batch);
+            batch->d_func()->messages << message;
+            batch->connect(message, SIGNAL(statusChanged()), batch, SLOT(_q_onMessageStatusChanged()));
+        }
+    }
+
+    static int messages_count(QDeclarativeListProperty<QchDBusMessage> *list) {
+        if (QchDBusBatch *batch = qobject_cast<QchDBusBatch*>(list->object)) {
+            return batch->d_func()->messages.size();
+        }
+
+        return 0;
+    }
+
+    static QchDBusMessage* messages_at(QDeclarativeListProperty<QchDBusMessage> *list, int i) {
+        if (QchDBusBatch *batch = qobject_cast<QchDBusBatch*>(list->object)) {
+            return batch->d_func()->messages.value(i);
+        }
+
+        return 0;
+    }
+
+    void checkFinished() {
+        if ((sending) || (status != QchDBusMessage::Loading)) {
+            return;
+        }
+
+        QVariantList list;
+        bool error = false;
+
+        foreach (const QchDBusMessage *message, messages) {
+            switch (message->status()) {
+            case QchDBusMessage::Loading:
+                return;
+            case QchDBusMessage::Error:
+                error = true;
+                break;
+            default:
+                break;
+            }
+
+            list << message->reply();
+        }
+
+        Q_Q(QchDBusBatch);
+        replies = list;
+        status = error ? QchDBusMessage::Error : QchDBusMessage::Ready;
+        emit q->statusChanged();
+    }
+
+    void _q_onMessageStatusChanged() {
+        checkFinished();
+    }
+
+    QchDBusBatch *q_ptr;
+
+    QList<QchDBusMessage*> messages;
+
+    QchDBusMessage::Status status;
+
+    QVariantList replies;
+
+    bool sending;
+
+    Q_DECLARE_PUBLIC(QchDBusBatch)
+};
+
+/*!
+    \class DBusBatch
+    \brief Sends a batch of DBus messages and provides their replies together.
+    
+    \ingroup dbus
+    
+    The messages are sent one after another without waiting for replies, and the 
+    \link status\endlink changes when all of them have completed.
+    
+    \snippet dbus.qml DBusBatch
+    
+    \sa DBusMessage
+*/
+QchDBusBatch::QchDBusBatch(QObject *parent) :
+    QObject(parent),
+    d_ptr(new QchDBusBatchPrivate(this))
+{
+}
+
+QchDBusBatch::~QchDBusBatch() {}
+
+/*!
+    \brief The messages in the batch.
+*/
+QDeclarativeListProperty<QchDBusMessage> QchDBusBatch::messages() {
+    return QDeclarativeListProperty<QchDBusMessage>(this, 0, QchDBusBatchPrivate::messages_append,
+                                                    QchDBusBatchPrivate::messages_count,
+                                                    QchDBusBatchPrivate::messages_at);
+}
+
+/*!
+    \brief The current status of the batch.
+    
+    Possible values are:
+    
+    <table>
+        <tr>
+            <th>Value</th>
+            <th>Description</th>
+        </tr>
+        <tr>
+            <td>DBusMessage.Null</td>
+            <td>The batch has not been sent, or was cancelled (default).</td>
+        </tr>
+        <tr>
+            <td>DBusMessage.Loading</td>
+            <td>One or more messages are awaiting a reply.</td>
+        </tr>
+        <tr>
+            <td>DBusMessage.Ready</td>
+            <td>All messages were sent successfully.</td>
+        </tr>
+        <tr>
+            <td>DBusMessage.Error</td>
+            <td>One or more messages failed.</td>
+        </tr>
+    </table>
+*/
+QchDBusMessage::Status QchDBusBatch::status() const {
+    Q_D(const QchDBusBatch);
+    return d->status;
+}
+
+/*!
+    \brief The reply of each message, in the order of \link messages\endlink.
+    
+    The replies are available when the \link status\endlink is \c DBusMessage.Ready 
+    or \c DBusMessage.Error.
+*/
+QVariantList QchDBusBatch::replies() const {
+    Q_D(const QchDBusBatch);
+    return d->replies;
+}
+
+/*!
+    \brief Sends all messages in the batch.
+*/
+void QchDBusBatch::send() {
+    Q_D(QchDBusBatch);
+
+    if (d->status == QchDBusMessage::Loading) {
+        return;
+    }
+
+    d->replies.clear();
+    d->status = QchDBusMessage::Loading;
+    d->sending = true;
+    emit statusChanged();
+
+    foreach (QchDBusMessage *message, d->messages) {
+        message->send();
+    }
+
+    // Messages that do not await a reply complete while they are sent
+    d->sending = false;
+    d->checkFinished();
+}
+
+/*!
+    \brief Cancels all messages in the batch that are awaiting a reply.
+    
+    The \link status\endlink is reset to \c DBusMessage.Null.
+    
+    \sa DBusMessage::cancel()
+*/
+void QchDBusBatch::cancel() {
+    Q_D(QchDBusBatch);
+
+    if (d->status != QchDBusMessage::Loading) {
+        return;
+    }
+
+    d->status = QchDBusMessage::Null;
+
+    foreach (QchDBusMessage *message, d->messages) {
+        message->cancel();
+    }
+
+    emit statusChanged();
+}
+
+#include "moc_qchdbusbatch.cpp"
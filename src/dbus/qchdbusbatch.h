@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2016 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QCHDBUSBATCH_H
+#define QCHDBUSBATCH_H
+
+#include "qchdbusmessage.h"
+#include <QObject>
+#include <qdeclarative.h>
+
+class QchDBusBatchPrivate;
+
+class QchDBusBatch : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QDeclarativeListProperty<QchDBusMessage> messages READ messages)
+    Q_PROPERTY(QchDBusMessage::Status status READ status NOTIFY statusChanged)
+    Q_PROPERTY(QVariantList replies READ replies NOTIFY statusChanged)
+
+    Q_CLASSINFO("DefaultProperty", "messages")
+
+public:
+    explicit QchDBusBatch(QObject *parent = 0);
+    ~QchDBusBatch();
+
+    QDeclarativeListProperty<QchDBusMessage> messages();
+
+    QchDBusMessage::Status status() const;
+
+    QVariantList replies() const;
+
+public Q_SLOTS:
+    void send();
+    void cancel();
+
+Q_SIGNALS:
+    void statusChanged();
+
+protected:
+    QScopedPointer<QchDBusBatchPrivate> d_ptr;
+
+    Q_DECLARE_PRIVATE(QchDBusBatch)
+
+    Q_PRIVATE_SLOT(d_func(), void _q_onMessageStatusChanged())
+
+private:
+    Q_DISABLE_COPY(QchDBusBatch)
+};
+
+QML_DECLARE_TYPE(QchDBusBatch)
+
+#endif // QCHDBUSBATCH_H
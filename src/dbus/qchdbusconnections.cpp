@@ -15,14 +15,40 @@
  */
 
 #include "qchdbusconnections.h"
+#include "qchdbusintrospection.h"
 #include "qchdbusutils.h"
 #include <QDBusArgument>
 #include <QDBusConnection>
-#include <QDBusInterface>
 #include <QDBusMessage>
 #include <QDeclarativeInfo>
+#include <QElapsedTimer>
 #include <QMetaMethod>
 #include <QMetaObject>
+#include <QTimer>
+
+// The state of delivery of a D-Bus signal to its QML signal
+struct QchDBusSignalDelivery {
+    QchDBusSignalDelivery() :
+        policy(QchDBusConnections::ImmediateDelivery),
+        interval(0),
+        pending(false),
+        dropped(0),
+        coalesced(0)
+    {
+        lastDelivery.invalidate();
+    }
+    
+    QchDBusConnections::DeliveryPolicy policy;
+    int interval;
+    
+    QElapsedTimer lastDelivery;
+    
+    QDBusMessage message;
+    bool pending;
+    
+    int dropped;
+    int coalesced;
+};
 
 class QchDBusConnectionsPrivate
 {
@@ -32,8 +58,14 @@ public:
         q_ptr(parent),
         bus(QchDBus::SessionBus),
         complete(false),
-        enabled(true)
+        enabled(true),
+        introspecting(false),
+        throttleRate(60),
+        timer(0),
+        timerDue(0),
+        statisticsDirty(false)
     {
+        clock.start();
     }
     
     ~QchDBusConnectionsPrivate() {
@@ -46,9 +78,25 @@ public:
         }
                 
         Q_Q(QchDBusConnections);
-        QDBusConnection connection = QchDBus::connection(bus);
-        QDBusInterface iface(service, path.isEmpty() ? "/" : path, interface, connection);
-        QList<QByteArray> signalNames = QchDBusUtils::getSignalNames(iface);
+        QchDBusInterfaceInfo info;
+        
+        if (!QchDBusIntrospection::instance()->interfaceInfo(bus, service, path.isEmpty() ? "/" : path, interface,
+                                                              &info)) {
+            // The signals are connected when the introspection data is available
+            if (!introspecting) {
+                introspecting = true;
+                q->connect(QchDBusIntrospection::instance(), SIGNAL(finished(int,QString,QString)),
+                           q, SLOT(_q_onIntrospectionFinished(int,QString,QString)));
+            }
+            
+            return;
+        }
+        
+        QList<QByteArray> signalNames;
+        
+        foreach (const QchDBusMethod &dbusSignal, info.dbusSignals) {
+            signalNames << dbusSignal.methodName;
+        }
         
         if (signalNames.isEmpty()) {
             qmlInfo(q) << QchDBusConnections::tr("No signals found");
@@ -102,18 +150,86 @@ public:
             connection.disconnect(service, path.isEmpty() ? "/" : path, interface, dynamicSignal, q,
                                   SLOT(_q_handleSignal(QDBusMessage)));
         }
+        
+        // Signals received from the previous connections are discarded
+        QMutableHashIterator<QString, QchDBusSignalDelivery> iterator(deliveries);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            iterator.value().pending = false;
+            iterator.value().message = QDBusMessage();
+        }
     }
     
-    void clearSignals() {
-        disconnectSignals();
-        dynamicSignals.clear();
+    /*
+     * Applies the policy from deliveryPolicies to the D-Bus signal. A policy may be given either for the
+     * D-Bus signal name or for the QML signal name.
+     */
+    void applyPolicy(const QString &member, QchDBusSignalDelivery &d) const {
+        QVariant value = policies.value(member);
+        
+        if (!value.isValid()) {
+            value = policies.value(member.left(1).toLower() + member.mid(1));
+        }
+        
+        int rate = throttleRate;
+        
+        if (value.type() == QVariant::Map) {
+            const QVariantMap map = value.toMap();
+            d.policy = QchDBusConnections::DeliveryPolicy(map.value("policy").toInt());
+            rate = map.value("rate", throttleRate).toInt();
+        }
+        else {
+            d.policy = QchDBusConnections::DeliveryPolicy(value.toInt());
+        }
+        
+        d.interval = rate > 0 ? 1000 / rate : 0;
     }
+    
+    QchDBusSignalDelivery& delivery(const QString &member) {
+        QHash<QString, QchDBusSignalDelivery>::iterator iterator = deliveries.find(member);
         
-    void _q_handleSignal(const QDBusMessage &message) {        
-        if (!dynamicSignals.contains(message.member())) {
-            return;
+        if (iterator == deliveries.end()) {
+            iterator = deliveries.insert(member, QchDBusSignalDelivery());
+            applyPolicy(member, iterator.value());
         }
         
+        return iterator.value();
+    }
+    
+    // Reapplies the policies to all signals, keeping the statistics and any pending signals
+    void resetPolicies() {
+        bool pending = false;
+        QMutableHashIterator<QString, QchDBusSignalDelivery> iterator(deliveries);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            applyPolicy(iterator.key(), iterator.value());
+            pending = (pending) || (iterator.value().pending);
+        }
+        
+        if (pending) {
+            scheduleDelivery(0);
+        }
+    }
+    
+    void scheduleDelivery(int msecs) {
+        if (!timer) {
+            Q_Q(QchDBusConnections);
+            timer = new QTimer(q);
+            timer->setSingleShot(true);
+            q->connect(timer, SIGNAL(timeout()), q, SLOT(_q_deliverPendingSignals()));
+        }
+        
+        const qint64 due = clock.elapsed() + msecs;
+        
+        if ((!timer->isActive()) || (due < timerDue)) {
+            timerDue = due;
+            timer->start(msecs);
+        }
+    }
+    
+    void deliver(const QDBusMessage &message) {
         Q_Q(QchDBusConnections);
         QVariantList arguments;
         
@@ -134,7 +250,147 @@ public:
         }
         
         const QMetaMethod &method = q->metaObject()->method(dynamicSignals.value(message.member()));
-        method.invoke(q, args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7], args[8], args[9]);      
+        method.invoke(q, args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7], args[8], args[9]);
+    }
+    
+    void clearSignals() {
+        disconnectSignals();
+        dynamicSignals.clear();
+    }
+        
+    void _q_onIntrospectionFinished(int b, const QString &s, const QString &p) {
+        if ((b != bus) || (s != service) || (p != (path.isEmpty() ? "/" : path))) {
+            return;
+        }
+        
+        Q_Q(QchDBusConnections);
+        introspecting = false;
+        q->disconnect(QchDBusIntrospection::instance(), SIGNAL(finished(int,QString,QString)),
+                      q, SLOT(_q_onIntrospectionFinished(int,QString,QString)));
+        clearSignals();
+        getSignals();
+        
+        if (enabled) {
+            connectSignals();
+        }
+    }
+    
+    // A service that was missing or replaced may provide other signals, so they are looked up again
+    void _q_onIntrospectionInvalidated(int b, const QString &s, bool hasOwner) {
+        if ((!hasOwner) || (b != bus) || (s != service)) {
+            return;
+        }
+        
+        clearSignals();
+        getSignals();
+        
+        if (enabled) {
+            connectSignals();
+        }
+    }
+        
+    void _q_handleSignal(const QDBusMessage &message) {        
+        if (!dynamicSignals.contains(message.member())) {
+            return;
+        }
+        
+        QchDBusSignalDelivery &d = delivery(message.member());
+        
+        switch (d.policy) {
+        case QchDBusConnections::ThrottledDelivery:
+            if ((!d.pending) && ((!d.lastDelivery.isValid()) || (d.lastDelivery.elapsed() >= d.interval))) {
+                d.lastDelivery.start();
+                deliver(message);
+                return;
+            }
+            
+            // The latest signal is delivered at the end of the interval, and any it replaces is dropped
+            if (d.pending) {
+                d.dropped++;
+                statisticsDirty = true;
+            }
+            
+            d.message = message;
+            d.pending = true;
+            scheduleDelivery(qMax(0, d.interval - int(d.lastDelivery.elapsed())));
+            return;
+        case QchDBusConnections::LatestValueDelivery:
+            // Signals received before control returns to the event loop are coalesced
+            if (d.pending) {
+                d.coalesced++;
+                statisticsDirty = true;
+            }
+            
+            d.message = message;
+            d.pending = true;
+            scheduleDelivery(0);
+            return;
+        default:
+            deliver(message);
+            return;
+        }
+    }
+    
+    void _q_deliverPendingSignals() {
+        int wait = -1;
+        QList<QDBusMessage> messages;
+        QMutableHashIterator<QString, QchDBusSignalDelivery> iterator(deliveries);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            QchDBusSignalDelivery &d = iterator.value();
+            
+            if (!d.pending) {
+                continue;
+            }
+            
+            if ((d.policy == QchDBusConnections::ThrottledDelivery) && (d.lastDelivery.isValid())) {
+                const int remaining = d.interval - int(d.lastDelivery.elapsed());
+                
+                if (remaining > 0) {
+                    wait = wait < 0 ? remaining : qMin(wait, remaining);
+                    continue;
+                }
+            }
+            
+            d.lastDelivery.start();
+            d.pending = false;
+            messages << d.message;
+            d.message = QDBusMessage();
+        }
+        
+        if (wait >= 0) {
+            scheduleDelivery(wait);
+        }
+        
+        // The QML handlers may change the connections, so they are invoked after the deliveries are updated
+        foreach (const QDBusMessage &message, messages) {
+            if (dynamicSignals.contains(message.member())) {
+                deliver(message);
+            }
+        }
+        
+        if (statisticsDirty) {
+            Q_Q(QchDBusConnections);
+            statisticsDirty = false;
+            emit q->statisticsChanged();
+        }
+    }
+    
+    QVariantMap statistics(bool dropped) const {
+        QVariantMap map;
+        QHashIterator<QString, QchDBusSignalDelivery> iterator(deliveries);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            const int count = dropped ? iterator.value().dropped : iterator.value().coalesced;
+            
+            if (count > 0) {
+                map[iterator.key()] = count;
+            }
+        }
+        
+        return map;
     }
     
     QchDBusConnections *q_ptr;
@@ -149,6 +405,18 @@ public:
         
     bool complete;
     bool enabled;
+    bool introspecting;
+    
+    QVariantMap policies;
+    int throttleRate;
+    
+    QHash<QString, QchDBusSignalDelivery> deliveries;
+    
+    QElapsedTimer clock;
+    QTimer *timer;
+    qint64 timerDue;
+    
+    bool statisticsDirty;
         
     Q_DECLARE_PUBLIC(QchDBusConnections);
 };
@@ -219,6 +487,83 @@ void QchDBusConnections::setBus(QchDBus::BusType b) {
     }
 }
 
+/*!
+    \brief The number of signals that were coalesced, by signal name.
+    
+    A signal is coalesced when it is replaced by a later signal before it is delivered 
+    with \c DBusConnections.LatestValueDelivery.
+    
+    \sa deliveryPolicies, droppedSignals, resetStatistics()
+*/
+QVariantMap QchDBusConnections::coalescedSignals() const {
+    Q_D(const QchDBusConnections);
+    return d->statistics(false);
+}
+
+/*!
+    \brief The delivery policy of each signal.
+    
+    The keys are signal names, and the values are either a policy or a map containing 
+    \c policy and \c rate. Signals that are not present use 
+    \c DBusConnections.ImmediateDelivery.
+    
+    Possible policies are:
+    
+    <table>
+        <tr>
+            <th>Value</th>
+            <th>Description</th>
+        </tr>
+        <tr>
+            <td>DBusConnections.ImmediateDelivery</td>
+            <td>Every signal is delivered when it is received (default).</td>
+        </tr>
+        <tr>
+            <td>DBusConnections.ThrottledDelivery</td>
+            <td>Signals are delivered at most \c rate times per second. Only the latest signal 
+            received during each interval is delivered, and the others are dropped.</td>
+        </tr>
+        <tr>
+            <td>DBusConnections.LatestValueDelivery</td>
+            <td>Only the latest of the signals received before control returns to the event 
+            loop is delivered, and the others are coalesced.</td>
+        </tr>
+    </table>
+    
+    \code
+    deliveryPolicies: {
+        "progressChanged": DBusConnections.LatestValueDelivery,
+        "orientationChanged": {"policy": DBusConnections.ThrottledDelivery, "rate": 10}
+    }
+    \endcode
+    
+    \sa throttleRate
+*/
+QVariantMap QchDBusConnections::deliveryPolicies() const {
+    Q_D(const QchDBusConnections);
+    return d->policies;
+}
+
+void QchDBusConnections::setDeliveryPolicies(const QVariantMap &policies) {
+    Q_D(QchDBusConnections);
+    d->policies = policies;
+    d->resetPolicies();
+    emit deliveryPoliciesChanged();
+}
+
+/*!
+    \brief The number of signals that were dropped, by signal name.
+    
+    A signal is dropped when it is replaced by a later signal before it is delivered 
+    with \c DBusConnections.ThrottledDelivery.
+    
+    \sa deliveryPolicies, coalescedSignals, resetStatistics()
+*/
+QVariantMap QchDBusConnections::droppedSignals() const {
+    Q_D(const QchDBusConnections);
+    return d->statistics(true);
+}
+
 /*!
     \brief Whether signal connections are enabled.
     
@@ -321,11 +666,51 @@ void QchDBusConnections::setServiceName(const QString &name) {
     }
 }
 
+/*!
+    \brief The default number of times per second that a signal is delivered with 
+    \c DBusConnections.ThrottledDelivery.
+    
+    The default value is \c 60.
+    
+    \sa deliveryPolicies
+*/
+int QchDBusConnections::throttleRate() const {
+    Q_D(const QchDBusConnections);
+    return d->throttleRate;
+}
+
+void QchDBusConnections::setThrottleRate(int rate) {
+    if (rate != throttleRate()) {
+        Q_D(QchDBusConnections);
+        d->throttleRate = rate;
+        d->resetPolicies();
+        emit throttleRateChanged();
+    }
+}
+
+/*!
+    \brief Resets the \link droppedSignals\endlink and \link coalescedSignals\endlink counts.
+*/
+void QchDBusConnections::resetStatistics() {
+    Q_D(QchDBusConnections);
+    QMutableHashIterator<QString, QchDBusSignalDelivery> iterator(d->deliveries);
+    
+    while (iterator.hasNext()) {
+        iterator.next();
+        iterator.value().dropped = 0;
+        iterator.value().coalesced = 0;
+    }
+    
+    emit statisticsChanged();
+}
+
 void QchDBusConnections::classBegin() {}
 
 void QchDBusConnections::componentComplete() {
     Q_D(QchDBusConnections);
     d->complete = true;
+    connect(QchDBusIntrospection::instance(), SIGNAL(invalidated(int,QString,bool)),
+            this, SLOT(_q_onIntrospectionInvalidated(int,QString,bool)));
     d->getSignals();
     
     if (d->enabled) {
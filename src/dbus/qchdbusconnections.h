@@ -20,6 +20,7 @@
 #include "qchdbus.h"
 #include <QObject>
 #include <QDeclarativeParserStatus>
+#include <QVariantMap>
 #include <qdeclarative.h>
 
 class QDBusMessage;
@@ -30,20 +31,40 @@ class QchDBusConnections : public QObject, public QDeclarativeParserStatus
     Q_OBJECT
     
     Q_PROPERTY(QchDBus::BusType bus READ bus WRITE setBus NOTIFY busChanged)
+    Q_PROPERTY(QVariantMap coalescedSignals READ coalescedSignals NOTIFY statisticsChanged)
+    Q_PROPERTY(QVariantMap deliveryPolicies READ deliveryPolicies WRITE setDeliveryPolicies
+               NOTIFY deliveryPoliciesChanged)
+    Q_PROPERTY(QVariantMap droppedSignals READ droppedSignals NOTIFY statisticsChanged)
     Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
     Q_PROPERTY(QString interfaceName READ interfaceName WRITE setInterfaceName NOTIFY interfaceNameChanged)
     Q_PROPERTY(QString path READ path WRITE setPath NOTIFY pathChanged)
     Q_PROPERTY(QString serviceName READ serviceName WRITE setServiceName NOTIFY serviceNameChanged)
+    Q_PROPERTY(int throttleRate READ throttleRate WRITE setThrottleRate NOTIFY throttleRateChanged)
+    
+    Q_ENUMS(DeliveryPolicy)
     
     Q_INTERFACES(QDeclarativeParserStatus)
 
 public:
+    enum DeliveryPolicy {
+        ImmediateDelivery = 0,
+        ThrottledDelivery,
+        LatestValueDelivery
+    };
+    
     explicit QchDBusConnections(QObject *parent = 0);
     ~QchDBusConnections();
     
     QchDBus::BusType bus() const;
     void setBus(QchDBus::BusType b);
     
+    QVariantMap coalescedSignals() const;
+    
+    QVariantMap deliveryPolicies() const;
+    void setDeliveryPolicies(const QVariantMap &policies);
+    
+    QVariantMap droppedSignals() const;
+    
     bool isEnabled() const;
     void setEnabled(bool enabled);
     
@@ -55,13 +76,22 @@ public:
     
     QString serviceName() const;
     void setServiceName(const QString &name);
+    
+    int throttleRate() const;
+    void setThrottleRate(int rate);
+
+public Q_SLOTS:
+    void resetStatistics();
         
 Q_SIGNALS:
     void busChanged();
+    void deliveryPoliciesChanged();
     void enabledChanged();
     void interfaceNameChanged();
     void pathChanged();
     void serviceNameChanged();
+    void statisticsChanged();
+    void throttleRateChanged();
 
 protected:
     QchDBusConnections(QchDBusConnectionsPrivate &dd, QObject *parent = 0);
@@ -73,7 +103,10 @@ protected:
     
     Q_DECLARE_PRIVATE(QchDBusConnections)
     
+    Q_PRIVATE_SLOT(d_func(), void _q_onIntrospectionFinished(int,QString,QString))
+    Q_PRIVATE_SLOT(d_func(), void _q_onIntrospectionInvalidated(int,QString,bool))
     Q_PRIVATE_SLOT(d_func(), void _q_handleSignal(QDBusMessage))
+    Q_PRIVATE_SLOT(d_func(), void _q_deliverPendingSignals())
     
 private:
     Q_DISABLE_COPY(QchDBusConnections)
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2016 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qchdbusintrospection.h"
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QMetaType>
+#include <QStringList>
+#include <QXmlStreamReader>
+
+static const QString TYPE_ANNOTATION_IN("com.trolltech.QtDBus.QtTypeName.In");
+static const QString TYPE_ANNOTATION_OUT("com.trolltech.QtDBus.QtTypeName.Out");
+
+// The time in milliseconds for which a failed introspection is cached before it is repeated
+static const int ERROR_EXPIRY = 5000;
+
+QchDBusIntrospection* QchDBusIntrospection::instance() {
+    static QchDBusIntrospection *self = 0;
+
+    if (!self) {
+        self = new QchDBusIntrospection;
+    }
+
+    return self;
+}
+
+QchDBusIntrospection::QchDBusIntrospection() :
+    QObject(),
+    lastSerial(0)
+{
+    watchingBus[QchDBus::SessionBus] = false;
+    watchingBus[QchDBus::SystemBus] = false;
+    clock.start();
+}
+
+/*
+ * Copies the introspection data for the interface into info and returns true if it is cached.
+ * Otherwise the object is introspected asynchronously, finished() is emitted when the data is
+ * available, and false is returned. If interface is empty, the data of all interfaces is merged.
+ *
+ * An object that could not be introspected is briefly cached as having no interfaces, and is
+ * introspected again when it is next used after that.
+ *
+ * The id of info changes whenever the object is introspected again, so it can be used as the key
+ * of data derived from the methods and signals.
+ */
+bool QchDBusIntrospection::interfaceInfo(QchDBus::BusType bus, const QString &service, const QString &path,
+                                         const QString &interface, QchDBusInterfaceInfo *info) {
+    QHash<QString, Node>::const_iterator iterator = nodes.constFind(key(bus, service, path));
+
+    if ((iterator == nodes.constEnd())
+        || ((iterator.value().expiry >= 0) && (clock.elapsed() >= iterator.value().expiry))) {
+        introspect(bus, service, path);
+        return false;
+    }
+
+    if (!iterator.value().ready) {
+        return false;
+    }
+
+    const QByteArray id = QByteArray::number(iterator.value().serial) + '|' + interface.toLatin1();
+
+    if (!interface.isEmpty()) {
+        *info = iterator.value().interfaces.value(interface);
+        info->id = id;
+        return true;
+    }
+
+    *info = QchDBusInterfaceInfo();
+    info->id = id;
+
+    foreach (const QchDBusInterfaceInfo &i, iterator.value().interfaces) {
+        info->methods += i.methods;
+        info->dbusSignals += i.dbusSignals;
+    }
+
+    return true;
+}
+
+QString QchDBusIntrospection::key(QchDBus::BusType bus, const QString &service, const QString &path) {
+    return QString("%1|%2|%3").arg(bus).arg(service).arg(path);
+}
+
+QHash<QString, QchDBusInterfaceInfo> QchDBusIntrospection::parse(const QString &xml) {
+    QHash<QString, QchDBusInterfaceInfo> interfaces;
+    QXmlStreamReader reader(xml);
+    QString interface;
+    QchDBusMethod method("", QList<QByteArray>());
+    bool inRoot = false;
+    bool inMethod = false;
+    bool isSignal = false;
+
+    while (!reader.atEnd()) {
+        reader.readNext();
+
+        if (reader.isStartElement()) {
+            const QStringRef name = reader.name();
+            const QXmlStreamAttributes attributes = reader.attributes();
+
+            if (name == QLatin1String("node")) {
+                // Child nodes are introspected separately when they are used
+                if (inRoot) {
+                    reader.skipCurrentElement();
+                }
+
+                inRoot = true;
+            }
+            else if (name == QLatin1String("interface")) {
+                interface = attributes.value("name").toString();
+            }
+            else if ((name == QLatin1String("method")) || (name == QLatin1String("signal"))) {
+                inMethod = true;
+                isSignal = (name == QLatin1String("signal"));
+                method = QchDBusMethod(attributes.value("name").toString().toLatin1(), QList<QByteArray>());
+            }
+            else if ((name == QLatin1String("arg")) && (inMethod)) {
+                // Only the input arguments of methods are needed to marshall a call
+                if ((!isSignal) && (attributes.value("direction") == QLatin1String("out"))) {
+                    continue;
+                }
+
+                QByteArray argName = attributes.value("name").toString().toLatin1();
+
+                if (argName.isEmpty()) {
+                    argName = "arg" + QByteArray::number(method.parameterNames.size() + 1);
+                }
+
+                method.parameterNames << argName;
+                method.parameterTypes << QchDBusUtils::signatureToType(attributes.value("type").toString());
+            }
+            else if ((name == QLatin1String("annotation")) && (inMethod)) {
+                // Qt services describe types that have no D-Bus signature mapping with an annotation
+                const QString annotation = attributes.value("name").toString();
+                const QString prefix = isSignal ? TYPE_ANNOTATION_OUT : TYPE_ANNOTATION_IN;
+
+                if (annotation.startsWith(prefix)) {
+                    const int index = annotation.mid(prefix.size()).toInt();
+
+                    if ((index >= 0) && (index < method.parameterTypes.size())) {
+                        method.parameterTypes[index] = QMetaType::type(attributes.value("value").toString().toLatin1());
+                    }
+                }
+            }
+        }
+        else if (reader.isEndElement()) {
+            const QStringRef name = reader.name();
+
+            if ((name == QLatin1String("method")) || (name == QLatin1String("signal"))) {
+                if (isSignal) {
+                    interfaces[interface].dbusSignals << method;
+                }
+                else {
+                    interfaces[interface].methods << method;
+                }
+
+                inMethod = false;
+            }
+            else if (name == QLatin1String("interface")) {
+                interface.clear();
+            }
+        }
+    }
+
+    return interfaces;
+}
+
+void QchDBusIntrospection::introspect(QchDBus::BusType bus, const QString &service, const QString &path) {
+    QDBusConnection connection = QchDBus::connection(bus);
+
+    if (!watchingBus[bus]) {
+        watchingBus[bus] = connection.connect("org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus",
+                                              "NameOwnerChanged", this, bus == QchDBus::SystemBus
+                                              ? SLOT(onSystemNameOwnerChanged(QString,QString,QString))
+                                              : SLOT(onSessionNameOwnerChanged(QString,QString,QString)));
+    }
+
+    nodes.insert(key(bus, service, path), Node());
+    QDBusMessage message = QDBusMessage::createMethodCall(service, path, "org.freedesktop.DBus.Introspectable",
+                                                          "Introspect");
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(connection.asyncCall(message), this);
+    watcher->setProperty("bus", int(bus));
+    watcher->setProperty("service", service);
+    watcher->setProperty("path", path);
+    connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(onIntrospectFinished(QDBusPendingCallWatcher*)));
+}
+
+/*
+ * Removes the cached data of the objects of the service name, and emits invalidated(), so that
+ * objects using the data can request it again when the service has a new owner.
+ */
+void QchDBusIntrospection::invalidate(QchDBus::BusType bus, const QString &name, bool hasOwner) {
+    const QString prefix = QString("%1|%2|").arg(bus).arg(name);
+    QMutableHashIterator<QString, Node> iterator(nodes);
+
+    while (iterator.hasNext()) {
+        iterator.next();
+
+        if (!iterator.key().startsWith(prefix)) {
+            continue;
+        }
+
+        // Pending requests may have been answered by the previous owner, so they are repeated when
+        // they complete, and the objects waiting for them are notified of the new data
+        if (iterator.value().ready) {
+            iterator.remove();
+        }
+        else {
+            iterator.value().stale = true;
+        }
+    }
+
+    emit invalidated(bus, name, hasOwner);
+}
+
+void QchDBusIntrospection::onIntrospectFinished(QDBusPendingCallWatcher *watcher) {
+    const QchDBus::BusType bus = QchDBus::BusType(watcher->property("bus").toInt());
+    const QString service = watcher->property("service").toString();
+    const QString path = watcher->property("path").toString();
+    const QDBusPendingReply<QString> reply = *watcher;
+    Node &node = nodes[key(bus, service, path)];
+    watcher->deleteLater();
+
+    if (node.stale) {
+        introspect(bus, service, path);
+        return;
+    }
+
+    if (reply.isError()) {
+        // The service may be starting or busy, so the failure is not cached for long
+        node.interfaces.clear();
+        node.expiry = clock.elapsed() + ERROR_EXPIRY;
+    }
+    else {
+        node.interfaces = parse(reply.value());
+        node.expiry = -1;
+    }
+
+    node.ready = true;
+    node.serial = ++lastSerial;
+    emit finished(bus, service, path);
+}
+
+void QchDBusIntrospection::onSessionNameOwnerChanged(const QString &name, const QString &oldOwner,
+                                                     const QString &newOwner) {
+    invalidate(QchDBus::SessionBus, name, !newOwner.isEmpty());
+
+    if (!oldOwner.isEmpty()) {
+        invalidate(QchDBus::SessionBus, oldOwner, false);
+    }
+}
+
+void QchDBusIntrospection::onSystemNameOwnerChanged(const QString &name, const QString &oldOwner,
+                                                    const QString &newOwner) {
+    invalidate(QchDBus::SystemBus, name, !newOwner.isEmpty());
+
+    if (!oldOwner.isEmpty()) {
+        invalidate(QchDBus::SystemBus, oldOwner, false);
+    }
+}
+
+#include "moc_qchdbusintrospection.cpp"
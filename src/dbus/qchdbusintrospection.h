@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2016 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QCHDBUSINTROSPECTION_H
+#define QCHDBUSINTROSPECTION_H
+
+#include "qchdbus.h"
+#include "qchdbusutils.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+
+class QDBusPendingCallWatcher;
+
+struct QchDBusInterfaceInfo {
+    QList<QchDBusMethod> methods;
+    QList<QchDBusMethod> dbusSignals;
+    QByteArray id; // Identifies the introspection data that the info was copied from
+};
+
+/*
+ * Process-wide cache of introspection data, keyed by bus, service and path. Each object path is
+ * introspected once, asynchronously, and the data for all of its interfaces is kept until the owner
+ * of the service changes.
+ */
+class QchDBusIntrospection : public QObject
+{
+    Q_OBJECT
+
+public:
+    static QchDBusIntrospection* instance();
+
+    bool interfaceInfo(QchDBus::BusType bus, const QString &service, const QString &path,
+                       const QString &interface, QchDBusInterfaceInfo *info);
+
+Q_SIGNALS:
+    void finished(int bus, const QString &service, const QString &path);
+    void invalidated(int bus, const QString &service, bool hasOwner);
+
+private Q_SLOTS:
+    void onIntrospectFinished(QDBusPendingCallWatcher *watcher);
+    void onSessionNameOwnerChanged(const QString &name, const QString &oldOwner, const QString &newOwner);
+    void onSystemNameOwnerChanged(const QString &name, const QString &oldOwner, const QString &newOwner);
+
+private:
+    struct Node {
+        Node() : ready(false), stale(false), serial(0), expiry(-1) {}
+
+        QHash<QString, QchDBusInterfaceInfo> interfaces;
+        bool ready;
+        bool stale;
+        int serial;
+        qint64 expiry; // The clock time after which a failed introspection is repeated, or -1
+
+    };
+
+    QchDBusIntrospection();
+
+    static QString key(QchDBus::BusType bus, const QString &service, const QString &path);
+
+    static QHash<QString, QchDBusInterfaceInfo> parse(const QString &xml);
+
+    void introspect(QchDBus::BusType bus, const QString &service, const QString &path);
+    void invalidate(QchDBus::BusType bus, const QString &name, bool hasOwner);
+
+    QHash<QString, Node> nodes;
+
+    bool watchingBus[2];
+
+    int lastSerial;
+
+    QElapsedTimer clock;
+
+    Q_DISABLE_COPY(QchDBusIntrospection)
+};
+
+#endif // QCHDBUSINTROSPECTION_H
@@ -15,12 +15,15 @@
  */
 
 #include "qchdbusmessage.h"
+#include "qchdbusintrospection.h"
+#include "qchdbuspendingcalls.h"
 #include "qchdbusutils.h"
-#include <QDBusInterface>
 #include <QDBusConnection>
+#include <QDBusError>
 #include <QDBusMessage>
 #include <QDBusArgument>
 #include <QDeclarativeInfo>
+#include <QTimer>
 
 class QchDBusMessagePrivate
 {
@@ -31,10 +34,65 @@ public:
         path("/"),
         bus(QchDBus::SessionBus),
         type(QchDBusMessage::MethodCallMessage),
-        status(QchDBusMessage::Null)
+        status(QchDBusMessage::Null),
+        timeout(-1),
+        timer(0),
+        coalesce(false),
+        introspecting(false)
     {
     }
     
+    void send() {
+        Q_Q(QchDBusMessage);
+
+        if ((!arguments.isEmpty()) && (convertedArguments.isEmpty()) && (!service.isEmpty())
+            && (type != QchDBusMessage::ErrorMessage)) {
+            QchDBusInterfaceInfo info;
+
+            if (!QchDBusIntrospection::instance()->interfaceInfo(bus, service, path.isEmpty() ? "/" : path,
+                                                                  interface, &info)) {
+                // The arguments are converted and the message sent when the introspection data is available
+                introspectionKey = QString("%1|%2|%3").arg(bus).arg(service).arg(path.isEmpty() ? "/" : path);
+
+                if (!introspecting) {
+                    introspecting = true;
+                    q->connect(QchDBusIntrospection::instance(), SIGNAL(finished(int,QString,QString)),
+                               q, SLOT(_q_onIntrospectionFinished(int,QString,QString)));
+                }
+
+                status = QchDBusMessage::Loading;
+                emit q->statusChanged();
+                return;
+            }
+
+            if (type == QchDBusMessage::SignalMessage) {
+                convertedArguments = QchDBusUtils::convertMethodCallArguments(info.methods + info.dbusSignals, method,
+                                                                              arguments, info.id + "|signal");
+            }
+            else {
+                convertedArguments = QchDBusUtils::convertMethodCallArguments(info.methods, method, arguments,
+                                                                              info.id);
+            }
+        }
+
+        switch (type) {
+        case QchDBusMessage::MethodCallMessage:
+            callMethod();
+            return;
+        case QchDBusMessage::SignalMessage:
+            emitSignal();
+            return;
+        case QchDBusMessage::ReplyMessage:
+            sendReply();
+            return;
+        case QchDBusMessage::ErrorMessage:
+            sendError();
+            return;
+        default:
+            return;
+        }
+    }
+
     void callMethod() {
         Q_Q(QchDBusMessage);
 
@@ -45,22 +103,13 @@ public:
         else {
             status = QchDBusMessage::Loading;
             QDBusMessage message = QDBusMessage::createMethodCall(service, path.isEmpty() ? "/" : path, interface, method);
-            QDBusConnection connection = QchDBus::connection(bus);
 
             if (!arguments.isEmpty()) {
-                if (convertedArguments.isEmpty()) {
-                    QDBusInterface iface(service, path.isEmpty() ? "/" : path, interface, connection);
-                    convertedArguments = QchDBusUtils::convertMethodCallArguments(iface, method, arguments);
-                }
-
-                message.setArguments(convertedArguments);
+                message.setArguments(convertedArguments.isEmpty() ? arguments : convertedArguments);
             }
 
-            if (!connection.callWithCallback(message, q, SLOT(_q_onReplyFinished(QDBusMessage)),
-                                             SLOT(_q_onReplyError(QDBusError)))) {
-                status = QchDBusMessage::Error;
-                qmlInfo(q) << QchDBusMessage::tr("Cannot send message.");
-            }
+            pendingKey = QchDBusPendingCalls::instance()->call(bus, message, arguments, coalesce, q,
+                                                               SLOT(_q_onCallFinished(QString,QDBusMessage)), timeout);
         }
 
         emit q->statusChanged();
@@ -78,12 +127,7 @@ public:
             QDBusConnection connection = QchDBus::connection(bus);
 
             if (!arguments.isEmpty()) {
-                if (convertedArguments.isEmpty()) {
-                    QDBusInterface iface(service, path.isEmpty() ? "/" : path, interface, connection);
-                    convertedArguments = QchDBusUtils::convertMethodCallArguments(iface, method, arguments);
-                }
-
-                message.setArguments(convertedArguments);
+                message.setArguments(convertedArguments.isEmpty() ? arguments : convertedArguments);
             }
 
             if (connection.send(message)) {
@@ -105,12 +149,7 @@ public:
         QDBusConnection connection = QchDBus::connection(bus);
 
         if (!arguments.isEmpty()) {
-            if (convertedArguments.isEmpty()) {
-                QDBusInterface iface(service, path.isEmpty() ? "/" : path, interface, connection);
-                convertedArguments = QchDBusUtils::convertMethodCallArguments(iface, method, arguments);
-            }
-
-            message.setArguments(convertedArguments);
+            message.setArguments(convertedArguments.isEmpty() ? arguments : convertedArguments);
         }
 
         if (connection.send(message)) {
@@ -147,7 +186,80 @@ public:
         emit q->statusChanged();
     }
 
-    void _q_onReplyFinished(const QDBusMessage &replyMessage) {
+    void startTimer() {
+        if (timeout <= 0) {
+            return;
+        }
+
+        if (!timer) {
+            Q_Q(QchDBusMessage);
+            timer = new QTimer(q);
+            timer->setSingleShot(true);
+            q->connect(timer, SIGNAL(timeout()), q, SLOT(_q_onTimeout()));
+        }
+
+        timer->start(timeout);
+    }
+
+    void detach() {
+        Q_Q(QchDBusMessage);
+
+        if (!pendingKey.isEmpty()) {
+            QchDBusPendingCalls::instance()->cancel(pendingKey, q);
+            pendingKey.clear();
+        }
+
+        if (introspecting) {
+            introspecting = false;
+            q->disconnect(QchDBusIntrospection::instance(), SIGNAL(finished(int,QString,QString)),
+                          q, SLOT(_q_onIntrospectionFinished(int,QString,QString)));
+        }
+
+        if (timer) {
+            timer->stop();
+        }
+    }
+
+    void _q_onIntrospectionFinished(int b, const QString &s, const QString &p) {
+        if (QString("%1|%2|%3").arg(b).arg(s).arg(p) != introspectionKey) {
+            return;
+        }
+
+        Q_Q(QchDBusMessage);
+        introspecting = false;
+        q->disconnect(QchDBusIntrospection::instance(), SIGNAL(finished(int,QString,QString)),
+                      q, SLOT(_q_onIntrospectionFinished(int,QString,QString)));
+        send();
+    }
+
+    void _q_onCallFinished(const QString &key, const QDBusMessage &replyMessage) {
+        if (key != pendingKey) {
+            return;
+        }
+
+        detach();
+
+        if (replyMessage.type() == QDBusMessage::ErrorMessage) {
+            onReplyError(QDBusError(replyMessage));
+        }
+        else {
+            onReplyFinished(replyMessage);
+        }
+    }
+
+    void _q_onTimeout() {
+        if (status != QchDBusMessage::Loading) {
+            return;
+        }
+
+        Q_Q(QchDBusMessage);
+        detach();
+        status = QchDBusMessage::Error;
+        reply = QchDBusMessage::tr("No reply received within %1 ms").arg(timeout);
+        emit q->statusChanged();
+    }
+
+    void onReplyFinished(const QDBusMessage &replyMessage) {
         QVariantList list;
 
         foreach (const QVariant &arg, replyMessage.arguments()) {
@@ -171,7 +283,7 @@ public:
         emit q->statusChanged();
     }
 
-    void _q_onReplyError(const QDBusError &error) {
+    void onReplyError(const QDBusError &error) {
         Q_Q(QchDBusMessage);
         status = QchDBusMessage::Error;
         reply = error.message();
@@ -196,6 +308,15 @@ public:
 
     QVariant reply;
 
+    int timeout;
+    QTimer *timer;
+
+    bool coalesce;
+    QString pendingKey;
+
+    bool introspecting;
+    QString introspectionKey;
+
     Q_DECLARE_PUBLIC(QchDBusMessage)
 };
 
@@ -345,6 +466,50 @@ void QchDBusMessage::setBus(QchDBus::BusType bus) {
     }
 }
 
+/*!
+    \brief The maximum time in milliseconds to wait for a reply.
+    
+    If no reply is received within the timeout, the \link status\endlink changes to 
+    \c DBusMessage.Error. A value of \c -1 (the default) means the default DBus 
+    timeout is used.
+    
+    \sa coalesce
+*/
+int QchDBusMessage::timeout() const {
+    Q_D(const QchDBusMessage);
+    return d->timeout;
+}
+
+void QchDBusMessage::setTimeout(int t) {
+    if (t != timeout()) {
+        Q_D(QchDBusMessage);
+        d->timeout = t;
+        emit timeoutChanged();
+    }
+}
+
+/*!
+    \brief Whether the method call may share the reply of an identical call.
+    
+    If true, a method call that is identical to another coalesced call awaiting a reply (same 
+    bus, service, path, interface, method and arguments) is not sent again, and receives the 
+    reply to the call that is in flight. This suits queries that are sent repeatedly, but not 
+    calls that change the state of the remote object, or whose reply depends on when they are 
+    received. The default value is \c false.
+*/
+bool QchDBusMessage::coalesce() const {
+    Q_D(const QchDBusMessage);
+    return d->coalesce;
+}
+
+void QchDBusMessage::setCoalesce(bool c) {
+    if (c != coalesce()) {
+        Q_D(QchDBusMessage);
+        d->coalesce = c;
+        emit coalesceChanged();
+    }
+}
+
 /*!
     \brief The message type.
     
@@ -439,21 +604,25 @@ void QchDBusMessage::send() {
         break;
     }
 
-    switch (type()) {
-    case MethodCallMessage:
-        d->callMethod();
-        return;
-    case SignalMessage:
-        d->emitSignal();
-        return;
-    case ReplyMessage:
-        d->sendReply();
-        return;
-    case ErrorMessage:
-        d->sendError();
-        return;
-    default:
-        return;
+    d->send();
+
+    if (d->status == Loading) {
+        d->startTimer();
+    }
+}
+
+/*!
+    \brief Cancels the message if it is awaiting a reply.
+    
+    The \link status\endlink is reset to \c DBusMessage.Null. If the call is shared with 
+    another DBusMessage (see \link coalesce\endlink), that message still receives the reply.
+*/
+void QchDBusMessage::cancel() {
+    if (status() == Loading) {
+        Q_D(QchDBusMessage);
+        d->detach();
+        d->status = Null;
+        emit statusChanged();
     }
 }
 
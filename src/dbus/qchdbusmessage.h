@@ -22,7 +22,6 @@
 #include <qdeclarative.h>
 
 class QDBusMessage;
-class QDBusError;
 class QchDBusMessagePrivate;
 
 class QchDBusMessage : public QObject
@@ -36,6 +35,8 @@ class QchDBusMessage : public QObject
     Q_PROPERTY(QVariantList arguments READ arguments WRITE setArguments NOTIFY argumentsChanged)
     Q_PROPERTY(QchDBus::BusType bus READ bus WRITE setBus NOTIFY busChanged)
     Q_PROPERTY(MessageType type READ type WRITE setType NOTIFY typeChanged)
+    Q_PROPERTY(int timeout READ timeout WRITE setTimeout NOTIFY timeoutChanged)
+    Q_PROPERTY(bool coalesce READ coalesce WRITE setCoalesce NOTIFY coalesceChanged)
     Q_PROPERTY(Status status READ status NOTIFY statusChanged)
     Q_PROPERTY(QVariant reply READ reply NOTIFY statusChanged)
 
@@ -80,12 +81,19 @@ public:
     MessageType type() const;
     void setType(MessageType type);
 
+    int timeout() const;
+    void setTimeout(int t);
+
+    bool coalesce() const;
+    void setCoalesce(bool c);
+
     Status status() const;
 
     QVariant reply() const;
     
 public Q_SLOTS:
     void send();
+    void cancel();
 
 Q_SIGNALS:
     void serviceNameChanged();
@@ -95,6 +103,8 @@ Q_SIGNALS:
     void argumentsChanged();
     void busChanged();
     void typeChanged();
+    void timeoutChanged();
+    void coalesceChanged();
     void statusChanged();
 
 protected:
@@ -104,8 +114,9 @@ protected:
 
     Q_DECLARE_PRIVATE(QchDBusMessage)
 
-    Q_PRIVATE_SLOT(d_func(), void _q_onReplyFinished(QDBusMessage))
-    Q_PRIVATE_SLOT(d_func(), void _q_onReplyError(QDBusError))
+    Q_PRIVATE_SLOT(d_func(), void _q_onIntrospectionFinished(int,QString,QString))
+    Q_PRIVATE_SLOT(d_func(), void _q_onCallFinished(QString,QDBusMessage))
+    Q_PRIVATE_SLOT(d_func(), void _q_onTimeout())
 
 private:
     Q_DISABLE_COPY(QchDBusMessage)
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2016 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qchdbuspendingcalls.h"
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusVariant>
+#include <QMetaMethod>
+#include <QStringList>
+
+// Returns a string that identifies the value of a QML argument, or a unique string if it cannot
+static QString argumentKey(const QVariant &arg) {
+    switch (arg.type()) {
+    case QVariant::List:
+    case QVariant::StringList:
+    {
+        QStringList keys;
+        
+        foreach (const QVariant &v, arg.toList()) {
+            keys << argumentKey(v);
+        }
+        
+        return "[" + keys.join(",") + "]";
+    }
+    case QVariant::Map:
+    {
+        QStringList keys;
+        const QVariantMap map = arg.toMap();
+        QMapIterator<QString, QVariant> iterator(map);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            keys << iterator.key() + ":" + argumentKey(iterator.value());
+        }
+        
+        return "{" + keys.join(",") + "}";
+    }
+    default:
+        break;
+    }
+    
+    if (!arg.isValid()) {
+        return "()";
+    }
+    
+    if (arg.userType() == qMetaTypeId<QDBusVariant>()) {
+        return "v(" + argumentKey(qvariant_cast<QDBusVariant>(arg).variant()) + ")";
+    }
+    
+    // Values without a string form, such as objects, are never considered identical to another value
+    if (!arg.canConvert(QVariant::String)) {
+        static int lastUnique = 0;
+        return QString("#%1").arg(++lastUnique);
+    }
+    
+    return QString("%1(%2)").arg(QString::fromLatin1(arg.typeName())).arg(arg.toString());
+}
+
+QchDBusPendingCalls* QchDBusPendingCalls::instance() {
+    static QchDBusPendingCalls *self = 0;
+    
+    if (!self) {
+        self = new QchDBusPendingCalls;
+    }
+    
+    return self;
+}
+
+QchDBusPendingCalls::QchDBusPendingCalls() :
+    QObject(),
+    lastSerial(0)
+{
+}
+
+/*
+ * Sends the method call message and returns the key that identifies the call. When the reply is
+ * received, member of receiver is invoked with the key and the reply message. Member is given with
+ * the SLOT() macro.
+ *
+ * If coalesce is true and an identical coalesced call is already in flight, the message is not sent
+ * again, and receiver waits on that call instead.
+ */
+QString QchDBusPendingCalls::call(QchDBus::BusType bus, const QDBusMessage &message, const QVariantList &arguments,
+                                  bool coalesce, QObject *receiver, const char *member, int timeout) {
+    // Calls that are not coalesced have a unique key, which cannot match that of a coalesced call
+    const QString k = coalesce ? key(bus, message, arguments)
+                               : QString("#%1|%2").arg(++lastSerial).arg(message.member());
+    Waiter waiter;
+    waiter.receiver = receiver;
+    waiter.member = QMetaObject::normalizedSignature(member + 1);
+    
+    QHash<QString, QList<Waiter> >::iterator iterator = waiters.find(k);
+    
+    if (iterator != waiters.end()) {
+        iterator.value().append(waiter);
+        return k;
+    }
+    
+    waiters.insert(k, QList<Waiter>() << waiter);
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(QchDBus::connection(bus).asyncCall(message, timeout),
+                                                                   this);
+    watcher->setProperty("key", k);
+    connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(onCallFinished(QDBusPendingCallWatcher*)));
+    return k;
+}
+
+/*
+ * Stops receiver waiting on the call identified by key. The call itself is left to complete, since
+ * other objects may be waiting on it.
+ */
+void QchDBusPendingCalls::cancel(const QString &key, QObject *receiver) {
+    QHash<QString, QList<Waiter> >::iterator iterator = waiters.find(key);
+    
+    if (iterator == waiters.end()) {
+        return;
+    }
+    
+    QMutableListIterator<Waiter> waiterIterator(iterator.value());
+    
+    while (waiterIterator.hasNext()) {
+        const QObject *waiting = waiterIterator.next().receiver;
+        
+        if ((!waiting) || (waiting == receiver)) {
+            waiterIterator.remove();
+        }
+    }
+}
+
+QString QchDBusPendingCalls::key(QchDBus::BusType bus, const QDBusMessage &message, const QVariantList &arguments) {
+    QStringList keys;
+    keys << QString::number(bus) << message.service() << message.path() << message.interface() << message.member();
+    
+    foreach (const QVariant &arg, arguments) {
+        keys << argumentKey(arg);
+    }
+    
+    return keys.join("|");
+}
+
+void QchDBusPendingCalls::onCallFinished(QDBusPendingCallWatcher *watcher) {
+    const QString k = watcher->property("key").toString();
+    const QDBusMessage reply = watcher->reply();
+    const QList<Waiter> waiting = waiters.take(k);
+    watcher->deleteLater();
+    
+    foreach (const Waiter &waiter, waiting) {
+        if (waiter.receiver) {
+            const QMetaObject *metaObject = waiter.receiver->metaObject();
+            const int index = metaObject->indexOfMethod(waiter.member);
+            
+            if (index != -1) {
+                metaObject->method(index).invoke(waiter.receiver, Qt::DirectConnection, Q_ARG(QString, k),
+                                                 Q_ARG(QDBusMessage, reply));
+            }
+        }
+    }
+}
+
+#include "moc_qchdbuspendingcalls.cpp"
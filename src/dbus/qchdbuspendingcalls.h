@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2016 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QCHDBUSPENDINGCALLS_H
+#define QCHDBUSPENDINGCALLS_H
+
+#include "qchdbus.h"
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QVariantList>
+
+class QDBusMessage;
+class QDBusPendingCallWatcher;
+
+/*
+ * Process-wide table of method calls awaiting a reply. The reply is delivered only to the objects
+ * waiting on the call. A coalesced call that is identical to a coalesced call already in flight (same
+ * bus, destination, method and arguments) is not sent again, and every caller waiting on it receives
+ * the same reply.
+ */
+class QchDBusPendingCalls : public QObject
+{
+    Q_OBJECT
+
+public:
+    static QchDBusPendingCalls* instance();
+
+    QString call(QchDBus::BusType bus, const QDBusMessage &message, const QVariantList &arguments, bool coalesce,
+                 QObject *receiver, const char *member, int timeout = -1);
+    void cancel(const QString &key, QObject *receiver);
+
+private Q_SLOTS:
+    void onCallFinished(QDBusPendingCallWatcher *watcher);
+
+private:
+    QchDBusPendingCalls();
+
+    struct Waiter {
+        QPointer<QObject> receiver;
+        QByteArray member;
+    };
+
+    static QString key(QchDBus::BusType bus, const QDBusMessage &message, const QVariantList &arguments);
+
+    QHash<QString, QList<Waiter> > waiters;
+
+    int lastSerial;
+
+    Q_DISABLE_COPY(QchDBusPendingCalls)
+};
+
+#endif // QCHDBUSPENDINGCALLS_H
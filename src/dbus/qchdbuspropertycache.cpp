@@ -0,0 +1,422 @@
+/*
+ * Copyright (C) 2016 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qchdbuspropertycache.h"
+#include "qchdbuspendingcalls.h"
+#include "qchdbusutils.h"
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusVariant>
+#include <QDeclarativeInfo>
+#include <QDeclarativePropertyMap>
+#include <QSet>
+
+static const QString PROPERTIES_INTERFACE("org.freedesktop.DBus.Properties");
+
+// Converts a value received in a{sv} to a QML value
+static QVariant propertyValue(QVariant value) {
+    if (value.userType() == qMetaTypeId<QDBusVariant>()) {
+        value = qvariant_cast<QDBusVariant>(value).variant();
+    }
+
+    if (value.canConvert<QDBusArgument>()) {
+        value = QchDBusUtils::dbusArgumentToVariant(value.value<QDBusArgument>());
+    }
+
+    return value;
+}
+
+static QVariantMap propertyValues(const QVariant &arg) {
+    QVariantMap map = propertyValue(arg).toMap();
+    QMutableMapIterator<QString, QVariant> iterator(map);
+
+    while (iterator.hasNext()) {
+        iterator.next();
+        iterator.setValue(propertyValue(iterator.value()));
+    }
+
+    return map;
+}
+
+class QchDBusPropertyCachePrivate
+{
+
+public:
+    QchDBusPropertyCachePrivate(QchDBusPropertyCache *parent) :
+        q_ptr(parent),
+        properties(new QDeclarativePropertyMap(parent)),
+        bus(QchDBus::SessionBus),
+        connectedBus(QchDBus::SessionBus),
+        status(QchDBusMessage::Null),
+        complete(false)
+    {
+    }
+
+    ~QchDBusPropertyCachePrivate() {
+        disconnectSignal();
+    }
+
+    void connectSignal() {
+        Q_Q(QchDBusPropertyCache);
+        connectedBus = bus;
+        connectedService = service;
+        connectedPath = path.isEmpty() ? "/" : path;
+
+        if (!QchDBus::connection(bus).connect(connectedService, connectedPath, PROPERTIES_INTERFACE,
+                                              "PropertiesChanged", q, SLOT(_q_onPropertiesChanged(QDBusMessage)))) {
+            qmlInfo(q) << QchDBusPropertyCache::tr("Cannot connect to signal PropertiesChanged");
+            connectedService.clear();
+        }
+    }
+
+    void disconnectSignal() {
+        if (connectedService.isEmpty()) {
+            return;
+        }
+
+        Q_Q(QchDBusPropertyCache);
+        QchDBus::connection(connectedBus).disconnect(connectedService, connectedPath, PROPERTIES_INTERFACE,
+                                                     "PropertiesChanged", q,
+                                                     SLOT(_q_onPropertiesChanged(QDBusMessage)));
+        connectedService.clear();
+    }
+
+    void clear() {
+        changedNames.clear();
+
+        foreach (const QString &key, properties->keys()) {
+            properties->clear(key);
+        }
+    }
+
+    /*
+     * Requests the values of all properties. A coalesced request may share the reply of an identical
+     * request that is in flight, so values changed after it was sent could be missing from the reply.
+     */
+    void getAll(bool coalesce) {
+        Q_Q(QchDBusPropertyCache);
+        QDBusMessage message = QDBusMessage::createMethodCall(service, path.isEmpty() ? "/" : path,
+                                                              PROPERTIES_INTERFACE, "GetAll");
+        const QVariantList arguments = QVariantList() << interface;
+        message.setArguments(arguments);
+
+        if (!pendingKey.isEmpty()) {
+            QchDBusPendingCalls::instance()->cancel(pendingKey, q);
+        }
+
+        // Only the reply to this request is used. A new request is sent after every change received
+        // so far, so those changes no longer need to be protected from its reply.
+        if (!coalesce) {
+            changedNames.clear();
+        }
+
+        pendingKey = QchDBusPendingCalls::instance()->call(bus, message, arguments, coalesce, q,
+                                                           SLOT(_q_onGetAllFinished(QString,QDBusMessage)));
+
+        if (status != QchDBusMessage::Loading) {
+            status = QchDBusMessage::Loading;
+            emit q->statusChanged();
+        }
+    }
+
+    void reload() {
+        disconnectSignal();
+
+        if ((!complete) || (service.isEmpty()) || (interface.isEmpty())) {
+            if (!pendingKey.isEmpty()) {
+                Q_Q(QchDBusPropertyCache);
+                QchDBusPendingCalls::instance()->cancel(pendingKey, q);
+                pendingKey.clear();
+                status = QchDBusMessage::Null;
+                emit q->statusChanged();
+            }
+
+            return;
+        }
+
+        connectSignal();
+        getAll(true);
+    }
+
+    void _q_onGetAllFinished(const QString &key, const QDBusMessage &reply) {
+        if (key != pendingKey) {
+            return;
+        }
+
+        Q_Q(QchDBusPropertyCache);
+        pendingKey.clear();
+
+        if (reply.type() == QDBusMessage::ErrorMessage) {
+            qmlInfo(q) << reply.errorMessage();
+            status = QchDBusMessage::Error;
+            emit q->statusChanged();
+            return;
+        }
+
+        const QVariantMap values = reply.arguments().isEmpty() ? QVariantMap()
+                                                                : propertyValues(reply.arguments().first());
+        QMapIterator<QString, QVariant> iterator(values);
+
+        while (iterator.hasNext()) {
+            iterator.next();
+
+            // Values changed after the request was sent are newer than those in the reply
+            if (!changedNames.contains(iterator.key())) {
+                properties->insert(iterator.key(), iterator.value());
+            }
+        }
+
+        // Properties that are no longer provided, such as invalidated ones, have no value
+        foreach (const QString &name, properties->keys()) {
+            if ((!values.contains(name)) && (!changedNames.contains(name))) {
+                properties->clear(name);
+            }
+        }
+
+        changedNames.clear();
+        status = QchDBusMessage::Ready;
+        emit q->statusChanged();
+    }
+
+    void _q_onPropertiesChanged(const QDBusMessage &message) {
+        const QVariantList arguments = message.arguments();
+
+        if ((arguments.size() < 2) || (arguments.first().toString() != interface)) {
+            return;
+        }
+
+        QMapIterator<QString, QVariant> iterator(propertyValues(arguments.at(1)));
+
+        while (iterator.hasNext()) {
+            iterator.next();
+            properties->insert(iterator.key(), iterator.value());
+
+            if (!pendingKey.isEmpty()) {
+                changedNames.insert(iterator.key());
+            }
+        }
+
+        // Invalidated properties are announced without their values, so they are cleared and fetched again
+        // with a new request, since a request that is already in flight may have been answered before the change
+        const QVariantList invalidated = arguments.size() > 2 ? propertyValue(arguments.at(2)).toList() : QVariantList();
+
+        if (!invalidated.isEmpty()) {
+            foreach (const QVariant &name, invalidated) {
+                properties->clear(name.toString());
+            }
+
+            getAll(false);
+        }
+    }
+
+    QchDBusPropertyCache *q_ptr;
+
+    QDeclarativePropertyMap *properties;
+
+    QchDBus::BusType bus;
+
+    QString interface;
+    QString path;
+    QString service;
+
+    QchDBus::BusType connectedBus;
+    QString connectedPath;
+    QString connectedService;
+
+    QchDBusMessage::Status status;
+
+    QString pendingKey;
+    QSet<QString> changedNames;
+
+    bool complete;
+
+    Q_DECLARE_PUBLIC(QchDBusPropertyCache)
+};
+
+/*!
+    \class DBusPropertyCache
+    \brief Keeps a local copy of the properties of a remote DBus object.
+    
+    \ingroup dbus
+    
+    The properties of the interface are retrieved with a single GetAll call on 
+    org.freedesktop.DBus.Properties, and are then kept up to date from the 
+    PropertiesChanged signal. Bindings to the values in \link properties\endlink 
+    are updated when the values change, without further DBus calls.
+    
+    \snippet dbus.qml DBusPropertyCache
+    
+    \sa DBusMessage, DBusConnections
+*/
+QchDBusPropertyCache::QchDBusPropertyCache(QObject *parent) :
+    QObject(parent),
+    d_ptr(new QchDBusPropertyCachePrivate(this))
+{
+}
+
+QchDBusPropertyCache::~QchDBusPropertyCache() {}
+
+/*!
+    \brief The bus on which the object is located.
+    
+    Possible values are:
+    
+    <table>
+        <tr>
+            <th>Value</th>
+            <th>Description</th>
+        </tr>
+        <tr>
+            <td>DBus.SessionBus</td>
+            <td>The object is located on the session bus (default).</td>
+        </tr>
+        <tr>
+            <td>DBus.SystemBus</td>
+            <td>The object is located on the system bus.</td>
+        </tr>
+    </table>
+*/
+QchDBus::BusType QchDBusPropertyCache::bus() const {
+    Q_D(const QchDBusPropertyCache);
+    return d->bus;
+}
+
+void QchDBusPropertyCache::setBus(QchDBus::BusType b) {
+    if (b != bus()) {
+        Q_D(QchDBusPropertyCache);
+        d->bus = b;
+        emit busChanged();
+        d->clear();
+        d->reload();
+    }
+}
+
+/*!
+    \brief The interface whose properties are cached.
+*/
+QString QchDBusPropertyCache::interfaceName() const {
+    Q_D(const QchDBusPropertyCache);
+    return d->interface;
+}
+
+void QchDBusPropertyCache::setInterfaceName(const QString &name) {
+    if (name != interfaceName()) {
+        Q_D(QchDBusPropertyCache);
+        d->interface = name;
+        emit interfaceNameChanged();
+        d->clear();
+        d->reload();
+    }
+}
+
+/*!
+    \brief The path of the object.
+*/
+QString QchDBusPropertyCache::path() const {
+    Q_D(const QchDBusPropertyCache);
+    return d->path;
+}
+
+void QchDBusPropertyCache::setPath(const QString &p) {
+    if (p != path()) {
+        Q_D(QchDBusPropertyCache);
+        d->path = p;
+        emit pathChanged();
+        d->clear();
+        d->reload();
+    }
+}
+
+/*!
+    \brief The cached property values.
+    
+    Properties whose names begin with an upper case letter are read using the 
+    subscript operator, e.g. \c properties["Percentage"].
+*/
+QObject* QchDBusPropertyCache::properties() const {
+    Q_D(const QchDBusPropertyCache);
+    return d->properties;
+}
+
+/*!
+    \brief The service on which the object is located.
+*/
+QString QchDBusPropertyCache::serviceName() const {
+    Q_D(const QchDBusPropertyCache);
+    return d->service;
+}
+
+void QchDBusPropertyCache::setServiceName(const QString &name) {
+    if (name != serviceName()) {
+        Q_D(QchDBusPropertyCache);
+        d->service = name;
+        emit serviceNameChanged();
+        d->clear();
+        d->reload();
+    }
+}
+
+/*!
+    \brief The current status of the cache.
+    
+    Possible values are:
+    
+    <table>
+        <tr>
+            <th>Value</th>
+            <th>Description</th>
+        </tr>
+        <tr>
+            <td>DBusMessage.Null</td>
+            <td>No properties have been requested (default).</td>
+        </tr>
+        <tr>
+            <td>DBusMessage.Loading</td>
+            <td>The properties are being retrieved.</td>
+        </tr>
+        <tr>
+            <td>DBusMessage.Ready</td>
+            <td>The properties were retrieved successfully.</td>
+        </tr>
+        <tr>
+            <td>DBusMessage.Error</td>
+            <td>An error occured when retrieving the properties.</td>
+        </tr>
+    </table>
+*/
+QchDBusMessage::Status QchDBusPropertyCache::status() const {
+    Q_D(const QchDBusPropertyCache);
+    return d->status;
+}
+
+/*!
+    \brief Retrieves all properties again.
+*/
+void QchDBusPropertyCache::reload() {
+    Q_D(QchDBusPropertyCache);
+    d->reload();
+}
+
+void QchDBusPropertyCache::classBegin() {}
+
+void QchDBusPropertyCache::componentComplete() {
+    Q_D(QchDBusPropertyCache);
+    d->complete = true;
+    d->reload();
+}
+
+#include "moc_qchdbuspropertycache.cpp"
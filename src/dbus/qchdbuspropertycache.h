@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2016 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QCHDBUSPROPERTYCACHE_H
+#define QCHDBUSPROPERTYCACHE_H
+
+#include "qchdbusmessage.h"
+#include <QObject>
+#include <QDeclarativeParserStatus>
+#include <qdeclarative.h>
+
+class QDBusMessage;
+class QchDBusPropertyCachePrivate;
+
+class QchDBusPropertyCache : public QObject, public QDeclarativeParserStatus
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QchDBus::BusType bus READ bus WRITE setBus NOTIFY busChanged)
+    Q_PROPERTY(QString interfaceName READ interfaceName WRITE setInterfaceName NOTIFY interfaceNameChanged)
+    Q_PROPERTY(QString path READ path WRITE setPath NOTIFY pathChanged)
+    Q_PROPERTY(QObject* properties READ properties CONSTANT)
+    Q_PROPERTY(QString serviceName READ serviceName WRITE setServiceName NOTIFY serviceNameChanged)
+    Q_PROPERTY(QchDBusMessage::Status status READ status NOTIFY statusChanged)
+
+    Q_INTERFACES(QDeclarativeParserStatus)
+
+public:
+    explicit QchDBusPropertyCache(QObject *parent = 0);
+    ~QchDBusPropertyCache();
+
+    QchDBus::BusType bus() const;
+    void setBus(QchDBus::BusType b);
+
+    QString interfaceName() const;
+    void setInterfaceName(const QString &name);
+
+    QString path() const;
+    void setPath(const QString &path);
+
+    QObject* properties() const;
+
+    QString serviceName() const;
+    void setServiceName(const QString &name);
+
+    QchDBusMessage::Status status() const;
+
+public Q_SLOTS:
+    void reload();
+
+Q_SIGNALS:
+    void busChanged();
+    void interfaceNameChanged();
+    void pathChanged();
+    void serviceNameChanged();
+    void statusChanged();
+
+protected:
+    virtual void classBegin();
+    virtual void componentComplete();
+
+    QScopedPointer<QchDBusPropertyCachePrivate> d_ptr;
+
+    Q_DECLARE_PRIVATE(QchDBusPropertyCache)
+
+    Q_PRIVATE_SLOT(d_func(), void _q_onGetAllFinished(QString,QDBusMessage))
+    Q_PRIVATE_SLOT(d_func(), void _q_onPropertiesChanged(QDBusMessage))
+
+private:
+    Q_DISABLE_COPY(QchDBusPropertyCache)
+};
+
+QML_DECLARE_TYPE(QchDBusPropertyCache)
+
+#endif // QCHDBUSPROPERTYCACHE_H
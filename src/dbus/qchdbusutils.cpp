@@ -15,11 +15,10 @@
  */
 
 #include "qchdbusutils.h"
-#include <QDBusInterface>
 #include <QDBusArgument>
 #include <QDBusMetaType>
-#include <QMetaMethod>
-#include <QMetaObject>
+#include <QCache>
+#include <QVector>
 
 template<typename T> static QList<T> toQList(const QVariantList &list) {
     QList<T> arr;
@@ -64,38 +63,52 @@ static void registerDBusTypes(void) {
     }
 }
 
-static void convertListArgument(QVariant &arg) {
-    QVariantList list = arg.toList();
-    
+// The element type recorded for a list whose elements do not share a type
+static const int MIXED_LIST = -1;
+
+// Returns the type shared by all elements of list, QVariant::Invalid if list is empty, or MIXED_LIST
+static int listElementType(const QVariantList &list) {
     if (list.isEmpty()) {
-        return;
+        return QVariant::Invalid;
     }
     
     const int type = list.at(0).type();
     
     for (int i = 1; i < list.size(); i++) {
         if (list.at(i).type() != type) {
-            arg = list;
-            return;
+            return MIXED_LIST;
         }
     }
     
-    switch (type) {
+    return type;
+}
+
+static void convertListArgument(QVariant &arg, int elementType) {
+    switch (elementType) {
+    case MIXED_LIST:
+        arg = arg.toList();
+        break;
     case QVariant::String:
-        arg = QVariant::fromValue(toQStringList(list));
+        arg = QVariant::fromValue(toQStringList(arg.toList()));
         break;
     case QVariant::Bool:
-        arg = QVariant::fromValue(toQList<bool>(list));
+        arg = QVariant::fromValue(toQList<bool>(arg.toList()));
         break;
     case QVariant::Int:
-        arg = QVariant::fromValue(toQList<int>(list));
+        arg = QVariant::fromValue(toQList<int>(arg.toList()));
         break;
     case QVariant::Double:
-        arg = QVariant::fromValue(toQList<double>(list));
+        arg = QVariant::fromValue(toQList<double>(arg.toList()));
+        break;
+    default:
         break;
     }
 }
 
+static void convertListArgument(QVariant &arg) {
+    convertListArgument(arg, listElementType(arg.toList()));
+}
+
 static void convertMapArgument(QVariant &arg) {
     QVariantMap map = arg.toMap();
     
@@ -117,136 +130,190 @@ static void convertMapArgument(QVariant &arg) {
     arg = map;
 }
 
-QVariantList QchDBusUtils::convertMethodCallArguments(const QDBusInterface &iface, const QString &methodName,
-                                                      const QVariantList &arguments) {
-    if (arguments.isEmpty()) {
-        return arguments;
-    }
+/*
+ * A marshalling plan holds the conversion of each argument for a method and argument types, so
+ * that the overload matching and type lookups are done once rather than on every call.
+ */
+struct ArgumentConversion {
+    enum Operation {
+        PassThrough,
+        ToUChar,
+        ToList,
+        ToMap,
+        ToType,
+        ToDBusVariant,
+        ToDBusObjectPath,
+        ToDBusSignature
+    };
     
-    registerDBusTypes();
+    Operation operation;
+    int type; // The target type for ToType
+};
+
+typedef QVector<ArgumentConversion> MarshallingPlan;
+
+// The maximum number of cached plans, the least recently used plan is discarded beyond this
+static const int MAX_PLANS = 256;
+
+static QCache<QByteArray, MarshallingPlan> plans(MAX_PLANS);
+
+// Returns the plan cache key for the method and the user type of each argument
+static QByteArray planKey(const QByteArray &methodsId, const QByteArray &methodName, const QVariantList &arguments) {
+    QByteArray key = methodsId;
+    key += '|';
+    key += methodName;
+    key += ':';
     
-    QList<int> knownIds;
-    bool matchFound = false;
-    QVariantList args = arguments;
-    QVariantList params;
-    const QMetaObject *mo = iface.metaObject();
-    QByteArray match = methodName.toLatin1();
-    match += '(';
+    foreach (const QVariant &arg, arguments) {
+        key += QByteArray::number(arg.userType());
+        key += ',';
+    }
     
-    for (int i = mo->methodOffset(); i < mo->methodCount(); i++) {
-        const QMetaMethod mm = mo->method(i);
-        const QByteArray signature = mm.signature();
-        
-        if (signature.startsWith(match)) {
-            knownIds << i;
+    return key;
+}
+
+static ArgumentConversion compileArgument(int id) {
+    ArgumentConversion conversion;
+    conversion.operation = ArgumentConversion::PassThrough;
+    conversion.type = id;
+    
+    if (id == int(QVariant::Invalid)) {
+        // No Qt type is known for the D-Bus signature, so the argument is passed unchanged
+    }
+    else if (id == int(QMetaType::UChar)) {
+        conversion.operation = ArgumentConversion::ToUChar;
+    }
+    else if (id < int(QMetaType::User)) {
+        if ((id == int(QVariant::List)) || (id == int(QVariant::StringList))) {
+            // The element type depends on the contents of the list, so it is found when converting
+            conversion.operation = ArgumentConversion::ToList;
+        }
+        else if (id == int(QVariant::Map)) {
+            conversion.operation = ArgumentConversion::ToMap;
+        }
+        else {
+            conversion.operation = ArgumentConversion::ToType;
         }
     }
-    
-    if (knownIds.isEmpty()) {
-        return args;
+    else if (id == qMetaTypeId<QDBusVariant>()) {
+        conversion.operation = ArgumentConversion::ToDBusVariant;
+    }
+    else if (id == qMetaTypeId<QDBusObjectPath>()) {
+        conversion.operation = ArgumentConversion::ToDBusObjectPath;
+    }
+    else if (id == qMetaTypeId<QDBusSignature>()) {
+        conversion.operation = ArgumentConversion::ToDBusSignature;
     }
     
-    while ((!matchFound) && (!knownIds.isEmpty())) {
-        args = arguments;
-        params.clear();
-        const QMetaMethod mm = mo->method(knownIds.takeFirst());
-        QList<QByteArray> types = mm.parameterTypes();
-        
-        for (int i = 0; i < types.size(); i++) {
-            if (types.at(i).endsWith('&')) {
-                while (types.size() > 1) {
-                    types.removeLast();
-                }
-                
-                break;
-            }
-        }
+    return conversion;
+}
+
+static MarshallingPlan compilePlan(QList<QList<int> > candidates, const QVariantList &arguments) {
+    MarshallingPlan plan;
+    bool matchFound = false;
+    
+    while ((!matchFound) && (!candidates.isEmpty())) {
+        const QList<int> types = candidates.takeFirst();
+        plan.clear();
         
-        for (int i = 0; (!args.isEmpty()) && (i < types.size()); i++) {
-            int id = QVariant::nameToType(types.at(i));
-            
-            if (id == QVariant::UserType) {
-                id = QMetaType::type(types.at(i));
-            }
-            
-            Q_ASSERT(id);
-            QVariant p = args.takeFirst();
-            
-            if (id == int(QMetaType::UChar)) {
-                p = qVariantFromValue<uchar>(p.toUInt());
-            }
-            else if (id < int(QMetaType::User)) {
-                if ((id == int(QVariant::List)) || (id == int(QVariant::StringList))) {
-                    convertListArgument(p);
-                }
-                else if (id == int(QVariant::Map)) {
-                    convertMapArgument(p);
-                }
-                else {
-                    p.convert(QVariant::Type(id));
-                }
-            }
-            else if (id == qMetaTypeId<QDBusVariant>()) {
-                QDBusVariant tmp(p);
-                p = qVariantFromValue(tmp);
-            }
-            else if (id == qMetaTypeId<QDBusObjectPath>()) {
-                QDBusObjectPath path(p.toString());
-                p = qVariantFromValue(path);
-            }
-            else if (id == qMetaTypeId<QDBusSignature>()) {
-                QDBusSignature sig(p.toString());
-                p = qVariantFromValue(sig);
-            }
-            
-            params << p;
+        for (int i = 0; (i < arguments.size()) && (i < types.size()); i++) {
+            plan << compileArgument(types.at(i));
         }
         
-        matchFound = (params.size() == types.size()) && (args.isEmpty());
+        matchFound = (types.size() == arguments.size());
     }
     
-    return params;       
+    return plan;
 }
 
-QList<QchDBusMethod> QchDBusUtils::getSignals(const QDBusInterface &iface) {
-    QList<QchDBusMethod> dbusSignals;
-    const QMetaObject *mo = iface.metaObject();
+static QVariantList runPlan(const MarshallingPlan &plan, const QVariantList &arguments) {
+    QVariantList params;
     
-    for (int i = mo->methodOffset(); i < mo->methodCount(); i++) {
-        const QMetaMethod mm = mo->method(i);
+    for (int i = 0; i < plan.size(); i++) {
+        const ArgumentConversion &conversion = plan.at(i);
+        QVariant p = arguments.at(i);
         
-        if (mm.methodType() == QMetaMethod::Signal) {
-            QList<QByteArray> paramNames;
-            const QByteArray methodSignature = QMetaObject::normalizedSignature(mm.signature());
-            const QByteArray methodName = methodSignature.left(methodSignature.indexOf('('));
-            const int paramCount = mm.parameterTypes().size();
-            
-            for (int i = 0; i < paramCount; i++) {
-                paramNames << "arg" + QByteArray::number(i + 1);
-            }
-            
-            dbusSignals << QchDBusMethod(methodName, paramNames);
+        switch (conversion.operation) {
+        case ArgumentConversion::ToUChar:
+            p = qVariantFromValue<uchar>(p.toUInt());
+            break;
+        case ArgumentConversion::ToList:
+            convertListArgument(p);
+            break;
+        case ArgumentConversion::ToMap:
+            convertMapArgument(p);
+            break;
+        case ArgumentConversion::ToType:
+            p.convert(QVariant::Type(conversion.type));
+            break;
+        case ArgumentConversion::ToDBusVariant:
+            p = qVariantFromValue(QDBusVariant(p));
+            break;
+        case ArgumentConversion::ToDBusObjectPath:
+            p = qVariantFromValue(QDBusObjectPath(p.toString()));
+            break;
+        case ArgumentConversion::ToDBusSignature:
+            p = qVariantFromValue(QDBusSignature(p.toString()));
+            break;
+        default:
+            break;
         }
+        
+        params << p;
     }
     
-    return dbusSignals;
+    return params;
 }
 
-QList<QByteArray> QchDBusUtils::getSignalNames(const QDBusInterface &iface) {
-    QList<QByteArray> names;
-    const QMetaObject *mo = iface.metaObject();
+/*
+ * Converts the arguments to the types of the first overload of methodName that accepts them. If
+ * methodsId identifies the methods, such as the id of QchDBusInterfaceInfo, the conversion is cached
+ * for the argument types.
+ */
+QVariantList QchDBusUtils::convertMethodCallArguments(const QList<QchDBusMethod> &methods, const QString &methodName,
+                                                      const QVariantList &arguments, const QByteArray &methodsId) {
+    if (arguments.isEmpty()) {
+        return arguments;
+    }
+    
+    registerDBusTypes();
     
-    for (int i = mo->methodOffset(); i < mo->methodCount(); i++) {
-        const QMetaMethod mm = mo->method(i);
+    const QByteArray match = methodName.toLatin1();
+    QByteArray key;
+    
+    if (!methodsId.isEmpty()) {
+        key = planKey(methodsId, match, arguments);
         
-        if (mm.methodType() == QMetaMethod::Signal) {
-            const QByteArray methodSignature = QMetaObject::normalizedSignature(mm.signature());
-            const QByteArray methodName = methodSignature.left(methodSignature.indexOf('('));
-            names << methodName;
+        if (const MarshallingPlan *plan = plans.object(key)) {
+            return runPlan(*plan, arguments);
         }
     }
     
-    return names;
+    QList<QList<int> > candidates;
+    
+    foreach (const QchDBusMethod &method, methods) {
+        if (method.methodName == match) {
+            candidates << method.parameterTypes;
+        }
+    }
+    
+    if (candidates.isEmpty()) {
+        return arguments;
+    }
+    
+    const MarshallingPlan plan = compilePlan(candidates, arguments);
+    
+    if (!key.isEmpty()) {
+        plans.insert(key, new MarshallingPlan(plan));
+    }
+    
+    return runPlan(plan, arguments);
+}
+
+int QchDBusUtils::signatureToType(const QString &signature) {
+    registerDBusTypes();
+    
+    return QDBusMetaType::signatureToType(signature.toLatin1());
 }
 
 QVariant QchDBusUtils::dbusArgumentToVariant(const QDBusArgument &argument) {
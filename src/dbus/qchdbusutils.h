@@ -20,12 +20,12 @@
 #include <QVariantList>
 #include <QMetaType>
 
-class QDBusInterface;
 class QDBusArgument;
 
 struct QchDBusMethod {
     QByteArray methodName;
     QList<QByteArray> parameterNames;
+    QList<int> parameterTypes;
     
     QchDBusMethod(const QByteArray &name, const QList<QByteArray> &params) :
         methodName(name),
@@ -38,11 +38,11 @@ class QchDBusUtils
 {
 
 public:
-    static QVariantList convertMethodCallArguments(const QDBusInterface &iface, const QString &methodName,
-                                                   const QVariantList &arguments);
+    static QVariantList convertMethodCallArguments(const QList<QchDBusMethod> &methods, const QString &methodName,
+                                                   const QVariantList &arguments,
+                                                   const QByteArray &methodsId = QByteArray());
     
-    static QList<QchDBusMethod> getSignals(const QDBusInterface &iface);
-    static QList<QByteArray> getSignalNames(const QDBusInterface &iface);
+    static int signatureToType(const QString &signature);
             
     static QVariant dbusArgumentToVariant(const QDBusArgument &argument);
 
@@ -15,14 +15,18 @@
  */
 
 #include "qchplugin.h"
+#include "qchdbusbatch.h"
 #include "qchdbusconnections.h"
 #include "qchdbusmessage.h"
+#include "qchdbuspropertycache.h"
 
 void QchPlugin::registerTypes(const char *uri) {
     Q_ASSERT(uri == QLatin1String("org.hildon.dbus"));
     
+    qmlRegisterType<QchDBusBatch>(uri, 1, 0, "DBusBatch");
     qmlRegisterType<QchDBusConnections>(uri, 1, 0, "DBusConnections");
     qmlRegisterType<QchDBusMessage>(uri, 1, 0, "DBusMessage");
+    qmlRegisterType<QchDBusPropertyCache>(uri, 1, 0, "DBusPropertyCache");
         
     qmlRegisterUncreatableType<QchDBus>(uri, 1, 0, "DBus", "");
 }
@@ -0,0 +1,37 @@
+# Loads QchNowPlayingModel from the simulated MAFW backend and reports load times,
+# model notifications and peak memory. Built with qmake CONFIG+=mafw_stub, see main.cpp.
+TEMPLATE = app
+TARGET = nowplayingbenchmark
+CONFIG += console mafw_stub
+CONFIG -= app_bundle
+
+QT += declarative dbus
+
+DEFINES += MAFW_WORKAROUNDS
+
+INCLUDEPATH += ..
+
+include(../mafw/stub/stub.pri)
+
+HEADERS += \
+    ../mafw/mafwrendereradapter.h \
+    ../mafw/mafwsourceadapter.h \
+    ../mafw/mafwplaylistadapter.h \
+    ../mafw/mafwplaylistmanageradapter.h \
+    ../mafw/mafwregistryadapter.h \
+    ../mediaobjectid.h \
+    ../metadatacache.h \
+    ../metadatawatcher.h \
+    ../playbackstatistics.h \
+    ../playlistquerymanager.h \
+    ../qchmediatype.h \
+    ../qchnowplayingmodel.h
+
+SOURCES += \
+    ../mediaobjectid.cpp \
+    ../metadatacache.cpp \
+    ../metadatawatcher.cpp \
+    ../playbackstatistics.cpp \
+    ../playlistquerymanager.cpp \
+    ../qchnowplayingmodel.cpp \
+    main.cpp
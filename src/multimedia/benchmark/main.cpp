@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2016 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures how QchNowPlayingModel loads the now playing playlist from the simulated MAFW backend.
+ *
+ * Usage: nowplayingbenchmark [--latency ms] [--item-latency us] [--timeout s] [size...]
+ *
+ * Every size (1000, 10000 and 50000 by default) is loaded twice in a fresh process, first with an
+ * empty metadata cache and then with the cache written by the first run, so that each pass starts
+ * from a clean heap. The processes share a temporary HOME, which is removed afterwards.
+ */
+
+#include "qchnowplayingmodel.h"
+#include "mafw/stub/mafwstub.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStringList>
+#include <QTextStream>
+#include <QTimer>
+#include <QVector>
+
+static const char *CACHE_DIR = ".cache/qchmultimedia";
+
+static int peakMemoryUsage()
+{
+    QFile file("/proc/self/status");
+
+    if (file.open(QFile::ReadOnly)) {
+        QByteArray line;
+
+        while (!(line = file.readLine()).isEmpty()) {
+            if (line.startsWith("VmHWM:"))
+                return line.mid(6).trimmed().split(' ').first().toInt();
+        }
+    }
+
+    return 0;
+}
+
+class Benchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    Benchmark(const QString &pass, int size) :
+        QObject(),
+        m_pass(pass),
+        m_size(size),
+        m_model(new QchNowPlayingModel(this)),
+        m_firstRows(-1),
+        m_insertNotifications(0),
+        m_dataNotifications(0),
+        m_remaining(0),
+        m_finished(false)
+    {
+        connect(m_model, SIGNAL(ready()), this, SLOT(onReady()));
+        connect(m_model, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(onRowsInserted(QModelIndex, int, int)));
+        connect(m_model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), this, SLOT(onDataChanged(QModelIndex, QModelIndex)));
+    }
+
+    void start()
+    {
+        static_cast<QDeclarativeParserStatus*>(m_model)->componentComplete();
+    }
+
+    bool isFinished() const
+    {
+        return m_finished;
+    }
+
+private Q_SLOTS:
+    void onReady()
+    {
+        disconnect(m_model, SIGNAL(ready()), this, SLOT(onReady()));
+        m_timer.start();
+        m_model->loadItems();
+    }
+
+    void onRowsInserted(const QModelIndex &, int first, int last)
+    {
+        if (m_firstRows < 0)
+            m_firstRows = m_timer.elapsed();
+
+        m_insertNotifications++;
+        m_loaded.insert(first, last - first + 1, false);
+
+        // Rows found in the metadata cache are populated before they are inserted
+        for (int i = first; i <= last; i++) {
+            if (!m_model->data(m_model->index(i), QchNowPlayingModel::UrlRole).toString().isEmpty()) {
+                m_loaded[i] = true;
+            } else {
+                m_remaining++;
+            }
+        }
+
+        checkFinished();
+    }
+
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+    {
+        m_dataNotifications++;
+
+        for (int i = topLeft.row(); i <= bottomRight.row() && i < m_loaded.size(); i++) {
+            if (!m_loaded.at(i)) {
+                m_loaded[i] = true;
+                m_remaining--;
+            }
+        }
+
+        checkFinished();
+    }
+
+private:
+    void checkFinished()
+    {
+        if (m_finished || m_remaining > 0 || m_loaded.size() < m_size)
+            return;
+
+        m_finished = true;
+
+        QTextStream(stdout) << QString("%1 %2 rows: first rows after %3 ms, all rows after %4 ms, %5 rowsInserted, %6 dataChanged, peak memory %7 kB\n")
+                               .arg(m_pass, -4).arg(m_size, 6).arg(m_firstRows, 6).arg(m_timer.elapsed(), 6)
+                               .arg(m_insertNotifications).arg(m_dataNotifications, 6).arg(peakMemoryUsage());
+
+        // The model writes the metadata cache for the warm pass when it is deleted with the benchmark
+        QCoreApplication::exit(0);
+    }
+
+    QString m_pass;
+    int m_size;
+    QchNowPlayingModel *m_model;
+    QElapsedTimer m_timer;
+    qint64 m_firstRows;
+    int m_insertNotifications;
+    int m_dataNotifications;
+    QVector<bool> m_loaded;
+    int m_remaining;
+    bool m_finished;
+};
+
+static void removeHome(const QString &home)
+{
+    QDir dir(home);
+    dir.remove(QString(CACHE_DIR) + "/playlistmetadata");
+    dir.rmpath(CACHE_DIR);
+    QDir().rmdir(home);
+}
+
+static int runChild(const QStringList &args, int latency, int itemLatency, int timeout)
+{
+    const QString pass = args.value(0);
+    const int size = args.value(1).toInt();
+
+    MafwStub::setPlaylistSize(size);
+    MafwStub::setLatency(latency);
+    MafwStub::setItemLatency(itemLatency);
+
+    Benchmark benchmark(pass, size);
+    benchmark.start();
+
+    QTimer::singleShot(timeout * 1000, QCoreApplication::instance(), SLOT(quit()));
+
+    if (QCoreApplication::exec() != 0 || !benchmark.isFinished()) {
+        QTextStream(stderr) << pass << " " << size << " rows: timed out after " << timeout << " s\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments().mid(1);
+    QStringList options;
+    QList<int> sizes;
+    QStringList child;
+    int latency = MafwStub::latency();
+    int itemLatency = MafwStub::itemLatency();
+    int timeout = 300;
+
+    while (!args.isEmpty()) {
+        const QString arg = args.takeFirst();
+
+        if (arg == "--latency" && !args.isEmpty()) {
+            latency = args.first().toInt();
+            options << arg << args.takeFirst();
+        } else if (arg == "--item-latency" && !args.isEmpty()) {
+            itemLatency = args.first().toInt();
+            options << arg << args.takeFirst();
+        } else if (arg == "--timeout" && !args.isEmpty()) {
+            timeout = args.first().toInt();
+            options << arg << args.takeFirst();
+        } else if (arg == "--run" && args.size() >= 2) {
+            child << args.takeFirst() << args.takeFirst();
+        } else if (arg.toInt() > 0) {
+            sizes << arg.toInt();
+        } else {
+            QTextStream(stderr) << "Usage: " << QFileInfo(app.applicationFilePath()).fileName()
+                                << " [--latency ms] [--item-latency us] [--timeout s] [size...]\n";
+            return 1;
+        }
+    }
+
+    if (!child.isEmpty())
+        return runChild(child, latency, itemLatency, timeout);
+
+    if (sizes.isEmpty())
+        sizes << 1000 << 10000 << 50000;
+
+    QTextStream(stdout) << "Request latency " << latency << " ms, " << itemLatency << " us per item\n";
+
+    int result = 0;
+
+    foreach (int size, sizes) {
+        const QString home = QDir::tempPath() + QString("/nowplayingbenchmark-%1-%2")
+                             .arg(QCoreApplication::applicationPid()).arg(size);
+        QDir().mkpath(home);
+
+        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+        env.insert("HOME", home);
+
+        foreach (const QString &pass, QStringList() << "cold" << "warm") {
+            QProcess process;
+            process.setProcessEnvironment(env);
+            process.setProcessChannelMode(QProcess::ForwardedChannels);
+            process.start(app.applicationFilePath(), QStringList(options) << "--run" << pass << QString::number(size));
+
+            if (!process.waitForFinished(-1) || process.exitCode() != 0) {
+                result = 1;
+                break;
+            }
+        }
+
+        removeHome(home);
+    }
+
+    return result;
+}
+
+#include "main.moc"
@@ -145,6 +145,14 @@ void MafwPlaylistAdapter::appendItems(MafwPlaylist *playlist, const gchar** oid)
         mafw_playlist_append_items (playlist, oid, &error);
 }
 
+// MAFW has no bulk insert, so the items are inserted one by one
+void MafwPlaylistAdapter::insertItems(const gchar** oid, guint index)
+{
+    if(mafw_playlist)
+        for (int i = 0; oid[i] != NULL; i++)
+            mafw_playlist_insert_item (this->mafw_playlist, index + i, oid[i], &error);
+}
+
 void MafwPlaylistAdapter::moveItem(int from, int to)
 {
 #ifdef DEBUG_MAFW
@@ -181,7 +189,7 @@ gpointer MafwPlaylistAdapter::getAllItems()
     return this->getItems(0, -1);
 }
 
-gpointer MafwPlaylistAdapter::getItems(int from, int to)
+gpointer MafwPlaylistAdapter::getItems(int from, int to, const gchar* const *keys)
 {
 #ifdef DEBUG_MAFW
     qDebug() << "MafwPlaylistAdapter::getItems";
@@ -193,36 +201,36 @@ gpointer MafwPlaylistAdapter::getItems(int from, int to)
         pl->op = mafw_playlist_get_items_md (this->mafw_playlist,
                                              from,
                                              to,
-                                             MAFW_SOURCE_LIST(MAFW_METADATA_KEY_URI,
-                                                              MAFW_METADATA_KEY_TITLE,
-                                                              MAFW_METADATA_KEY_DURATION,
-                                                              MAFW_METADATA_KEY_ARTIST,
-                                                              MAFW_METADATA_KEY_ALBUM,
-                                                              MAFW_METADATA_KEY_GENRE,
-                                                              MAFW_METADATA_KEY_TRACK,
-                                                              MAFW_METADATA_KEY_YEAR,
-                                                              MAFW_METADATA_KEY_PLAY_COUNT,
-                                                              MAFW_METADATA_KEY_LAST_PLAYED,
-                                                              MAFW_METADATA_KEY_DESCRIPTION,
-                                                              MAFW_METADATA_KEY_MODIFIED,
-                                                              MAFW_METADATA_KEY_PAUSED_POSITION,
-                                                              MAFW_METADATA_KEY_PAUSED_THUMBNAIL_URI,
-                                                              MAFW_METADATA_KEY_IS_SEEKABLE,
-                                                              MAFW_METADATA_KEY_RES_X,
-                                                              MAFW_METADATA_KEY_RES_Y,
-                                                              MAFW_METADATA_KEY_COMMENT,
-                                                              MAFW_METADATA_KEY_TAGS,
-                                                              MAFW_METADATA_KEY_LYRICS,
-                                                              MAFW_METADATA_KEY_COMPOSER,
-                                                              MAFW_METADATA_KEY_FILESIZE,
-                                                              MAFW_METADATA_KEY_COPYRIGHT,
-                                                              MAFW_METADATA_KEY_ORGANIZATION,
-                                                              MAFW_METADATA_KEY_AUDIO_BITRATE,
-                                                              MAFW_METADATA_KEY_AUDIO_CODEC,
-                                                              MAFW_METADATA_KEY_ALBUM_ART_URI,
-                                                              MAFW_METADATA_KEY_VIDEO_BITRATE,
-                                                              MAFW_METADATA_KEY_VIDEO_CODEC,
-                                                              MAFW_METADATA_KEY_VIDEO_FRAMERATE),
+                                             keys ? keys : MAFW_SOURCE_LIST(MAFW_METADATA_KEY_URI,
+                                                                            MAFW_METADATA_KEY_TITLE,
+                                                                            MAFW_METADATA_KEY_DURATION,
+                                                                            MAFW_METADATA_KEY_ARTIST,
+                                                                            MAFW_METADATA_KEY_ALBUM,
+                                                                            MAFW_METADATA_KEY_GENRE,
+                                                                            MAFW_METADATA_KEY_TRACK,
+                                                                            MAFW_METADATA_KEY_YEAR,
+                                                                            MAFW_METADATA_KEY_PLAY_COUNT,
+                                                                            MAFW_METADATA_KEY_LAST_PLAYED,
+                                                                            MAFW_METADATA_KEY_DESCRIPTION,
+                                                                            MAFW_METADATA_KEY_MODIFIED,
+                                                                            MAFW_METADATA_KEY_PAUSED_POSITION,
+                                                                            MAFW_METADATA_KEY_PAUSED_THUMBNAIL_URI,
+                                                                            MAFW_METADATA_KEY_IS_SEEKABLE,
+                                                                            MAFW_METADATA_KEY_RES_X,
+                                                                            MAFW_METADATA_KEY_RES_Y,
+                                                                            MAFW_METADATA_KEY_COMMENT,
+                                                                            MAFW_METADATA_KEY_TAGS,
+                                                                            MAFW_METADATA_KEY_LYRICS,
+                                                                            MAFW_METADATA_KEY_COMPOSER,
+                                                                            MAFW_METADATA_KEY_FILESIZE,
+                                                                            MAFW_METADATA_KEY_COPYRIGHT,
+                                                                            MAFW_METADATA_KEY_ORGANIZATION,
+                                                                            MAFW_METADATA_KEY_AUDIO_BITRATE,
+                                                                            MAFW_METADATA_KEY_AUDIO_CODEC,
+                                                                            MAFW_METADATA_KEY_ALBUM_ART_URI,
+                                                                            MAFW_METADATA_KEY_VIDEO_BITRATE,
+                                                                            MAFW_METADATA_KEY_VIDEO_CODEC,
+                                                                            MAFW_METADATA_KEY_VIDEO_FRAMERATE),
                                              MafwPlaylistAdapter::get_items_cb,
                                              pl, get_items_free_cbarg);
         return pl->op;
@@ -274,43 +282,43 @@ gpointer MafwPlaylistAdapter::getItemsOf(MafwPlaylist *playlist)
     return pl->op;
 }
 
-gpointer MafwPlaylistAdapter::getItemsOf(MafwPlaylist *playlist, int from, int to)
+gpointer MafwPlaylistAdapter::getItemsOf(MafwPlaylist *playlist, int from, int to, const gchar* const *keys)
 {
     get_items_cb_payload* pl = new get_items_cb_payload;
     pl->adapter = this;
     pl->op = mafw_playlist_get_items_md (playlist,
                                          from,
                                          to,
-                                         MAFW_SOURCE_LIST(MAFW_METADATA_KEY_URI,
-                                                          MAFW_METADATA_KEY_TITLE,
-                                                          MAFW_METADATA_KEY_DURATION,
-                                                          MAFW_METADATA_KEY_ARTIST,
-                                                          MAFW_METADATA_KEY_ALBUM,
-                                                          MAFW_METADATA_KEY_GENRE,
-                                                          MAFW_METADATA_KEY_TRACK,
-                                                          MAFW_METADATA_KEY_YEAR,
-                                                          MAFW_METADATA_KEY_PLAY_COUNT,
-                                                          MAFW_METADATA_KEY_LAST_PLAYED,
-                                                          MAFW_METADATA_KEY_DESCRIPTION,
-                                                          MAFW_METADATA_KEY_MODIFIED,
-                                                          MAFW_METADATA_KEY_PAUSED_POSITION,
-                                                          MAFW_METADATA_KEY_PAUSED_THUMBNAIL_URI,
-                                                          MAFW_METADATA_KEY_IS_SEEKABLE,
-                                                          MAFW_METADATA_KEY_RES_X,
-                                                          MAFW_METADATA_KEY_RES_Y,
-                                                          MAFW_METADATA_KEY_COMMENT,
-                                                          MAFW_METADATA_KEY_TAGS,
-                                                          MAFW_METADATA_KEY_LYRICS,
-                                                          MAFW_METADATA_KEY_COMPOSER,
-                                                          MAFW_METADATA_KEY_FILESIZE,
-                                                          MAFW_METADATA_KEY_COPYRIGHT,
-                                                          MAFW_METADATA_KEY_ORGANIZATION,
-                                                          MAFW_METADATA_KEY_AUDIO_BITRATE,
-                                                          MAFW_METADATA_KEY_AUDIO_CODEC,
-                                                          MAFW_METADATA_KEY_ALBUM_ART_URI,
-                                                          MAFW_METADATA_KEY_VIDEO_BITRATE,
-                                                          MAFW_METADATA_KEY_VIDEO_CODEC,
-                                                          MAFW_METADATA_KEY_VIDEO_FRAMERATE),
+                                         keys ? keys : MAFW_SOURCE_LIST(MAFW_METADATA_KEY_URI,
+                                                                        MAFW_METADATA_KEY_TITLE,
+                                                                        MAFW_METADATA_KEY_DURATION,
+                                                                        MAFW_METADATA_KEY_ARTIST,
+                                                                        MAFW_METADATA_KEY_ALBUM,
+                                                                        MAFW_METADATA_KEY_GENRE,
+                                                                        MAFW_METADATA_KEY_TRACK,
+                                                                        MAFW_METADATA_KEY_YEAR,
+                                                                        MAFW_METADATA_KEY_PLAY_COUNT,
+                                                                        MAFW_METADATA_KEY_LAST_PLAYED,
+                                                                        MAFW_METADATA_KEY_DESCRIPTION,
+                                                                        MAFW_METADATA_KEY_MODIFIED,
+                                                                        MAFW_METADATA_KEY_PAUSED_POSITION,
+                                                                        MAFW_METADATA_KEY_PAUSED_THUMBNAIL_URI,
+                                                                        MAFW_METADATA_KEY_IS_SEEKABLE,
+                                                                        MAFW_METADATA_KEY_RES_X,
+                                                                        MAFW_METADATA_KEY_RES_Y,
+                                                                        MAFW_METADATA_KEY_COMMENT,
+                                                                        MAFW_METADATA_KEY_TAGS,
+                                                                        MAFW_METADATA_KEY_LYRICS,
+                                                                        MAFW_METADATA_KEY_COMPOSER,
+                                                                        MAFW_METADATA_KEY_FILESIZE,
+                                                                        MAFW_METADATA_KEY_COPYRIGHT,
+                                                                        MAFW_METADATA_KEY_ORGANIZATION,
+                                                                        MAFW_METADATA_KEY_AUDIO_BITRATE,
+                                                                        MAFW_METADATA_KEY_AUDIO_CODEC,
+                                                                        MAFW_METADATA_KEY_ALBUM_ART_URI,
+                                                                        MAFW_METADATA_KEY_VIDEO_BITRATE,
+                                                                        MAFW_METADATA_KEY_VIDEO_CODEC,
+                                                                        MAFW_METADATA_KEY_VIDEO_FRAMERATE),
                                          MafwPlaylistAdapter::get_items_cb,
                                          pl, get_items_free_cbarg);
     return pl->op;
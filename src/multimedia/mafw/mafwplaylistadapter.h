@@ -28,14 +28,15 @@ public:
     void appendItem(MafwPlaylist *playlist, QString objectId);
     void appendItems(const gchar** oid);
     void appendItems(MafwPlaylist *playlist, const gchar** oid);
+    void insertItems(const gchar** oid, guint index);
     void moveItem(int from, int to);
     void removeItem(int index);
     void duplicatePlaylist(QString newName);
     int getSize();
     int getSizeOf(MafwPlaylist *playlist);
     gpointer getItemsOf(MafwPlaylist *playlist);
-    gpointer getItemsOf(MafwPlaylist *playlist, int from, int to);
-    gpointer getItems(int from, int to);
+    gpointer getItemsOf(MafwPlaylist *playlist, int from, int to, const gchar* const *keys = 0);
+    gpointer getItems(int from, int to, const gchar* const *keys = 0);
     gpointer getAllItems();
     QString playlistName();
     MafwPlaylist *mafw_playlist;
@@ -18,6 +18,8 @@
 
 #include "mafwrendereradapter.h"
 
+#include "../playbackstatistics.h"
+
 MafwRendererAdapter::MafwRendererAdapter()
 {
     this->mafw_renderer = NULL;
@@ -221,6 +223,8 @@ void MafwRendererAdapter::onBufferingInfo(MafwRenderer*,
                                           gfloat status,
                                           gpointer user_data)
 {
+    PlaybackStatistics::countRendererSignal("bufferingInfo");
+
 #ifdef DEBUG_MAFW
     qDebug() << "On buffering info";
 #endif
@@ -232,6 +236,8 @@ void MafwRendererAdapter::onMediaChanged(MafwRenderer*,
                                          gchar* object_id,
                                          gpointer user_data)
 {
+    PlaybackStatistics::countRendererSignal("mediaChanged");
+
 #ifdef DEBUG_MAFW
     qDebug() << "On media changed";
 #endif
@@ -243,6 +249,8 @@ void MafwRendererAdapter::onMetadataChanged(MafwRenderer*,
                                             GValueArray* value,
                                             gpointer user_data)
 {
+    PlaybackStatistics::countRendererSignal("metadataChanged");
+
 #ifdef DEBUG_MAFW
     qDebug() << "On Metadata Changed" << name;
 #endif
@@ -303,6 +311,8 @@ void MafwRendererAdapter::onPlaylistChanged(MafwRenderer*,
                                             GObject* playlist,
                                             gpointer user_data)
 {
+    PlaybackStatistics::countRendererSignal("playlistChanged");
+
 #ifdef DEBUG_MAFW
     qDebug() << "On playlist changed";
 #endif
@@ -313,6 +323,8 @@ void MafwRendererAdapter::onStateChanged(MafwRenderer*,
                                          gint state,
                                          gpointer user_data)
 {
+    PlaybackStatistics::countRendererSignal("stateChanged");
+
     MafwRendererAdapter *adapter = static_cast<MafwRendererAdapter*>(user_data);
 
 #ifdef DEBUG_MAFW
@@ -335,6 +347,8 @@ void MafwRendererAdapter::onStateChanged(MafwRenderer*,
 
 void MafwRendererAdapter::play()
 {
+    PlaybackStatistics::countRendererCall("play");
+
 #ifdef MAFW_WORKAROUNDS
     // Early play() or gotoIndex() seems be reliable only for smaller libraries.
     // For bigger ones something probably doesn't have enough time to ready up.
@@ -362,6 +376,8 @@ void MafwRendererAdapter::play()
 
 void MafwRendererAdapter::playObject(const gchar* object_id)
 {
+    PlaybackStatistics::countRendererCall("playObject");
+
 #ifdef LIBPLAYBACK_FULL
     if (mafw_renderer) {
         req_state_cb_payload *pl = new req_state_cb_payload;
@@ -380,6 +396,8 @@ void MafwRendererAdapter::playObject(const gchar* object_id)
 
 void MafwRendererAdapter::playURI(const gchar* uri)
 {
+    PlaybackStatistics::countRendererCall("playURI");
+
 #ifdef LIBPLAYBACK_FULL
     if (mafw_renderer) {
         req_state_cb_payload *pl = new req_state_cb_payload;
@@ -398,6 +416,8 @@ void MafwRendererAdapter::playURI(const gchar* uri)
 
 void MafwRendererAdapter::stop()
 {
+    PlaybackStatistics::countRendererCall("stop");
+
 #ifdef LIBPLAYBACK_FULL
     if (playback) {
         req_state_cb_payload *pl = new req_state_cb_payload;
@@ -416,6 +436,8 @@ void MafwRendererAdapter::stop()
 
 void MafwRendererAdapter::pause()
 {
+    PlaybackStatistics::countRendererCall("pause");
+
 #ifdef LIBPLAYBACK_FULL
     if (playback) {
         req_state_cb_payload *pl = new req_state_cb_payload;
@@ -434,6 +456,8 @@ void MafwRendererAdapter::pause()
 
 void MafwRendererAdapter::resume()
 {
+    PlaybackStatistics::countRendererCall("resume");
+
 #ifdef LIBPLAYBACK_FULL
     if (playback) {
         req_state_cb_payload *pl = new req_state_cb_payload;
@@ -452,6 +476,8 @@ void MafwRendererAdapter::resume()
 
 void MafwRendererAdapter::getStatus()
 {
+    PlaybackStatistics::countRendererCall("getStatus");
+
     if(mafw_renderer)
     {
         mafw_renderer_get_status(mafw_renderer, MafwRendererSignalHelper::get_status_cb, this);
@@ -460,6 +486,8 @@ void MafwRendererAdapter::getStatus()
 
 void MafwRendererAdapter::next()
 {
+    PlaybackStatistics::countRendererCall("next");
+
     if(mafw_renderer)
     {
         mafw_renderer_next(mafw_renderer, MafwRendererSignalHelper::next_playback_cb, this);
@@ -468,6 +496,8 @@ void MafwRendererAdapter::next()
 
 void MafwRendererAdapter::previous()
 {
+    PlaybackStatistics::countRendererCall("previous");
+
     if(mafw_renderer)
     {
         mafw_renderer_previous(mafw_renderer, MafwRendererSignalHelper::previous_playback_cb, this);
@@ -476,6 +506,8 @@ void MafwRendererAdapter::previous()
 
 void MafwRendererAdapter::gotoIndex(uint index)
 {
+    PlaybackStatistics::countRendererCall("gotoIndex");
+
 #ifdef MAFW_WORKAROUNDS
     // Explained in play()
     playlist->getSize();
@@ -490,6 +522,8 @@ void MafwRendererAdapter::gotoIndex(uint index)
 void MafwRendererAdapter::setPosition(MafwRendererSeekMode seekmode,
                                       int seconds)
 {
+    PlaybackStatistics::countRendererCall("setPosition");
+
     if(mafw_renderer)
     {
         mafw_renderer_set_position(mafw_renderer, seekmode, seconds, MafwRendererSignalHelper::set_position_cb, this);
@@ -498,6 +532,8 @@ void MafwRendererAdapter::setPosition(MafwRendererSeekMode seekmode,
 
 void MafwRendererAdapter::getPosition()
 {
+    PlaybackStatistics::countRendererCall("getPosition");
+
     if(mafw_renderer)
     {
         mafw_renderer_get_position(mafw_renderer, MafwRendererSignalHelper::get_position_cb, this);
@@ -506,6 +542,8 @@ void MafwRendererAdapter::getPosition()
 
 void MafwRendererAdapter::getCurrentMetadata()
 {
+    PlaybackStatistics::countRendererCall("getCurrentMetadata");
+
     if(mafw_renderer)
     {
         mafw_renderer_get_current_metadata(mafw_renderer, MafwRendererSignalHelper::get_current_metadata_cb, this);
@@ -514,6 +552,8 @@ void MafwRendererAdapter::getCurrentMetadata()
 
 bool MafwRendererAdapter::assignPlaylist(MafwPlaylist* playlist)
 {
+    PlaybackStatistics::countRendererCall("assignPlaylist");
+
     if(mafw_renderer)
     {
         return mafw_renderer_assign_playlist(mafw_renderer, playlist, NULL);
@@ -531,6 +571,8 @@ bool MafwRendererAdapter::isRendererReady()
 
 void MafwRendererAdapter::setVolume(int volume)
 {
+    PlaybackStatistics::countRendererCall("setVolume");
+
     if(mafw_renderer)
     {
         g_value_set_uint (&GVolume, volume);
@@ -540,6 +582,8 @@ void MafwRendererAdapter::setVolume(int volume)
 
 void MafwRendererAdapter::getVolume()
 {
+    PlaybackStatistics::countRendererCall("getVolume");
+
     if(mafw_renderer)
     {
 #ifdef DEBUG_MAFW
@@ -552,6 +596,8 @@ void MafwRendererAdapter::getVolume()
 
 void MafwRendererAdapter::setWindowXid(uint Xid)
 {
+    PlaybackStatistics::countRendererCall("setWindowXid");
+
     if(mafw_renderer)
     {
         mafw_extension_set_property_uint(MAFW_EXTENSION(this->mafw_renderer), MAFW_PROPERTY_RENDERER_XID, Xid);
@@ -560,6 +606,8 @@ void MafwRendererAdapter::setWindowXid(uint Xid)
 
 void MafwRendererAdapter::setColorKey(int colorKey)
 {
+    PlaybackStatistics::countRendererCall("setColorKey");
+
     if(mafw_renderer)
     {
         // MAFW API docs state that this is a read-only property
@@ -571,6 +619,8 @@ void MafwRendererAdapter::setColorKey(int colorKey)
 
 void MafwRendererAdapter::setErrorPolicy(uint errorPolicy)
 {
+    PlaybackStatistics::countRendererCall("setErrorPolicy");
+
     if (mafw_renderer)
         mafw_extension_set_property_uint(MAFW_EXTENSION(mafw_renderer), MAFW_PROPERTY_RENDERER_ERROR_POLICY, errorPolicy);
 }
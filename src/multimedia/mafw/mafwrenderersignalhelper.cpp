@@ -18,6 +18,8 @@
 
 #include "mafwrenderersignalhelper.h"
 
+#include "../playbackstatistics.h"
+
 #ifdef MAFW_WORKAROUNDS
 int MafwRendererSignalHelper::play_retries = 0;
 #endif
@@ -26,6 +28,8 @@ void MafwRendererSignalHelper::play_playback_cb(MafwRenderer*,
                                                 gpointer user_data,
                                                 const GError* error)
 {
+    PlaybackStatistics::countRendererSignal("signalPlay");
+
     QString qerror;
 #ifdef LIBPLAYBACK_FULL
     if(error)
@@ -76,6 +80,8 @@ void MafwRendererSignalHelper::play_uri_playback_cb(MafwRenderer*,
                                                     gpointer user_data,
                                                     const GError* error)
 {
+    PlaybackStatistics::countRendererSignal("signalPlayURI");
+
     QString qerror;
 #ifdef LIBPLAYBACK_FULL
     if(error)
@@ -104,6 +110,8 @@ void MafwRendererSignalHelper::play_object_playback_cb(MafwRenderer*,
                                                        gpointer user_data,
                                                        const GError* error)
 {
+    PlaybackStatistics::countRendererSignal("signalPlayObject");
+
     QString qerror;
 #ifdef LIBPLAYBACK_FULL
     if(error)
@@ -132,6 +140,8 @@ void MafwRendererSignalHelper::stop_playback_cb(MafwRenderer*,
                                                 gpointer user_data,
                                                 const GError* error)
 {
+    PlaybackStatistics::countRendererSignal("signalStop");
+
     QString qerror;
     if(error)
     {
@@ -146,6 +156,8 @@ void MafwRendererSignalHelper::pause_playback_cb(MafwRenderer*,
                                                  gpointer user_data,
                                                  const GError* error)
 {
+    PlaybackStatistics::countRendererSignal("signalPause");
+
     QString qerror;
     if(error)
     {
@@ -160,6 +172,8 @@ void MafwRendererSignalHelper::resume_playback_cb(MafwRenderer*,
                                                   gpointer user_data,
                                                   const GError* error)
 {
+    PlaybackStatistics::countRendererSignal("signalResume");
+
     QString qerror;
 #ifdef LIBPLAYBACK_FULL
     if(error)
@@ -192,6 +206,8 @@ void MafwRendererSignalHelper::get_status_cb(MafwRenderer*,
                                              gpointer user_data,
                                              const GError* error)
 {
+    PlaybackStatistics::countRendererSignal("signalGetStatus");
+
     QString qerror;
     if(error)
     {
@@ -204,6 +220,8 @@ void MafwRendererSignalHelper::next_playback_cb(MafwRenderer*,
                                                 gpointer user_data,
                                                 const GError* error)
 {
+    PlaybackStatistics::countRendererSignal("signalNext");
+
     QString qerror;
     if(error)
     {
@@ -216,6 +234,8 @@ void MafwRendererSignalHelper::previous_playback_cb(MafwRenderer*,
                                                     gpointer user_data,
                                                     const GError* error)
 {
+    PlaybackStatistics::countRendererSignal("signalPrevious");
+
     QString qerror;
     if(error)
     {
@@ -228,6 +248,8 @@ void MafwRendererSignalHelper::goto_index_playback_cb(MafwRenderer*,
                                                       gpointer user_data,
                                                       const GError* error)
 {
+    PlaybackStatistics::countRendererSignal("signalGotoIndex");
+
     QString qerror;
     if(error)
     {
@@ -241,6 +263,8 @@ void MafwRendererSignalHelper::set_position_cb(MafwRenderer*,
                                                gpointer user_data,
                                                const GError* error)
 {
+    PlaybackStatistics::countRendererSignal("signalSetPosition");
+
     QString qerror;
     if(error)
     {
@@ -256,6 +280,8 @@ void MafwRendererSignalHelper::get_position_cb(MafwRenderer*,
                                                gpointer user_data,
                                                const GError* error)
 {
+    PlaybackStatistics::countRendererSignal("signalGetPosition");
+
     QString qerror;
     if(error)
     {
@@ -272,6 +298,8 @@ void MafwRendererSignalHelper::get_current_metadata_cb(MafwRenderer*,
                                                        gpointer user_data,
                                                        const GError* error)
 {
+    PlaybackStatistics::countRendererSignal("signalGetCurrentMetadata");
+
     QString qerror;
     if(error)
     {
@@ -288,6 +316,8 @@ void MafwRendererSignalHelper::get_property_cb(MafwExtension *,
                                                gpointer user_data,
                                                const GError *error)
 {
+    PlaybackStatistics::countRendererSignal("signalGetVolume");
+
     QString qerror;
     if(error)
     {
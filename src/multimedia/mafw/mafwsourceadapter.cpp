@@ -114,9 +114,10 @@ void MafwSourceAdapter::onSourceRemoved(MafwSource *source)
 uint MafwSourceAdapter::browse(const QString &objectId, bool recursive, const char *filterString, const char *sortCriteria, const char *const *metadataKeys, uint skipCount, uint itemCount)
 {
     if (source) {
-        MafwFilter *filter = mafw_filter_parse(filterString);
+        MafwFilter *filter = filterString ? mafw_filter_parse(filterString) : NULL;
         uint browseId = mafw_source_browse(source, objectId.toUtf8(), recursive, filter, sortCriteria, metadataKeys, skipCount, itemCount, &onBrowseResult, this);
-        mafw_filter_free(filter);
+        if (filter)
+            mafw_filter_free(filter);
 
         return browseId;
     } else {
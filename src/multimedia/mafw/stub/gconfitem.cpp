@@ -0,0 +1,79 @@
+#include "gconfitem.h"
+#include <QHash>
+#include <QSet>
+
+static QHash<QString, QVariant> values;
+static QMultiHash<QString, GConfItem*> items;
+
+GConfItem::GConfItem(const QString &key, QObject *parent) :
+    QObject(parent),
+    m_key(key)
+{
+    items.insert(key, this);
+}
+
+GConfItem::~GConfItem()
+{
+    items.remove(m_key, this);
+}
+
+QString GConfItem::key() const
+{
+    return m_key;
+}
+
+QVariant GConfItem::value() const
+{
+    return values.value(m_key);
+}
+
+QVariant GConfItem::value(const QVariant &def) const
+{
+    return values.value(m_key, def);
+}
+
+void GConfItem::set(const QVariant &val)
+{
+    if (values.value(m_key) == val)
+        return;
+
+    if (val.isValid())
+        values.insert(m_key, val);
+    else
+        values.remove(m_key);
+
+    foreach (GConfItem *item, items.values(m_key))
+        emit item->valueChanged();
+}
+
+void GConfItem::unset()
+{
+    set(QVariant());
+}
+
+QList<QString> GConfItem::listDirs() const
+{
+    const QString prefix = m_key + "/";
+    QSet<QString> dirs;
+
+    foreach (const QString &key, values.keys()) {
+        const int slash = key.indexOf('/', prefix.size());
+
+        if (key.startsWith(prefix) && slash != -1)
+            dirs.insert(key.left(slash));
+    }
+
+    return dirs.toList();
+}
+
+QList<QString> GConfItem::listEntries() const
+{
+    const QString prefix = m_key + "/";
+    QList<QString> entries;
+
+    foreach (const QString &key, values.keys())
+        if (key.startsWith(prefix) && key.indexOf('/', prefix.size()) == -1)
+            entries.append(key);
+
+    return entries;
+}
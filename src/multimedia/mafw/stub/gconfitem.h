@@ -0,0 +1,33 @@
+#ifndef GCONFITEM_H
+#define GCONFITEM_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVariant>
+
+// In-memory stand-in for the GConfItem class of libgq-gconf. Values are shared
+// by all items with the same key for the lifetime of the process.
+class GConfItem : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GConfItem(const QString &key, QObject *parent = 0);
+    ~GConfItem();
+
+    QString key() const;
+    QVariant value() const;
+    QVariant value(const QVariant &def) const;
+    void set(const QVariant &val);
+    void unset();
+    QList<QString> listDirs() const;
+    QList<QString> listEntries() const;
+
+signals:
+    void valueChanged();
+
+private:
+    QString m_key;
+};
+
+#endif // GCONFITEM_H
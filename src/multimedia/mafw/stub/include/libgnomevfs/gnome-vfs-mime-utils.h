@@ -0,0 +1,13 @@
+#ifndef MAFW_STUB_GNOME_VFS_MIME_UTILS_H
+#define MAFW_STUB_GNOME_VFS_MIME_UTILS_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+// Detects the MIME type from the file extension only
+const char* gnome_vfs_get_mime_type_for_name(const char *filename);
+
+G_END_DECLS
+
+#endif // MAFW_STUB_GNOME_VFS_MIME_UTILS_H
@@ -0,0 +1,11 @@
+#ifndef MAFW_STUB_MAFW_PLAYLIST_MANAGER_H
+#define MAFW_STUB_MAFW_PLAYLIST_MANAGER_H
+
+#include <libmafw/mafw.h>
+
+typedef struct _MafwPlaylistManager MafwPlaylistManager;
+
+// The stub has a single playlist implementation
+typedef MafwPlaylist MafwProxyPlaylist;
+
+#endif // MAFW_STUB_MAFW_PLAYLIST_MANAGER_H
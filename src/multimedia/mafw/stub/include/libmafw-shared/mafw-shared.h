@@ -0,0 +1,7 @@
+#ifndef MAFW_STUB_MAFW_SHARED_H
+#define MAFW_STUB_MAFW_SHARED_H
+
+#include <libmafw/mafw.h>
+#include "mafw-playlist-manager.h"
+
+#endif // MAFW_STUB_MAFW_SHARED_H
@@ -0,0 +1,12 @@
+#ifndef MAFW_STUB_MAFW_LOG_H
+#define MAFW_STUB_MAFW_LOG_H
+
+#include "mafw.h"
+
+G_BEGIN_DECLS
+
+void mafw_log_init(const gchar *domains);
+
+G_END_DECLS
+
+#endif // MAFW_STUB_MAFW_LOG_H
@@ -0,0 +1,6 @@
+#ifndef MAFW_STUB_MAFW_PLAYLIST_H
+#define MAFW_STUB_MAFW_PLAYLIST_H
+
+#include "mafw.h"
+
+#endif // MAFW_STUB_MAFW_PLAYLIST_H
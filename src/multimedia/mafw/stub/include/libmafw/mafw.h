@@ -0,0 +1,114 @@
+#ifndef MAFW_STUB_MAFW_H
+#define MAFW_STUB_MAFW_H
+
+// Stand-in for the parts of libmafw used by the multimedia plugin, for builds
+// configured with CONFIG+=mafw_stub. The objects are opaque and are only
+// created and interpreted by the stub adapters in mafw/stub.
+
+#include <glib.h>
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+typedef struct _MafwRegistry MafwRegistry;
+typedef struct _MafwExtension MafwExtension;
+typedef struct _MafwRenderer MafwRenderer;
+typedef struct _MafwSource MafwSource;
+typedef struct _MafwPlaylist MafwPlaylist;
+
+typedef enum {
+    Stopped,
+    Playing,
+    Paused,
+    Transitioning,
+    _LastMafwPlayState
+} MafwPlayState;
+
+typedef enum {
+    SeekAbsolute,
+    SeekRelative
+} MafwRendererSeekMode;
+
+typedef enum {
+    MAFW_RENDERER_ERROR_NO_MEDIA,
+    MAFW_RENDERER_ERROR_URI_NOT_AVAILABLE,
+    MAFW_RENDERER_ERROR_INVALID_URI,
+    MAFW_RENDERER_ERROR_MEDIA_NOT_FOUND,
+    MAFW_RENDERER_ERROR_STREAM_DISCONNECTED,
+    MAFW_RENDERER_ERROR_TYPE_NOT_AVAILABLE,
+    MAFW_RENDERER_ERROR_PLAYBACK,
+    MAFW_RENDERER_ERROR_UNABLE_TO_PERFORM,
+    MAFW_RENDERER_ERROR_UNSUPPORTED_TYPE,
+    MAFW_RENDERER_ERROR_UNSUPPORTED_RESOLUTION,
+    MAFW_RENDERER_ERROR_UNSUPPORTED_FPS,
+    MAFW_RENDERER_ERROR_DRM,
+    MAFW_RENDERER_ERROR_DEVICE_UNAVAILABLE,
+    MAFW_RENDERER_ERROR_CORRUPTED_FILE,
+    MAFW_RENDERER_ERROR_PLAYLIST_PARSING,
+    MAFW_RENDERER_ERROR_CODEC_NOT_FOUND,
+    MAFW_RENDERER_ERROR_VIDEO_CODEC_NOT_FOUND,
+    MAFW_RENDERER_ERROR_AUDIO_CODEC_NOT_FOUND,
+    MAFW_RENDERER_ERROR_NO_PLAYLIST,
+    MAFW_RENDERER_ERROR_INDEX_OUT_OF_BOUNDS,
+    MAFW_RENDERER_ERROR_CANNOT_PLAY,
+    MAFW_RENDERER_ERROR_CANNOT_STOP,
+    MAFW_RENDERER_ERROR_CANNOT_PAUSE,
+    MAFW_RENDERER_ERROR_CANNOT_SET_POSITION,
+    MAFW_RENDERER_ERROR_CANNOT_GET_POSITION,
+    MAFW_RENDERER_ERROR_CANNOT_GET_STATUS
+} MafwRendererError;
+
+#define MAFW_PROPERTY_RENDERER_VOLUME "volume"
+
+#define MAFW_SOURCE_INVALID_BROWSE_ID G_MAXUINT
+#define MAFW_SOURCE_LIST(...) ({ static const gchar *const __keys[] = { __VA_ARGS__, NULL }; __keys; })
+
+#define MAFW_METADATA_KEY_URI "uri"
+#define MAFW_METADATA_KEY_MIME "mime-type"
+#define MAFW_METADATA_KEY_TITLE "title"
+#define MAFW_METADATA_KEY_DURATION "duration"
+#define MAFW_METADATA_KEY_IS_SEEKABLE "is-seekable"
+#define MAFW_METADATA_KEY_ARTIST "artist"
+#define MAFW_METADATA_KEY_ALBUM "album"
+#define MAFW_METADATA_KEY_GENRE "genre"
+#define MAFW_METADATA_KEY_TRACK "track"
+#define MAFW_METADATA_KEY_YEAR "year"
+#define MAFW_METADATA_KEY_COMMENT "comment"
+#define MAFW_METADATA_KEY_TAGS "tags"
+#define MAFW_METADATA_KEY_LYRICS "lyrics"
+#define MAFW_METADATA_KEY_COMPOSER "composer"
+#define MAFW_METADATA_KEY_COPYRIGHT "copyright"
+#define MAFW_METADATA_KEY_ORGANIZATION "organization"
+#define MAFW_METADATA_KEY_DESCRIPTION "description"
+#define MAFW_METADATA_KEY_FILESIZE "filesize"
+#define MAFW_METADATA_KEY_MODIFIED "modified"
+#define MAFW_METADATA_KEY_PLAY_COUNT "play-count"
+#define MAFW_METADATA_KEY_LAST_PLAYED "last-played"
+#define MAFW_METADATA_KEY_PAUSED_POSITION "paused-position"
+#define MAFW_METADATA_KEY_PAUSED_THUMBNAIL_URI "paused-thumbnail-uri"
+#define MAFW_METADATA_KEY_THUMBNAIL_URI "thumbnail-uri"
+#define MAFW_METADATA_KEY_ALBUM_ART_URI "album-art-uri"
+#define MAFW_METADATA_KEY_RENDERER_ART_URI "renderer-art-uri"
+#define MAFW_METADATA_KEY_RES_X "res-x"
+#define MAFW_METADATA_KEY_RES_Y "res-y"
+#define MAFW_METADATA_KEY_AUDIO_BITRATE "audio-bitrate"
+#define MAFW_METADATA_KEY_AUDIO_CODEC "audio-codec"
+#define MAFW_METADATA_KEY_VIDEO_BITRATE "video-bitrate"
+#define MAFW_METADATA_KEY_VIDEO_CODEC "video-codec"
+#define MAFW_METADATA_KEY_VIDEO_FRAMERATE "video-framerate"
+#define MAFW_METADATA_KEY_CHILDCOUNT_1 "childcount(1)"
+
+// Metadata tables map each key to a single GValue
+GHashTable* mafw_metadata_new(void);
+void mafw_metadata_add_str(GHashTable *metadata, const gchar *key, gchar *value);
+GValue* mafw_metadata_first(GHashTable *metadata, const gchar *key);
+void mafw_metadata_release(GHashTable *metadata);
+
+gchar* mafw_source_create_objectid(const gchar *uri);
+
+gchar** mafw_playlist_get_items(MafwPlaylist *playlist, guint from, guint to, GError **error);
+void mafw_playlist_cancel_get_items_md(gpointer op);
+
+G_END_DECLS
+
+#endif // MAFW_STUB_MAFW_H
@@ -0,0 +1,16 @@
+#ifndef MAFW_STUB_PLAYBACK_H
+#define MAFW_STUB_PLAYBACK_H
+
+// Stand-in for the libplayback types referenced by MafwRendererAdapter. The stub
+// renderer never requests a playback state.
+
+typedef struct _pb_playback_t pb_playback_t;
+typedef struct _pb_req_t pb_req_t;
+
+typedef enum {
+    PB_STATE_NONE,
+    PB_STATE_PLAY,
+    PB_STATE_STOP
+} pb_state_e;
+
+#endif // MAFW_STUB_PLAYBACK_H
@@ -0,0 +1,236 @@
+#include "../mafwplaylistadapter.h"
+#include "mafwstub.h"
+
+MafwPlaylistAdapter::MafwPlaylistAdapter(QObject *parent, MafwRendererAdapter *mra) :
+    QObject(parent),
+    mafwrenderer(mra)
+{
+    mafw_playlist = NULL;
+    error = NULL;
+    contents_changed_handler = 0;
+    item_moved_handler = 0;
+    connect(mafwrenderer, SIGNAL(playlistChanged(GObject*)), this, SLOT(onPlaylistChanged(GObject*)));
+}
+
+void MafwPlaylistAdapter::clear()
+{
+    if (mafw_playlist) {
+        mafwrenderer->stop();
+        clear(mafw_playlist);
+    }
+}
+
+void MafwPlaylistAdapter::clear(MafwPlaylist *playlist)
+{
+    if (playlist && !playlist->items.isEmpty()) {
+        const int count = playlist->items.size();
+        playlist->items.clear();
+
+        if (playlist == mafw_playlist)
+            emit contentsChanged(0, count, 0);
+    }
+}
+
+bool MafwPlaylistAdapter::isRepeat()
+{
+    return mafw_playlist && mafw_playlist->repeat;
+}
+
+void MafwPlaylistAdapter::setRepeat(bool repeat)
+{
+    if (mafw_playlist)
+        mafw_playlist->repeat = repeat;
+}
+
+bool MafwPlaylistAdapter::isShuffled()
+{
+    return mafw_playlist && mafw_playlist->shuffled;
+}
+
+// Shuffling changes only the playback order, which the stub renderer does not follow
+void MafwPlaylistAdapter::setShuffled(bool shuffled)
+{
+    if (mafw_playlist)
+        mafw_playlist->shuffled = shuffled;
+}
+
+void MafwPlaylistAdapter::insertUri(QString uri, guint index)
+{
+    gchar *objectId = mafw_source_create_objectid(uri.toUtf8());
+    insertItem(QString::fromUtf8(objectId), index);
+    g_free(objectId);
+}
+
+void MafwPlaylistAdapter::insertItem(QString objectId, guint index)
+{
+    if (mafw_playlist) {
+        index = qMin<guint>(index, mafw_playlist->items.size());
+        mafw_playlist->items.insert(index, objectId.toUtf8());
+        emit contentsChanged(index, 0, 1);
+    }
+}
+
+void MafwPlaylistAdapter::appendUri(QString uri)
+{
+    gchar *objectId = mafw_source_create_objectid(uri.toUtf8());
+    appendItem(QString::fromUtf8(objectId));
+    g_free(objectId);
+}
+
+void MafwPlaylistAdapter::appendItem(QString objectId)
+{
+    appendItem(mafw_playlist, objectId);
+}
+
+void MafwPlaylistAdapter::appendItem(MafwPlaylist *playlist, QString objectId)
+{
+    if (playlist) {
+        playlist->items.append(objectId.toUtf8());
+
+        if (playlist == mafw_playlist)
+            emit contentsChanged(playlist->items.size() - 1, 0, 1);
+    }
+}
+
+void MafwPlaylistAdapter::appendItems(const gchar** oid)
+{
+    appendItems(mafw_playlist, oid);
+}
+
+void MafwPlaylistAdapter::appendItems(MafwPlaylist *playlist, const gchar** oid)
+{
+    if (playlist) {
+        const int from = playlist->items.size();
+
+        for (int i = 0; oid[i] != NULL; i++)
+            playlist->items.append(QByteArray(oid[i]));
+
+        if (playlist == mafw_playlist && playlist->items.size() > from)
+            emit contentsChanged(from, 0, playlist->items.size() - from);
+    }
+}
+
+void MafwPlaylistAdapter::insertItems(const gchar** oid, guint index)
+{
+    if (mafw_playlist)
+        for (int i = 0; oid[i] != NULL; i++)
+            insertItem(QString::fromUtf8(oid[i]), index + i);
+}
+
+void MafwPlaylistAdapter::moveItem(int from, int to)
+{
+    if (mafw_playlist && from >= 0 && from < mafw_playlist->items.size() && to >= 0 && to < mafw_playlist->items.size()) {
+        mafw_playlist->items.move(from, to);
+        emit itemMoved(from, to);
+    }
+}
+
+void MafwPlaylistAdapter::removeItem(int index)
+{
+    if (mafw_playlist && index >= 0 && index < mafw_playlist->items.size()) {
+        mafw_playlist->items.removeAt(index);
+        emit contentsChanged(index, 1, 0);
+    }
+}
+
+int MafwPlaylistAdapter::getSize()
+{
+    return getSizeOf(mafw_playlist);
+}
+
+int MafwPlaylistAdapter::getSizeOf(MafwPlaylist *playlist)
+{
+    return playlist ? playlist->items.size() : 0;
+}
+
+gpointer MafwPlaylistAdapter::getAllItems()
+{
+    return this->getItems(0, -1);
+}
+
+gpointer MafwPlaylistAdapter::getItems(int from, int to, const gchar* const *keys)
+{
+    return mafw_playlist ? getItemsOf(mafw_playlist, from, to, keys) : NULL;
+}
+
+gpointer MafwPlaylistAdapter::getItemsOf(MafwPlaylist *playlist)
+{
+    return getItemsOf(playlist, 0, -1);
+}
+
+gpointer MafwPlaylistAdapter::getItemsOf(MafwPlaylist *playlist, int from, int to, const gchar* const *keys)
+{
+    get_items_cb_payload* pl = new get_items_cb_payload;
+    pl->adapter = this;
+    pl->op = MafwStub::getItems(playlist, from, to, keys, MafwPlaylistAdapter::get_items_cb, pl, get_items_free_cbarg);
+    return pl->op;
+}
+
+void MafwPlaylistAdapter::get_items_cb(MafwPlaylist*,
+                                       guint index,
+                                       const char *object_id,
+                                       GHashTable *metadata,
+                                       gpointer user_data)
+{
+    MafwPlaylistAdapter* adapter = static_cast<get_items_cb_payload*>(user_data)->adapter;
+                     gpointer op = static_cast<get_items_cb_payload*>(user_data)->op;
+
+    emit adapter->onGetItems(QString::fromUtf8(object_id), metadata, index, op);
+}
+
+void MafwPlaylistAdapter::get_items_free_cbarg(gpointer user_data)
+{
+    MafwPlaylistAdapter* adapter = static_cast<get_items_cb_payload*>(user_data)->adapter;
+                     gpointer op = static_cast<get_items_cb_payload*>(user_data)->op;
+
+    emit adapter->getItemsComplete(op);
+    delete static_cast<get_items_cb_payload*>(user_data);
+}
+
+void MafwPlaylistAdapter::onGetStatus(MafwPlaylist* playlist, uint, MafwPlayState, const char*, QString)
+{
+    this->mafw_playlist = playlist;
+
+    if (!mafw_playlist)
+        this->assignAudioPlaylist();
+}
+
+void MafwPlaylistAdapter::onPlaylistChanged(GObject* playlist)
+{
+    this->mafw_playlist = reinterpret_cast<MafwPlaylist*>(playlist);
+    emit playlistChanged();
+}
+
+QString MafwPlaylistAdapter::playlistName()
+{
+    return mafw_playlist ? QString::fromUtf8(mafw_playlist->name) : QString();
+}
+
+void MafwPlaylistAdapter::assignAudioPlaylist()
+{
+    mafw_playlist = MafwPlaylistManagerAdapter::get()->createPlaylist("FmpAudioPlaylist");
+    mafwrenderer->assignPlaylist(mafw_playlist);
+}
+
+void MafwPlaylistAdapter::assignVideoPlaylist()
+{
+    mafw_playlist = MafwPlaylistManagerAdapter::get()->createPlaylist("FmpVideoPlaylist");
+    mafwrenderer->assignPlaylist(mafw_playlist);
+}
+
+void MafwPlaylistAdapter::assignRadioPlaylist()
+{
+    mafw_playlist = MafwPlaylistManagerAdapter::get()->createPlaylist("FmpRadioPlaylist");
+    mafwrenderer->assignPlaylist(mafw_playlist);
+}
+
+void MafwPlaylistAdapter::duplicatePlaylist(QString newName)
+{
+    MafwPlaylistManagerAdapter *mafw_playlist_manager = MafwPlaylistManagerAdapter::get();
+    mafw_playlist_manager->duplicatePlaylist(newName, mafw_playlist_manager->createPlaylist(this->playlistName()));
+}
+
+bool MafwPlaylistAdapter::isPlaylistNull()
+{
+    return !mafw_playlist;
+}
@@ -0,0 +1,63 @@
+#include "../mafwplaylistmanageradapter.h"
+#include "mafwstub.h"
+
+MafwPlaylistManagerAdapter* MafwPlaylistManagerAdapter::instance = NULL;
+
+MafwPlaylistManagerAdapter* MafwPlaylistManagerAdapter::get()
+{
+    return instance ? instance : instance = new MafwPlaylistManagerAdapter();
+}
+
+MafwPlaylistManagerAdapter::MafwPlaylistManagerAdapter()
+{
+    this->playlist_manager = NULL;
+}
+
+MafwProxyPlaylist* MafwPlaylistManagerAdapter::createPlaylist(QString playlistName)
+{
+    return MafwStub::playlist(playlistName.toUtf8());
+}
+
+void MafwPlaylistManagerAdapter::duplicatePlaylist(QString newPlaylistName, MafwProxyPlaylist *playlist)
+{
+    MafwStub::playlist(newPlaylistName.toUtf8())->items = playlist->items;
+}
+
+// Importing is not simulated, the playlist is reported as failed
+void MafwPlaylistManagerAdapter::importPlaylist(QString)
+{
+    emit playlistImported(NULL, 0);
+}
+
+MafwProxyPlaylist* MafwPlaylistManagerAdapter::getPlaylist(guint id)
+{
+    const QList<MafwPlaylist*> playlists = MafwStub::playlists();
+    return id < guint(playlists.size()) ? playlists.at(id) : NULL;
+}
+
+GPtrArray* MafwPlaylistManagerAdapter::getPlaylists()
+{
+    GPtrArray *array = g_ptr_array_new();
+
+    foreach (MafwPlaylist *playlist, MafwStub::playlists())
+        g_ptr_array_add(array, playlist);
+
+    return array;
+}
+
+// Only the stub playlists themselves are available, not the list of ids and names
+GArray* MafwPlaylistManagerAdapter::listPlaylists()
+{
+    return NULL;
+}
+
+void MafwPlaylistManagerAdapter::freeListOfPlaylists(GArray *playlist_list)
+{
+    if (playlist_list)
+        g_array_free(playlist_list, TRUE);
+}
+
+void MafwPlaylistManagerAdapter::deletePlaylist(QString playlistName)
+{
+    MafwStub::destroyPlaylist(this->createPlaylist(playlistName));
+}
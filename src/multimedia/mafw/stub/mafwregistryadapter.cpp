@@ -0,0 +1,56 @@
+#include "../mafwregistryadapter.h"
+
+MafwRegistryAdapter* MafwRegistryAdapter::instance = NULL;
+
+MafwRegistryAdapter* MafwRegistryAdapter::get()
+{
+    if (!instance) {
+        instance = new MafwRegistryAdapter();
+
+        // Additional initialization
+        instance->m_renderer = new MafwRendererAdapter();
+        instance->m_playlist = new MafwPlaylistAdapter(instance, instance->m_renderer);
+        instance->sources[Tracker] = new MafwSourceAdapter("localtagfs");
+        instance->sources[Radio ]= new MafwSourceAdapter("iradiosource");
+        instance->sources[Upnp] = new MafwSourceAdapter("upnpcontrolsource");
+
+#ifdef MAFW_WORKAROUNDS
+        instance->m_renderer->playlist = instance->m_playlist;
+#endif
+    }
+    return instance;
+}
+
+// The stub sources are always present, so the registry never announces any
+MafwRegistryAdapter::MafwRegistryAdapter()
+{
+    registry = NULL;
+}
+
+MafwSource* MafwRegistryAdapter::findSourceByUUID(const QString &)
+{
+    return NULL;
+}
+
+MafwRendererAdapter* MafwRegistryAdapter::renderer()
+{
+    return m_renderer;
+}
+
+MafwPlaylistAdapter* MafwRegistryAdapter::playlist()
+{
+    return m_playlist;
+}
+
+MafwSourceAdapter* MafwRegistryAdapter::source(RecognizedSource source)
+{
+    return sources[source];
+}
+
+bool MafwRegistryAdapter::isRecognized(const QString &uuid)
+{
+    for (int i = 0; i < RecognizedSourceCount; i++)
+        if (sources[i]->uuid() == uuid)
+            return true;
+    return false;
+}
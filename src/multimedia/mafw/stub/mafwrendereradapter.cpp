@@ -0,0 +1,308 @@
+#include "../mafwrendereradapter.h"
+#include "mafwstub.h"
+#include "../../playbackstatistics.h"
+#include <QElapsedTimer>
+#include <QTimer>
+#include <string.h>
+
+// The stub renderer plays nothing. It keeps the state that a real renderer
+// would report and answers every request immediately. Calls and replies are
+// counted in PlaybackStatistics under the names used by the real adapter.
+static MafwPlaylist *currentPlaylist = NULL;
+static QByteArray currentObjectId;
+static int currentIndex = 0;
+static MafwPlayState currentState = Stopped;
+static int currentPosition = 0;
+static int currentVolume = 50;
+static QElapsedTimer playingTimer;
+
+static int position()
+{
+    return currentState == Playing ? currentPosition + int(playingTimer.elapsed() / 1000) : currentPosition;
+}
+
+MafwRendererAdapter::MafwRendererAdapter()
+{
+    this->mafw_registry = NULL;
+    this->mafw_renderer = NULL;
+    this->playback = NULL;
+    this->compatiblePlayback = false;
+    memset(&GVolume, 0, sizeof(GVolume));
+    g_value_init (&GVolume, G_TYPE_UINT);
+#ifdef MAFW_WORKAROUNDS
+    this->playlist = NULL;
+#endif
+
+    QTimer::singleShot(0, this, SIGNAL(rendererReady()));
+}
+
+void MafwRendererAdapter::enablePlayback(bool, bool)
+{
+}
+
+void MafwRendererAdapter::initializePlayback(MafwPlaylist*, uint, MafwPlayState, const char*, QString)
+{
+}
+
+bool MafwRendererAdapter::isRendererReady()
+{
+    return true;
+}
+
+// Moves to the item at index of the assigned playlist, or to objectId when it is not empty
+static bool setMedia(int index, const QByteArray &objectId = QByteArray())
+{
+    if (objectId.isEmpty()) {
+        if (!currentPlaylist || index < 0 || index >= currentPlaylist->items.size())
+            return false;
+
+        currentObjectId = currentPlaylist->items.at(index);
+    } else {
+        currentObjectId = objectId;
+    }
+
+    currentIndex = index;
+    currentPosition = 0;
+    playingTimer.restart();
+    return true;
+}
+
+static bool setState(MafwPlayState state)
+{
+    if (state == currentState)
+        return false;
+
+    currentPosition = position();
+    currentState = state;
+    playingTimer.restart();
+    return true;
+}
+
+void MafwRendererAdapter::play()
+{
+    PlaybackStatistics::countRendererCall("play");
+
+    if (currentObjectId.isEmpty()) {
+        if (!setMedia(currentIndex)) {
+            PlaybackStatistics::countRendererSignal("signalPlay");
+            emit signalPlay("No media");
+            return;
+        }
+
+        PlaybackStatistics::countRendererSignal("mediaChanged");
+        emit mediaChanged(currentIndex, currentObjectId.data());
+    }
+
+    if (setState(Playing)) {
+        PlaybackStatistics::countRendererSignal("stateChanged");
+        emit stateChanged(Playing);
+    }
+
+    PlaybackStatistics::countRendererSignal("signalPlay");
+    emit signalPlay(QString());
+}
+
+void MafwRendererAdapter::playObject(const char* object_id)
+{
+    PlaybackStatistics::countRendererCall("playObject");
+
+    setMedia(currentIndex, object_id);
+    PlaybackStatistics::countRendererSignal("mediaChanged");
+    emit mediaChanged(currentIndex, currentObjectId.data());
+
+    if (setState(Playing)) {
+        PlaybackStatistics::countRendererSignal("stateChanged");
+        emit stateChanged(Playing);
+    }
+
+    PlaybackStatistics::countRendererSignal("signalPlayObject");
+    emit signalPlayObject(QString());
+}
+
+void MafwRendererAdapter::playURI(const char* uri)
+{
+    PlaybackStatistics::countRendererCall("playURI");
+
+    gchar *objectId = mafw_source_create_objectid(uri);
+    setMedia(currentIndex, objectId);
+    g_free(objectId);
+    PlaybackStatistics::countRendererSignal("mediaChanged");
+    emit mediaChanged(currentIndex, currentObjectId.data());
+
+    if (setState(Playing)) {
+        PlaybackStatistics::countRendererSignal("stateChanged");
+        emit stateChanged(Playing);
+    }
+
+    PlaybackStatistics::countRendererSignal("signalPlayURI");
+    emit signalPlayURI(QString());
+}
+
+void MafwRendererAdapter::stop()
+{
+    PlaybackStatistics::countRendererCall("stop");
+
+    if (setState(Stopped)) {
+        currentPosition = 0;
+        PlaybackStatistics::countRendererSignal("stateChanged");
+        emit stateChanged(Stopped);
+    }
+
+    PlaybackStatistics::countRendererSignal("signalStop");
+    emit signalStop(QString());
+}
+
+void MafwRendererAdapter::pause()
+{
+    PlaybackStatistics::countRendererCall("pause");
+
+    if (currentState == Playing && setState(Paused)) {
+        PlaybackStatistics::countRendererSignal("stateChanged");
+        emit stateChanged(Paused);
+    }
+
+    PlaybackStatistics::countRendererSignal("signalPause");
+    emit signalPause(QString());
+}
+
+void MafwRendererAdapter::resume()
+{
+    PlaybackStatistics::countRendererCall("resume");
+
+    if (currentState == Paused && setState(Playing)) {
+        PlaybackStatistics::countRendererSignal("stateChanged");
+        emit stateChanged(Playing);
+    }
+
+    PlaybackStatistics::countRendererSignal("signalResume");
+    emit signalResume(QString());
+}
+
+void MafwRendererAdapter::getStatus()
+{
+    PlaybackStatistics::countRendererCall("getStatus");
+
+    PlaybackStatistics::countRendererSignal("signalGetStatus");
+    emit signalGetStatus(currentPlaylist, currentIndex, currentState, currentObjectId.constData(), QString());
+}
+
+void MafwRendererAdapter::next()
+{
+    PlaybackStatistics::countRendererCall("next");
+
+    if (setMedia(currentIndex + 1)) {
+        PlaybackStatistics::countRendererSignal("mediaChanged");
+        emit mediaChanged(currentIndex, currentObjectId.data());
+        PlaybackStatistics::countRendererSignal("signalNext");
+        emit signalNext(QString());
+    } else {
+        PlaybackStatistics::countRendererSignal("signalNext");
+        emit signalNext("Index out of bounds");
+    }
+}
+
+void MafwRendererAdapter::previous()
+{
+    PlaybackStatistics::countRendererCall("previous");
+
+    if (setMedia(currentIndex - 1)) {
+        PlaybackStatistics::countRendererSignal("mediaChanged");
+        emit mediaChanged(currentIndex, currentObjectId.data());
+        PlaybackStatistics::countRendererSignal("signalPrevious");
+        emit signalPrevious(QString());
+    } else {
+        PlaybackStatistics::countRendererSignal("signalPrevious");
+        emit signalPrevious("Index out of bounds");
+    }
+}
+
+void MafwRendererAdapter::gotoIndex(uint index)
+{
+    PlaybackStatistics::countRendererCall("gotoIndex");
+
+    if (setMedia(index)) {
+        PlaybackStatistics::countRendererSignal("mediaChanged");
+        emit mediaChanged(currentIndex, currentObjectId.data());
+        PlaybackStatistics::countRendererSignal("signalGotoIndex");
+        emit signalGotoIndex(QString());
+    } else {
+        PlaybackStatistics::countRendererSignal("signalGotoIndex");
+        emit signalGotoIndex("Index out of bounds");
+    }
+}
+
+void MafwRendererAdapter::setPosition(MafwRendererSeekMode mode, int seconds)
+{
+    PlaybackStatistics::countRendererCall("setPosition");
+
+    currentPosition = qMax(0, mode == SeekRelative ? position() + seconds : seconds);
+    playingTimer.restart();
+    PlaybackStatistics::countRendererSignal("signalSetPosition");
+    emit signalSetPosition(currentPosition, QString());
+}
+
+void MafwRendererAdapter::getPosition()
+{
+    PlaybackStatistics::countRendererCall("getPosition");
+
+    PlaybackStatistics::countRendererSignal("signalGetPosition");
+    emit signalGetPosition(position(), QString());
+}
+
+void MafwRendererAdapter::getCurrentMetadata()
+{
+    PlaybackStatistics::countRendererCall("getCurrentMetadata");
+
+    GHashTable *metadata = currentObjectId.isEmpty() ? NULL : MafwStub::metadata(currentObjectId, NULL);
+    PlaybackStatistics::countRendererSignal("signalGetCurrentMetadata");
+    emit signalGetCurrentMetadata(metadata, QString::fromUtf8(currentObjectId), QString());
+    mafw_metadata_release(metadata);
+}
+
+void MafwRendererAdapter::setVolume(int volume)
+{
+    PlaybackStatistics::countRendererCall("setVolume");
+
+    currentVolume = qBound(0, volume, 100);
+}
+
+void MafwRendererAdapter::getVolume()
+{
+    PlaybackStatistics::countRendererCall("getVolume");
+
+    PlaybackStatistics::countRendererSignal("signalGetVolume");
+    emit signalGetVolume(currentVolume);
+}
+
+void MafwRendererAdapter::setWindowXid(uint)
+{
+    PlaybackStatistics::countRendererCall("setWindowXid");
+
+}
+
+void MafwRendererAdapter::setColorKey(int)
+{
+    PlaybackStatistics::countRendererCall("setColorKey");
+
+}
+
+void MafwRendererAdapter::setErrorPolicy(uint)
+{
+    PlaybackStatistics::countRendererCall("setErrorPolicy");
+
+}
+
+bool MafwRendererAdapter::assignPlaylist(MafwPlaylist* playlist)
+{
+    PlaybackStatistics::countRendererCall("assignPlaylist");
+
+    if (playlist != currentPlaylist) {
+        currentPlaylist = playlist;
+        currentObjectId.clear();
+        currentIndex = 0;
+        PlaybackStatistics::countRendererSignal("playlistChanged");
+        emit playlistChanged(reinterpret_cast<GObject*>(playlist));
+    }
+
+    return true;
+}
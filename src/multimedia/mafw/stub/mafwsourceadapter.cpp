@@ -0,0 +1,157 @@
+#include "../mafwsourceadapter.h"
+#include "mafwstub.h"
+
+QSet<gpointer> MafwSourceAdapter::instances;
+
+MafwSourceAdapter::MafwSourceAdapter(MafwSource *source)
+{
+    init();
+
+    bind(source);
+}
+
+// The stub sources are always available, which is announced as a change of the root container
+MafwSourceAdapter::MafwSourceAdapter(const QString &uuid) :
+    m_uuid(uuid)
+{
+    init();
+
+    QMetaObject::invokeMethod(this, "containerChanged", Qt::QueuedConnection, Q_ARG(QString, uuid + "::"));
+}
+
+MafwSourceAdapter::~MafwSourceAdapter()
+{
+    instances.remove(this);
+}
+
+void MafwSourceAdapter::init()
+{
+    instances.insert(this);
+
+    source = NULL;
+}
+
+void MafwSourceAdapter::bind(MafwSource *source)
+{
+    this->source = source;
+}
+
+QString MafwSourceAdapter::uuid()
+{
+    return m_uuid;
+}
+
+QString MafwSourceAdapter::name()
+{
+    return m_uuid == "localtagfs" ? "Mafw-Tracker-Source" : m_uuid;
+}
+
+bool MafwSourceAdapter::isReady()
+{
+    return true;
+}
+
+void MafwSourceAdapter::onSourceAdded(MafwSource *)
+{
+}
+
+void MafwSourceAdapter::onSourceRemoved(MafwSource *)
+{
+}
+
+//--- Operations ---------------------------------------------------------------
+
+// Filters and sorting are not simulated, every container lists the generated tracks
+uint MafwSourceAdapter::browse(const QString &, bool, const char *, const char *, const char *const *metadataKeys, uint skipCount, uint itemCount)
+{
+    return MafwStub::browse(source, metadataKeys, skipCount, itemCount, &onBrowseResult, this);
+}
+
+bool MafwSourceAdapter::cancelBrowse(uint browseId)
+{
+    return MafwStub::cancelBrowse(browseId);
+}
+
+void MafwSourceAdapter::getMetadata(const QString &objectId, const char *const *metadataKeys)
+{
+    MafwStub::getMetadata(source, objectId.toUtf8(), metadataKeys, &onMetadataResult, this);
+}
+
+void MafwSourceAdapter::getUri(const QString &objectId)
+{
+    MafwStub::getMetadata(source, objectId.toUtf8(), MAFW_SOURCE_LIST(MAFW_METADATA_KEY_URI), &onUriResult, this);
+}
+
+// Objects are not stored, creating and destroying them only reports success
+void MafwSourceAdapter::createObject(const QString &parent, GHashTable *)
+{
+    onObjectCreated(source, parent.toUtf8(), this, NULL);
+}
+
+void MafwSourceAdapter::destroyObject(const QString &objectId)
+{
+    onObjectDestroyed(source, objectId.toUtf8(), this, NULL);
+}
+
+// Metadata is generated from the object id, so changes are accepted and forgotten
+void MafwSourceAdapter::setMetadata(const QString &objectId, GHashTable *)
+{
+    onMetadataSet(source, objectId.toUtf8(), NULL, this, NULL);
+}
+
+QString MafwSourceAdapter::createObjectId(const QString &uri)
+{
+    gchar *objectId = mafw_source_create_objectid(uri.toUtf8());
+    const QString result = QString::fromUtf8(objectId);
+    g_free(objectId);
+    return result;
+}
+
+//--- Callbacks ----------------------------------------------------------------
+
+void MafwSourceAdapter::onBrowseResult(MafwSource *, guint browseId, gint remainingCount, guint index, const gchar *objectId, GHashTable *metadata, gpointer self, const GError *error)
+{
+    if (instances.contains(self))
+        emit static_cast<MafwSourceAdapter*>(self)->browseResult(browseId, remainingCount, index, QString::fromUtf8(objectId), metadata, error ? error->message : QString());
+}
+
+void MafwSourceAdapter::onMetadataResult(MafwSource *, const gchar *objectId, GHashTable *metadata, gpointer self, const GError *error)
+{
+    if (instances.contains(self))
+        emit static_cast<MafwSourceAdapter*>(self)->metadataResult(QString::fromUtf8(objectId), metadata, error ? error->message : QString());
+}
+
+void MafwSourceAdapter::onUriResult(MafwSource *, const gchar *objectId, GHashTable *metadata, gpointer self, const GError *error)
+{
+    if (instances.contains(self)) {
+        QString uri;
+        if (GValue *v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_URI))
+            uri = QString::fromUtf8(g_value_get_string(v));
+
+        emit static_cast<MafwSourceAdapter*>(self)->gotUri(QString::fromUtf8(objectId), uri, error ? error->message : QString());
+    }
+}
+
+void MafwSourceAdapter::onObjectCreated(MafwSource *, const gchar* objectId, gpointer self, const GError *error)
+{
+    if (instances.contains(self))
+        emit static_cast<MafwSourceAdapter*>(self)->objectCreated(QString::fromUtf8(objectId), error ? error->message : QString());
+}
+
+void MafwSourceAdapter::onObjectDestroyed(MafwSource *, const gchar *objectId, gpointer self, const GError *error)
+{
+    if (instances.contains(self))
+        emit static_cast<MafwSourceAdapter*>(self)->objectDestroyed(QString::fromUtf8(objectId), error ? error->message : QString());
+}
+
+void MafwSourceAdapter::onMetadataSet(MafwSource *, const gchar *objectId, const gchar **failedKeys, gpointer self, const GError *error)
+{
+    if (instances.contains(self)) {
+        QStringList failedKeyList;
+        if (failedKeys)
+            for (; *failedKeys; failedKeys++)
+                failedKeyList.append(*failedKeys);
+
+        emit static_cast<MafwSourceAdapter*>(self)->metadataSet(QString::fromUtf8(objectId), failedKeyList, error ? error->message : QString());
+    }
+}
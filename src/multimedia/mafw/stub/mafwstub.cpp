@@ -0,0 +1,554 @@
+#include "mafwstub.h"
+#include <QBasicTimer>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QTimerEvent>
+#include <libgnomevfs/gnome-vfs-mime-utils.h>
+#include <libmafw/mafw-log.h>
+#include <string.h>
+
+#define DEFAULT_PLAYLIST_SIZE 1000
+#define DEFAULT_LATENCY 20 // ms per request
+#define DEFAULT_ITEM_LATENCY 50 // us per item
+#define TRACK_PREFIX "localtagfs::music/songs/%2Fhome%2Fuser%2FMyDocs%2F.stub%2Ftrack"
+#define TRACK_SUFFIX ".mp3"
+
+static int envValue(const char *name, int defaultValue)
+{
+    bool ok = false;
+    const int value = qgetenv(name).toInt(&ok);
+    return ok && value >= 0 ? value : defaultValue;
+}
+
+static int stubPlaylistSize = envValue("QCH_MAFW_STUB_PLAYLIST_SIZE", DEFAULT_PLAYLIST_SIZE);
+static int stubLatency = envValue("QCH_MAFW_STUB_LATENCY", DEFAULT_LATENCY);
+static int stubItemLatency = envValue("QCH_MAFW_STUB_ITEM_LATENCY", DEFAULT_ITEM_LATENCY);
+
+static QList<MafwPlaylist*> stubPlaylists;
+
+static const char* const GENRES[] = { "Rock", "Pop", "Jazz", "Classical", "Electronic", "Folk", "Hip-Hop", "Metal" };
+
+//--- Metadata -----------------------------------------------------------------
+
+// The set of keys requested by a query, which is built once per query
+class KeyFilter
+{
+public:
+    explicit KeyFilter(const gchar *const *keys) :
+        all(!keys)
+    {
+        if (keys)
+            for (int i = 0; keys[i]; i++)
+                wanted.insert(QByteArray(keys[i]));
+    }
+
+    bool accepts(const char *key) const
+    {
+        return all || wanted.contains(QByteArray::fromRawData(key, qstrlen(key)));
+    }
+
+private:
+    QSet<QByteArray> wanted;
+    bool all;
+};
+
+static void freeValue(gpointer value)
+{
+    g_value_unset(static_cast<GValue*>(value));
+    g_free(value);
+}
+
+static GValue* newValue(GType type)
+{
+    GValue *value = g_new0(GValue, 1);
+    g_value_init(value, type);
+    return value;
+}
+
+static void insertString(GHashTable *metadata, const KeyFilter &filter, const char *key, const QByteArray &string)
+{
+    if (filter.accepts(key) && !string.isEmpty()) {
+        GValue *value = newValue(G_TYPE_STRING);
+        g_value_set_string(value, string.constData());
+        g_hash_table_insert(metadata, g_strdup(key), value);
+    }
+}
+
+static void insertInt(GHashTable *metadata, const KeyFilter &filter, const char *key, int number)
+{
+    if (filter.accepts(key)) {
+        GValue *value = newValue(G_TYPE_INT);
+        g_value_set_int(value, number);
+        g_hash_table_insert(metadata, g_strdup(key), value);
+    }
+}
+
+static void insertInt64(GHashTable *metadata, const KeyFilter &filter, const char *key, qint64 number)
+{
+    if (filter.accepts(key)) {
+        GValue *value = newValue(G_TYPE_INT64);
+        g_value_set_int64(value, number);
+        g_hash_table_insert(metadata, g_strdup(key), value);
+    }
+}
+
+static void insertBoolean(GHashTable *metadata, const KeyFilter &filter, const char *key, bool boolean)
+{
+    if (filter.accepts(key)) {
+        GValue *value = newValue(G_TYPE_BOOLEAN);
+        g_value_set_boolean(value, boolean);
+        g_hash_table_insert(metadata, g_strdup(key), value);
+    }
+}
+
+// Generated tracks are numbered, other objects get a stable number from their id
+static int trackIndex(const QByteArray &objectId)
+{
+    const int prefix = qstrlen(TRACK_PREFIX);
+    const int suffix = qstrlen(TRACK_SUFFIX);
+
+    if (objectId.startsWith(TRACK_PREFIX) && objectId.endsWith(TRACK_SUFFIX)) {
+        bool ok = false;
+        const int index = objectId.mid(prefix, objectId.size() - prefix - suffix).toInt(&ok);
+
+        if (ok)
+            return index;
+    }
+
+    return qHash(objectId) % 100000;
+}
+
+// Recovers the URI that MediaObjectId encoded in the object id
+static QByteArray trackUri(const QByteArray &objectId)
+{
+    QByteArray path = objectId.mid(objectId.indexOf("::") + 2);
+
+    if (path.startsWith("music/songs/"))
+        path.remove(0, 12);
+    else if (path.startsWith("videos/"))
+        path.remove(0, 7);
+
+    path.replace("%2F", "/");
+
+    return path.startsWith("/") ? "file://" + path : path;
+}
+
+static GHashTable* trackMetadata(const QByteArray &objectId, const KeyFilter &filter)
+{
+    GHashTable *metadata = mafw_metadata_new();
+    const int index = trackIndex(objectId);
+    const QByteArray uri = trackUri(objectId);
+    const bool video = objectId.contains("::videos/");
+    const int album = index / 10;
+    const int playCount = index % 7;
+
+    insertString(metadata, filter, MAFW_METADATA_KEY_URI, uri);
+    insertString(metadata, filter, MAFW_METADATA_KEY_MIME, gnome_vfs_get_mime_type_for_name(uri.constData()));
+    insertString(metadata, filter, MAFW_METADATA_KEY_TITLE, "Track " + QByteArray::number(index));
+    insertString(metadata, filter, MAFW_METADATA_KEY_ARTIST, "Artist " + QByteArray::number(album / 5 % 400));
+    insertString(metadata, filter, MAFW_METADATA_KEY_ALBUM, "Album " + QByteArray::number(album));
+    insertString(metadata, filter, MAFW_METADATA_KEY_GENRE, GENRES[album % 8]);
+    insertString(metadata, filter, MAFW_METADATA_KEY_ALBUM_ART_URI,
+                 "file:///home/user/.cache/media-art/album-" + QByteArray::number(album) + ".jpeg");
+    insertInt(metadata, filter, MAFW_METADATA_KEY_TRACK, index % 10 + 1);
+    insertInt(metadata, filter, MAFW_METADATA_KEY_YEAR, 1960 + album % 60);
+    insertInt(metadata, filter, MAFW_METADATA_KEY_DURATION, 120 + index * 7 % 300);
+    insertBoolean(metadata, filter, MAFW_METADATA_KEY_IS_SEEKABLE, true);
+    insertInt(metadata, filter, MAFW_METADATA_KEY_FILESIZE, 3000000 + index % 1000 * 1000);
+    insertInt64(metadata, filter, MAFW_METADATA_KEY_MODIFIED, Q_INT64_C(1262304000) + index * 60);
+    insertInt(metadata, filter, MAFW_METADATA_KEY_PLAY_COUNT, playCount);
+    insertInt64(metadata, filter, MAFW_METADATA_KEY_LAST_PLAYED, playCount ? Q_INT64_C(1400000000) + index : 0);
+    insertInt(metadata, filter, MAFW_METADATA_KEY_PAUSED_POSITION, 0);
+    insertInt(metadata, filter, MAFW_METADATA_KEY_AUDIO_BITRATE, 128000 + index % 3 * 64000);
+    insertString(metadata, filter, MAFW_METADATA_KEY_AUDIO_CODEC, video ? "aac" : "mp3");
+
+    // Only some tracks have the less common tags, as with real collections
+    if (index % 5 == 0)
+        insertString(metadata, filter, MAFW_METADATA_KEY_COMPOSER, "Composer " + QByteArray::number(album % 50));
+
+    if (video) {
+        insertInt(metadata, filter, MAFW_METADATA_KEY_RES_X, 800);
+        insertInt(metadata, filter, MAFW_METADATA_KEY_RES_Y, 480);
+        insertInt(metadata, filter, MAFW_METADATA_KEY_VIDEO_BITRATE, 1500000);
+        insertString(metadata, filter, MAFW_METADATA_KEY_VIDEO_CODEC, "mpeg4");
+        insertInt(metadata, filter, MAFW_METADATA_KEY_VIDEO_FRAMERATE, 25);
+    }
+
+    return metadata;
+}
+
+//--- Requests -----------------------------------------------------------------
+
+// An operation answered from the event loop after the configured latency
+class StubRequest : public QObject
+{
+public:
+    explicit StubRequest(int items) :
+        cancelled(false),
+        finished(false)
+    {
+        timer.start(stubLatency + qint64(items) * stubItemLatency / 1000, this);
+    }
+
+    void cancel()
+    {
+        cancelled = true;
+        timer.stop();
+        finish();
+        deleteLater();
+    }
+
+protected:
+    virtual void run() = 0;
+    virtual void release() {}
+
+    void timerEvent(QTimerEvent *event)
+    {
+        if (event->timerId() != timer.timerId()) {
+            QObject::timerEvent(event);
+            return;
+        }
+
+        timer.stop();
+        run();
+        finish();
+        deleteLater();
+    }
+
+    bool cancelled;
+
+private:
+    void finish()
+    {
+        if (!finished) {
+            finished = true;
+            release();
+        }
+    }
+
+    QBasicTimer timer;
+    bool finished;
+};
+
+class GetItemsRequest : public StubRequest
+{
+public:
+    GetItemsRequest(MafwPlaylist *playlist, int from, int to, const gchar *const *keys,
+                    MafwStubItemCallback callback, gpointer userData, GDestroyNotify freeUserData) :
+        StubRequest(qMax(0, to - from + 1)),
+        playlist(playlist),
+        from(from),
+        to(to),
+        filter(keys),
+        callback(callback),
+        userData(userData),
+        freeUserData(freeUserData)
+    {
+    }
+
+protected:
+    void run()
+    {
+        for (int i = from; i <= to && i < playlist->items.size() && !cancelled; i++) {
+            const QByteArray objectId = playlist->items.at(i);
+            GHashTable *metadata = trackMetadata(objectId, filter);
+            callback(playlist, i, objectId.constData(), metadata, userData);
+            mafw_metadata_release(metadata);
+        }
+    }
+
+    void release()
+    {
+        if (freeUserData)
+            freeUserData(userData);
+    }
+
+private:
+    MafwPlaylist *playlist;
+    int from;
+    int to;
+    KeyFilter filter;
+    MafwStubItemCallback callback;
+    gpointer userData;
+    GDestroyNotify freeUserData;
+};
+
+static QHash<guint, StubRequest*> browseRequests;
+static guint lastBrowseId = 0;
+
+class BrowseRequest : public StubRequest
+{
+public:
+    BrowseRequest(MafwSource *source, guint browseId, const gchar *const *keys, int first, int last,
+                  MafwStubBrowseCallback callback, gpointer userData) :
+        StubRequest(qMax(0, last - first)),
+        source(source),
+        browseId(browseId),
+        first(first),
+        last(last),
+        filter(keys),
+        callback(callback),
+        userData(userData)
+    {
+        browseRequests.insert(browseId, this);
+    }
+
+    ~BrowseRequest()
+    {
+        browseRequests.remove(browseId);
+    }
+
+protected:
+    void run()
+    {
+        if (first >= last) {
+            callback(source, browseId, 0, 0, NULL, NULL, userData, NULL);
+            return;
+        }
+
+        for (int i = first; i < last && !cancelled; i++) {
+            const QByteArray objectId = MafwStub::trackId(i);
+            GHashTable *metadata = trackMetadata(objectId, filter);
+            callback(source, browseId, last - i - 1, i - first, objectId.constData(), metadata, userData, NULL);
+            mafw_metadata_release(metadata);
+        }
+    }
+
+private:
+    MafwSource *source;
+    guint browseId;
+    int first;
+    int last;
+    KeyFilter filter;
+    MafwStubBrowseCallback callback;
+    gpointer userData;
+};
+
+class MetadataRequest : public StubRequest
+{
+public:
+    MetadataRequest(MafwSource *source, const QByteArray &objectId, const gchar *const *keys,
+                    MafwStubMetadataCallback callback, gpointer userData) :
+        StubRequest(1),
+        source(source),
+        objectId(objectId),
+        filter(keys),
+        callback(callback),
+        userData(userData)
+    {
+    }
+
+protected:
+    void run()
+    {
+        GHashTable *metadata = trackMetadata(objectId, filter);
+        callback(source, objectId.constData(), metadata, userData, NULL);
+        mafw_metadata_release(metadata);
+    }
+
+private:
+    MafwSource *source;
+    QByteArray objectId;
+    KeyFilter filter;
+    MafwStubMetadataCallback callback;
+    gpointer userData;
+};
+
+//--- MafwStub -----------------------------------------------------------------
+
+int MafwStub::playlistSize()
+{
+    return stubPlaylistSize;
+}
+
+void MafwStub::setPlaylistSize(int size)
+{
+    stubPlaylistSize = qMax(0, size);
+}
+
+int MafwStub::latency()
+{
+    return stubLatency;
+}
+
+void MafwStub::setLatency(int msecs)
+{
+    stubLatency = qMax(0, msecs);
+}
+
+int MafwStub::itemLatency()
+{
+    return stubItemLatency;
+}
+
+void MafwStub::setItemLatency(int usecs)
+{
+    stubItemLatency = qMax(0, usecs);
+}
+
+// returns the playlist with the given name, creating it if necessary
+MafwPlaylist* MafwStub::playlist(const QByteArray &name)
+{
+    foreach (MafwPlaylist *playlist, stubPlaylists)
+        if (playlist->name == name)
+            return playlist;
+
+    MafwPlaylist *playlist = new MafwPlaylist;
+    playlist->name = name;
+    playlist->repeat = false;
+    playlist->shuffled = false;
+
+    if (name == "FmpAudioPlaylist") {
+        playlist->items.reserve(stubPlaylistSize);
+
+        for (int i = 0; i < stubPlaylistSize; i++)
+            playlist->items.append(trackId(i));
+    }
+
+    stubPlaylists.append(playlist);
+    return playlist;
+}
+
+QList<MafwPlaylist*> MafwStub::playlists()
+{
+    return stubPlaylists;
+}
+
+void MafwStub::destroyPlaylist(MafwPlaylist *playlist)
+{
+    if (stubPlaylists.removeOne(playlist))
+        delete playlist;
+}
+
+QByteArray MafwStub::trackId(int index)
+{
+    return TRACK_PREFIX + QByteArray::number(index) + TRACK_SUFFIX;
+}
+
+GHashTable* MafwStub::metadata(const QByteArray &objectId, const gchar *const *keys)
+{
+    return trackMetadata(objectId, KeyFilter(keys));
+}
+
+// to is inclusive, and -1 means the end of the playlist
+gpointer MafwStub::getItems(MafwPlaylist *playlist, int from, int to, const gchar *const *keys,
+                            MafwStubItemCallback callback, gpointer userData, GDestroyNotify freeUserData)
+{
+    if (to < 0 || to >= playlist->items.size())
+        to = playlist->items.size() - 1;
+
+    return new GetItemsRequest(playlist, from, to, keys, callback, userData, freeUserData);
+}
+
+// browsing any container lists the generated tracks
+guint MafwStub::browse(MafwSource *source, const gchar *const *keys, uint skipCount, uint itemCount,
+                       MafwStubBrowseCallback callback, gpointer userData)
+{
+    const int first = qMin<uint>(skipCount, stubPlaylistSize);
+    const int last = itemCount ? qMin<uint>(skipCount + itemCount, stubPlaylistSize) : stubPlaylistSize;
+
+    new BrowseRequest(source, ++lastBrowseId, keys, first, last, callback, userData);
+    return lastBrowseId;
+}
+
+bool MafwStub::cancelBrowse(guint browseId)
+{
+    StubRequest *request = browseRequests.take(browseId);
+
+    if (!request)
+        return false;
+
+    request->cancel();
+    return true;
+}
+
+void MafwStub::getMetadata(MafwSource *source, const QByteArray &objectId, const gchar *const *keys,
+                           MafwStubMetadataCallback callback, gpointer userData)
+{
+    new MetadataRequest(source, objectId, keys, callback, userData);
+}
+
+//--- C API --------------------------------------------------------------------
+
+GHashTable* mafw_metadata_new(void)
+{
+    return g_hash_table_new_full(g_str_hash, g_str_equal, g_free, freeValue);
+}
+
+void mafw_metadata_add_str(GHashTable *metadata, const gchar *key, gchar *value)
+{
+    GValue *v = newValue(G_TYPE_STRING);
+    g_value_set_string(v, value);
+    g_hash_table_replace(metadata, g_strdup(key), v);
+}
+
+GValue* mafw_metadata_first(GHashTable *metadata, const gchar *key)
+{
+    return metadata ? static_cast<GValue*>(g_hash_table_lookup(metadata, key)) : NULL;
+}
+
+void mafw_metadata_release(GHashTable *metadata)
+{
+    if (metadata)
+        g_hash_table_unref(metadata);
+}
+
+gchar* mafw_source_create_objectid(const gchar *uri)
+{
+    return g_strconcat("urisource::", uri, NULL);
+}
+
+gchar** mafw_playlist_get_items(MafwPlaylist *playlist, guint from, guint to, GError **)
+{
+    if (!playlist || from >= guint(playlist->items.size()) || to < from)
+        return NULL;
+
+    to = qMin<guint>(to, playlist->items.size() - 1);
+
+    gchar **ids = g_new(gchar*, to - from + 2);
+
+    for (guint i = from; i <= to; i++)
+        ids[i - from] = g_strdup(playlist->items.at(i).constData());
+
+    ids[to - from + 1] = NULL;
+    return ids;
+}
+
+void mafw_playlist_cancel_get_items_md(gpointer op)
+{
+    if (op)
+        static_cast<StubRequest*>(op)->cancel();
+}
+
+void mafw_log_init(const gchar *)
+{
+}
+
+const char* gnome_vfs_get_mime_type_for_name(const char *filename)
+{
+    static const char* const TYPES[][2] = {
+        { ".mp3", "audio/mpeg" },
+        { ".ogg", "audio/ogg" },
+        { ".wav", "audio/x-wav" },
+        { ".flac", "audio/flac" },
+        { ".m4a", "audio/mp4" },
+        { ".aac", "audio/aac" },
+        { ".wma", "audio/x-ms-wma" },
+        { ".avi", "video/x-msvideo" },
+        { ".mp4", "video/mp4" },
+        { ".mkv", "video/x-matroska" },
+        { ".wmv", "video/x-ms-wmv" },
+        { ".3gp", "video/3gpp" },
+        { ".mov", "video/quicktime" }
+    };
+
+    const char *extension = filename ? strrchr(filename, '.') : NULL;
+
+    if (extension)
+        for (uint i = 0; i < sizeof(TYPES) / sizeof(TYPES[0]); i++)
+            if (g_ascii_strcasecmp(extension, TYPES[i][0]) == 0)
+                return TYPES[i][1];
+
+    return "application/octet-stream";
+}
@@ -0,0 +1,55 @@
+#ifndef MAFWSTUB_H
+#define MAFWSTUB_H
+
+#include <QByteArray>
+#include <QList>
+#include <libmafw/mafw.h>
+
+struct _MafwPlaylist
+{
+    QByteArray name;
+    QList<QByteArray> items;
+    bool repeat;
+    bool shuffled;
+};
+
+typedef void (*MafwStubItemCallback)(MafwPlaylist *playlist, guint index, const char *objectId, GHashTable *metadata, gpointer userData);
+typedef void (*MafwStubBrowseCallback)(MafwSource *source, guint browseId, gint remainingCount, guint index, const gchar *objectId, GHashTable *metadata, gpointer userData, const GError *error);
+typedef void (*MafwStubMetadataCallback)(MafwSource *source, const gchar *objectId, GHashTable *metadata, gpointer userData, const GError *error);
+
+// Simulated MAFW backend shared by the stub adapters.
+//
+// The audio playlist and the tracker library are populated with playlistSize()
+// generated tracks, whose metadata is derived from the object id. Metadata
+// requests are answered from the event loop after latency() milliseconds plus
+// itemLatency() microseconds per item, and can be configured before the first
+// adapter is created, or with the QCH_MAFW_STUB_PLAYLIST_SIZE,
+// QCH_MAFW_STUB_LATENCY and QCH_MAFW_STUB_ITEM_LATENCY environment variables.
+// Renderer and playlist changes are applied and announced immediately.
+class MafwStub
+{
+public:
+    static int playlistSize();
+    static void setPlaylistSize(int size);
+    static int latency();
+    static void setLatency(int msecs);
+    static int itemLatency();
+    static void setItemLatency(int usecs);
+
+    static MafwPlaylist* playlist(const QByteArray &name);
+    static QList<MafwPlaylist*> playlists();
+    static void destroyPlaylist(MafwPlaylist *playlist);
+
+    static QByteArray trackId(int index);
+    static GHashTable* metadata(const QByteArray &objectId, const gchar *const *keys);
+
+    static gpointer getItems(MafwPlaylist *playlist, int from, int to, const gchar *const *keys,
+                             MafwStubItemCallback callback, gpointer userData, GDestroyNotify freeUserData);
+    static guint browse(MafwSource *source, const gchar *const *keys, uint skipCount, uint itemCount,
+                        MafwStubBrowseCallback callback, gpointer userData);
+    static bool cancelBrowse(guint browseId);
+    static void getMetadata(MafwSource *source, const QByteArray &objectId, const gchar *const *keys,
+                            MafwStubMetadataCallback callback, gpointer userData);
+};
+
+#endif // MAFWSTUB_H
@@ -0,0 +1,21 @@
+# Simulated MAFW backend for builds configured with CONFIG+=mafw_stub. It takes
+# the place of libmafw, libplayback, gnome-vfs and libgq-gconf, so that the
+# adapters and the models built on them can run on a desktop Linux system.
+
+CONFIG += link_pkgconfig
+PKGCONFIG += glib-2.0 gobject-2.0
+
+INCLUDEPATH += $$PWD/include
+
+HEADERS += \
+    $$PWD/gconfitem.h \
+    $$PWD/mafwstub.h
+
+SOURCES += \
+    $$PWD/gconfitem.cpp \
+    $$PWD/mafwstub.cpp \
+    $$PWD/mafwplaylistadapter.cpp \
+    $$PWD/mafwplaylistmanageradapter.cpp \
+    $$PWD/mafwregistryadapter.cpp \
+    $$PWD/mafwrendereradapter.cpp \
+    $$PWD/mafwsourceadapter.cpp
@@ -0,0 +1,58 @@
+#include "mediaobjectid.h"
+#include <libgnomevfs/gnome-vfs-mime-utils.h>
+#include <libmafw/mafw-source.h>
+
+QHash<QString, bool> MediaObjectId::videoExtensions;
+
+QString MediaObjectId::fromUri(const QString &uri)
+{
+    return QString::fromUtf8(convert(uri));
+}
+
+QList<QByteArray> MediaObjectId::fromUris(const QStringList &uris)
+{
+    QList<QByteArray> ids;
+    ids.reserve(uris.size());
+
+    foreach (const QString &uri, uris)
+        ids.append(convert(uri));
+
+    return ids;
+}
+
+QByteArray MediaObjectId::convert(QString uri)
+{
+    if (uri.startsWith("/"))
+        uri.prepend("file://");
+
+    gchar *id = mafw_source_create_objectid(uri.toUtf8());
+    QString objectId = QString::fromUtf8(id);
+    g_free(id);
+
+    if (uri.startsWith("file://")) {
+        objectId = objectId.remove(0, 18) // "urisource::file://"
+                           .replace("/", "%2F")
+                           .prepend(QString("localtagfs::%1/").arg(isVideo(uri) ? "videos" : "music/songs"));
+    }
+
+    return objectId.toUtf8();
+}
+
+bool MediaObjectId::isVideo(const QString &uri)
+{
+    const int slash = uri.lastIndexOf('/');
+    const int dot = uri.lastIndexOf('.');
+    const QString extension = dot > slash ? uri.mid(dot + 1).toLower() : QString();
+    QHash<QString, bool>::const_iterator iterator = videoExtensions.constFind(extension);
+
+    if (iterator != videoExtensions.constEnd())
+        return iterator.value();
+
+    const bool video = QByteArray(gnome_vfs_get_mime_type_for_name(uri.toUtf8())).startsWith("video");
+
+    // Files without an extension are detected by name each time
+    if (!extension.isEmpty())
+        videoExtensions.insert(extension, video);
+
+    return video;
+}
@@ -0,0 +1,26 @@
+#ifndef MEDIAOBJECTID_P_H
+#define MEDIAOBJECTID_P_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// Converts URIs to MAFW object ids. Local files are mapped to their tracker
+// (localtagfs) ids, using a MIME type lookup that is cached by file extension.
+class MediaObjectId
+{
+
+public:
+    static QString fromUri(const QString &uri);
+    static QList<QByteArray> fromUris(const QStringList &uris);
+
+private:
+    static QByteArray convert(QString uri);
+    static bool isVideo(const QString &uri);
+
+    static QHash<QString, bool> videoExtensions;
+};
+
+#endif // MEDIAOBJECTID_P_H
@@ -0,0 +1,243 @@
+#include "metadatacache.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QVector>
+#include <QtAlgorithms>
+#include <stdio.h>
+#include <string.h>
+
+#define CACHE_MAGIC 0x514d4331 // "QMC1", also detects a byte order mismatch
+#define CACHE_VERSION 1
+#define HEADER_SIZE 16
+#define RECORD_HEADER_SIZE 16
+
+static inline uint align(uint size)
+{
+    return (size + 3) & ~3;
+}
+
+static inline quint32 readUInt(const uchar *data)
+{
+    quint32 value;
+    memcpy(&value, data, sizeof(quint32));
+    return value;
+}
+
+static inline void appendUInt(QByteArray &buffer, quint32 value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(quint32));
+}
+
+struct MetadataCacheRecord
+{
+    QString id;
+    uint lastUsed;
+};
+
+static bool recordLessThan(const MetadataCacheRecord &a, const MetadataCacheRecord &b)
+{
+    return a.lastUsed > b.lastUsed;
+}
+
+MetadataCache::MetadataCache(const QString &fileName, int maximumSize) :
+    file(fileName),
+    map(0),
+    clock(0),
+    maximumSize(maximumSize),
+    modified(false)
+{
+    load();
+}
+
+MetadataCache::~MetadataCache()
+{
+    save();
+    unload();
+}
+
+// returns the cached data for id, or an empty array if there is none
+QByteArray MetadataCache::value(const QString &id, uint *timestamp)
+{
+    QHash<QString, Entry>::iterator iterator = entries.find(id);
+
+    if (iterator == entries.end())
+        return QByteArray();
+
+    iterator.value().lastUsed = ++clock;
+    // the access order decides eviction, so it has to be saved as well
+    modified = true;
+
+    if (timestamp)
+        *timestamp = iterator.value().timestamp;
+
+    return entryData(iterator.value());
+}
+
+void MetadataCache::insert(const QString &id, const QByteArray &data)
+{
+    Entry &entry = entries[id];
+    entry.offset = 0;
+    entry.size = data.size();
+    entry.timestamp = QDateTime::currentDateTime().toTime_t();
+    entry.lastUsed = ++clock;
+    entry.data = data;
+    modified = true;
+}
+
+void MetadataCache::remove(const QString &id)
+{
+    if (entries.remove(id))
+        modified = true;
+}
+
+bool MetadataCache::isModified() const
+{
+    return modified;
+}
+
+// writes the cache back to disk, most recently used records first, until the maximum size is reached
+bool MetadataCache::save()
+{
+    if (!modified)
+        return true;
+
+    QVector<MetadataCacheRecord> records;
+    records.reserve(entries.size());
+
+    QHashIterator<QString, Entry> iterator(entries);
+
+    while (iterator.hasNext()) {
+        iterator.next();
+        MetadataCacheRecord record;
+        record.id = iterator.key();
+        record.lastUsed = iterator.value().lastUsed;
+        records.append(record);
+    }
+
+    qSort(records.begin(), records.end(), recordLessThan);
+
+    QByteArray buffer;
+    int count = 0;
+
+    foreach (const MetadataCacheRecord &record, records) {
+        const Entry &entry = entries[record.id];
+        const QByteArray id = record.id.toUtf8();
+        const int size = RECORD_HEADER_SIZE + align(id.size()) + align(entry.size);
+
+        if (HEADER_SIZE + buffer.size() + size > maximumSize)
+            break;
+
+        appendUInt(buffer, id.size());
+        appendUInt(buffer, entry.size);
+        appendUInt(buffer, entry.timestamp);
+        appendUInt(buffer, entry.lastUsed);
+        buffer.append(id);
+        buffer.append(QByteArray(align(id.size()) - id.size(), '\0'));
+        buffer.append(entryData(entry));
+        buffer.append(QByteArray(align(entry.size) - entry.size, '\0'));
+        ++count;
+    }
+
+    QByteArray header;
+    appendUInt(header, CACHE_MAGIC);
+    appendUInt(header, CACHE_VERSION);
+    appendUInt(header, count);
+    appendUInt(header, clock);
+
+    const QString fileName = file.fileName();
+    const QString tempFileName = fileName + ".tmp";
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QFile temp(tempFileName);
+
+    if (!temp.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+
+    const bool written = (temp.write(header) == header.size()) && (temp.write(buffer) == buffer.size());
+    temp.close();
+
+    if (!written) {
+        temp.remove();
+        return false;
+    }
+
+    // the records to keep are all in the new file, so the index is rebuilt from it
+    unload();
+
+    // replace the old file atomically, so that other readers never see a partial cache
+    if (rename(QFile::encodeName(tempFileName).constData(), QFile::encodeName(fileName).constData()) != 0) {
+        temp.remove();
+        load();
+        return false;
+    }
+
+    return load();
+}
+
+bool MetadataCache::load()
+{
+    unload();
+
+    if (!file.open(QFile::ReadOnly))
+        return false;
+
+    const qint64 size = file.size();
+
+    if (size < HEADER_SIZE || (map = file.map(0, size)) == 0) {
+        file.close();
+        return false;
+    }
+
+    if (readUInt(map) != CACHE_MAGIC || readUInt(map + 4) != CACHE_VERSION) {
+        unload();
+        return false;
+    }
+
+    const uint count = readUInt(map + 8);
+    clock = readUInt(map + 12);
+    entries.reserve(count);
+    qint64 offset = HEADER_SIZE;
+
+    for (uint i = 0; i < count; i++) {
+        if (offset + RECORD_HEADER_SIZE > size)
+            break;
+
+        const uint idSize = readUInt(map + offset);
+        const uint dataSize = readUInt(map + offset + 4);
+        const qint64 dataOffset = offset + RECORD_HEADER_SIZE + align(idSize);
+
+        if (dataOffset + dataSize > size)
+            break;
+
+        Entry entry;
+        entry.offset = dataOffset;
+        entry.size = dataSize;
+        entry.timestamp = readUInt(map + offset + 8);
+        entry.lastUsed = readUInt(map + offset + 12);
+        entries.insert(QString::fromUtf8(reinterpret_cast<const char*>(map) + offset + RECORD_HEADER_SIZE, idSize),
+                       entry);
+        offset = dataOffset + align(dataSize);
+    }
+
+    modified = false;
+    return true;
+}
+
+void MetadataCache::unload()
+{
+    if (map) {
+        file.unmap(map);
+        map = 0;
+    }
+
+    file.close();
+    entries.clear();
+}
+
+QByteArray MetadataCache::entryData(const Entry &entry) const
+{
+    if (entry.offset && map)
+        return QByteArray(reinterpret_cast<const char*>(map) + entry.offset, entry.size);
+
+    return entry.data;
+}
@@ -0,0 +1,55 @@
+#ifndef METADATACACHE_P_H
+#define METADATACACHE_P_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+
+// Persistent store of serialized playlist item metadata, keyed by MAFW object id.
+// The cache file is memory-mapped on load and only the index is built up front,
+// records are copied out on lookup. Least recently used records are evicted
+// when the file is written back and would exceed the maximum size.
+class MetadataCache
+{
+
+public:
+    explicit MetadataCache(const QString &fileName, int maximumSize = 8 * 1024 * 1024);
+    ~MetadataCache();
+
+    QByteArray value(const QString &id, uint *timestamp = 0);
+    void insert(const QString &id, const QByteArray &data);
+    void remove(const QString &id);
+
+    bool isModified() const;
+
+    bool save();
+
+private:
+    struct Entry
+    {
+        Entry() : offset(0), size(0), timestamp(0), lastUsed(0) {}
+
+        uint offset;
+        uint size;
+        uint timestamp;
+        uint lastUsed;
+        QByteArray data;
+    };
+
+    bool load();
+    void unload();
+
+    QByteArray entryData(const Entry &entry) const;
+
+    QFile file;
+    uchar *map;
+
+    QHash<QString, Entry> entries;
+
+    uint clock;
+    int maximumSize;
+    bool modified;
+};
+
+#endif // METADATACACHE_P_H
@@ -1,6 +1,44 @@
 #include "metadatawatcher.h"
 #include <QImage>
 #include <QCryptographicHash>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
+
+// The MAFW metadata key of each MetadataWatcher::Field
+static const char* const FIELD_KEYS[] = {
+    MAFW_METADATA_KEY_ALBUM,
+    MAFW_METADATA_KEY_ARTIST,
+    MAFW_METADATA_KEY_AUDIO_BITRATE,
+    MAFW_METADATA_KEY_AUDIO_CODEC,
+    MAFW_METADATA_KEY_COMMENT,
+    MAFW_METADATA_KEY_COMPOSER,
+    MAFW_METADATA_KEY_COPYRIGHT,
+    MAFW_METADATA_KEY_RENDERER_ART_URI,
+    MAFW_METADATA_KEY_MODIFIED,
+    MAFW_METADATA_KEY_DESCRIPTION,
+    MAFW_METADATA_KEY_DURATION,
+    MAFW_METADATA_KEY_GENRE,
+    MAFW_METADATA_KEY_IS_SEEKABLE,
+    MAFW_METADATA_KEY_TAGS,
+    MAFW_METADATA_KEY_LAST_PLAYED,
+    MAFW_METADATA_KEY_PAUSED_THUMBNAIL_URI,
+    MAFW_METADATA_KEY_LYRICS,
+    MAFW_METADATA_KEY_MIME,
+    MAFW_METADATA_KEY_ORGANIZATION,
+    MAFW_METADATA_KEY_PLAY_COUNT,
+    MAFW_METADATA_KEY_RES_X,
+    MAFW_METADATA_KEY_RES_Y,
+    MAFW_METADATA_KEY_PAUSED_POSITION,
+    MAFW_METADATA_KEY_FILESIZE,
+    MAFW_METADATA_KEY_THUMBNAIL_URI,
+    MAFW_METADATA_KEY_TITLE,
+    MAFW_METADATA_KEY_TRACK,
+    MAFW_METADATA_KEY_URI,
+    MAFW_METADATA_KEY_VIDEO_BITRATE,
+    MAFW_METADATA_KEY_VIDEO_CODEC,
+    MAFW_METADATA_KEY_VIDEO_FRAMERATE,
+    MAFW_METADATA_KEY_YEAR
+};
 
 MetadataWatcher* MetadataWatcher::instance = NULL;
 
@@ -15,6 +53,9 @@ MetadataWatcher::MetadataWatcher() :
     mafwRenderer(mafwRegistry->renderer()),
     mafwSource(new MafwSourceAdapter(NULL)),
     mafwTrackerSource(mafwRegistry->source(MafwRegistryAdapter::Tracker)),
+    changedFields(0),
+    otherMetadataChanged(false),
+    changeNotificationPending(false),
     sourceMetadataPresent(false)
 {
     // Initialization
@@ -37,138 +78,157 @@ MetadataWatcher::MetadataWatcher() :
 
 QString MetadataWatcher::albumTitle() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_ALBUM).toString();
+    return currentMetadata[AlbumTitleField].toString();
 }
 
 QString MetadataWatcher::artist() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_ARTIST).toString();
+    return currentMetadata[ArtistField].toString();
 }
 
 int MetadataWatcher::audioBitRate() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_AUDIO_BITRATE).toInt();
+    return currentMetadata[AudioBitRateField].toInt();
 }
 
 QString MetadataWatcher::audioCodec() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_AUDIO_CODEC).toString();
+    return currentMetadata[AudioCodecField].toString();
 }
 
 QString MetadataWatcher::comment() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_COMMENT).toString();
+    return currentMetadata[CommentField].toString();
 }
 
 QString MetadataWatcher::composer() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_COMPOSER).toString();
+    return currentMetadata[ComposerField].toString();
 }
 
 QString MetadataWatcher::copyright() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_COPYRIGHT).toString();
+    return currentMetadata[CopyrightField].toString();
 }
 
 QString MetadataWatcher::coverArtUrl() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_RENDERER_ART_URI).toString();
+    return currentMetadata[CoverArtUrlField].toString();
 }
 
 qint64 MetadataWatcher::date() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_MODIFIED).toLongLong();
+    return currentMetadata[DateField].toLongLong();
 }
 
 QString MetadataWatcher::description() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_DESCRIPTION).toString();
+    return currentMetadata[DescriptionField].toString();
+}
+
+int MetadataWatcher::duration() const
+{
+    return currentMetadata[DurationField].toInt();
 }
 
 QString MetadataWatcher::genre() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_GENRE).toString();
+    return currentMetadata[GenreField].toString();
+}
+
+QStringList MetadataWatcher::keywords() const
+{
+    return currentMetadata[KeywordsField].toString().split(",", QString::SkipEmptyParts);
 }
 
 qint64 MetadataWatcher::lastPlayed() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_LAST_PLAYED).toLongLong();
+    return currentMetadata[LastPlayedField].toLongLong();
 }
 
 QString MetadataWatcher::lastThumbnailUrl() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_PAUSED_THUMBNAIL_URI).toString();
+    return currentMetadata[LastThumbnailUrlField].toString();
 }
 
 QString MetadataWatcher::lyrics() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_LYRICS).toString();
+    return currentMetadata[LyricsField].toString();
 }
 
 QString MetadataWatcher::mimeType() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_MIME).toString();
+    return currentMetadata[MimeTypeField].toString();
 }
 
 QString MetadataWatcher::organization() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_ORGANIZATION).toString();
+    return currentMetadata[OrganizationField].toString();
 }
 
 int MetadataWatcher::playCount() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_PLAY_COUNT).toInt();
+    return currentMetadata[PlayCountField].toInt();
 }
 
 QSize MetadataWatcher::resolution() const
 {
-    return QSize(currentMetadata.value(MAFW_METADATA_KEY_RES_X).toInt(),
-                 currentMetadata.value(MAFW_METADATA_KEY_RES_Y).toInt());
+    return QSize(currentMetadata[ResXField].toInt(), currentMetadata[ResYField].toInt());
 }
 
 int MetadataWatcher::resumePosition() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_PAUSED_POSITION).toInt();
+    return currentMetadata[ResumePositionField].toInt();
+}
+
+bool MetadataWatcher::isSeekable() const
+{
+    return currentMetadata[IsSeekableField].toBool();
 }
 
 int MetadataWatcher::size() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_FILESIZE).toInt();
+    return currentMetadata[SizeField].toInt();
 }
 
 QString MetadataWatcher::thumbnailUrl() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_THUMBNAIL_URI).toString();
+    return currentMetadata[ThumbnailUrlField].toString();
 }
 
 QString MetadataWatcher::title() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_TITLE).toString();
+    return currentMetadata[TitleField].toString();
 }
 
 int MetadataWatcher::trackNumber() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_TRACK).toInt();
+    return currentMetadata[TrackNumberField].toInt();
+}
+
+QString MetadataWatcher::url() const
+{
+    return currentMetadata[UrlField].toString();
 }
 
 int MetadataWatcher::videoBitRate() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_VIDEO_BITRATE).toInt();
+    return currentMetadata[VideoBitRateField].toInt();
 }
 
 QString MetadataWatcher::videoCodec() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_VIDEO_CODEC).toString();
+    return currentMetadata[VideoCodecField].toString();
 }
 
 qreal MetadataWatcher::videoFrameRate() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_VIDEO_FRAMERATE).toDouble();
+    return currentMetadata[VideoFrameRateField].toDouble();
 }
 
 int MetadataWatcher::year() const
 {
-    return currentMetadata.value(MAFW_METADATA_KEY_YEAR).toInt();
+    return currentMetadata[YearField].toInt();
 }
 
 MafwSourceAdapter* MetadataWatcher::currentSource() const
@@ -178,65 +238,227 @@ MafwSourceAdapter* MetadataWatcher::currentSource() const
 
 QMap<QString,QVariant> MetadataWatcher::metadata() const
 {
-    return currentMetadata;
+    QMap<QString,QVariant> map = currentOtherMetadata;
+
+    for (int i = 0; i < FieldCount; i++)
+        if (!currentMetadata[i].isNull())
+            map.insert(FIELD_KEYS[i], currentMetadata[i]);
+
+    return map;
+}
+
+MetadataWatcher::Field MetadataWatcher::fieldForKey(const QString &key)
+{
+    static QHash<QString,int> fields;
+
+    if (fields.isEmpty())
+        for (int i = 0; i < FieldCount; i++)
+            fields.insert(QString::fromLatin1(FIELD_KEYS[i]), i);
+
+    return static_cast<Field>(fields.value(key, UnknownField));
+}
+
+QVariant& MetadataWatcher::currentValue(Field field, const QString &key)
+{
+    return field == UnknownField ? currentOtherMetadata[key] : currentMetadata[field];
+}
+
+QVariant& MetadataWatcher::backupValue(Field field, const QString &key)
+{
+    return field == UnknownField ? backupOtherMetadata[key] : backupMetadata[field];
+}
+
+void MetadataWatcher::setCurrentValue(Field field, const QString &key, const QVariant &value)
+{
+    QVariant &current = currentValue(field, key);
+    if (current != value) {
+        current = value;
+        markChanged(field);
+    }
+}
+
+void MetadataWatcher::clearCurrentMetadata()
+{
+    for (int i = 0; i < FieldCount; i++) {
+        if (!currentMetadata[i].isNull()) {
+            currentMetadata[i] = QVariant();
+            markChanged(static_cast<Field>(i));
+        }
+    }
+
+    if (!currentOtherMetadata.isEmpty()) {
+        currentOtherMetadata.clear();
+        markChanged(UnknownField);
+    }
+}
+
+void MetadataWatcher::clearBackupMetadata()
+{
+    for (int i = 0; i < FieldCount; i++)
+        backupMetadata[i] = QVariant();
+
+    backupOtherMetadata.clear();
+}
+
+void MetadataWatcher::restoreBackupMetadata()
+{
+    for (int i = 0; i < FieldCount; i++) {
+        if (currentMetadata[i] != backupMetadata[i]) {
+            currentMetadata[i] = backupMetadata[i];
+            markChanged(static_cast<Field>(i));
+        }
+    }
+
+    if (currentOtherMetadata != backupOtherMetadata) {
+        currentOtherMetadata = backupOtherMetadata;
+        markChanged(UnknownField);
+    }
+
+    clearBackupMetadata();
+}
+
+// Changes are collected and announced from the event loop, so that a burst of
+// metadata from the renderer or source results in one signal per field.
+void MetadataWatcher::markChanged(Field field)
+{
+    if (field == UnknownField)
+        otherMetadataChanged = true;
+    else
+        changedFields |= Q_UINT64_C(1) << field;
+
+    if (!changeNotificationPending) {
+        changeNotificationPending = true;
+        QMetaObject::invokeMethod(this, "emitChanges", Qt::QueuedConnection);
+    }
+}
+
+static inline bool isChanged(quint64 fields, int field)
+{
+    return fields & (Q_UINT64_C(1) << field);
+}
+
+void MetadataWatcher::emitChanges()
+{
+    const quint64 fields = changedFields;
+    const bool other = otherMetadataChanged;
+    changedFields = 0;
+    otherMetadataChanged = false;
+    changeNotificationPending = false;
+
+    if (!fields && !other)
+        return;
+
+    if (isChanged(fields, AlbumTitleField))
+        emit albumTitleChanged();
+    if (isChanged(fields, ArtistField))
+        emit artistChanged();
+    if (isChanged(fields, AudioBitRateField))
+        emit audioBitRateChanged();
+    // The video codec is announced ahead of the audio codec so that media type
+    // detection sees it first, as onRendererMetadataReceived() expects.
+    if (isChanged(fields, VideoCodecField))
+        emit videoCodecChanged();
+    if (isChanged(fields, AudioCodecField))
+        emit audioCodecChanged();
+    if (isChanged(fields, CommentField))
+        emit commentChanged();
+    if (isChanged(fields, ComposerField))
+        emit composerChanged();
+    if (isChanged(fields, CopyrightField))
+        emit copyrightChanged();
+    if (isChanged(fields, CoverArtUrlField))
+        emit coverArtUrlChanged();
+    if (isChanged(fields, DateField))
+        emit dateChanged();
+    if (isChanged(fields, DescriptionField))
+        emit descriptionChanged();
+    if (isChanged(fields, DurationField))
+        emit durationChanged();
+    if (isChanged(fields, GenreField))
+        emit genreChanged();
+    if (isChanged(fields, IsSeekableField))
+        emit seekableChanged();
+    if (isChanged(fields, KeywordsField))
+        emit keywordsChanged();
+    if (isChanged(fields, LastPlayedField))
+        emit lastPlayedChanged();
+    if (isChanged(fields, LastThumbnailUrlField))
+        emit lastThumbnailUrlChanged();
+    if (isChanged(fields, LyricsField))
+        emit lyricsChanged();
+    if (isChanged(fields, MimeTypeField))
+        emit mimeTypeChanged();
+    if (isChanged(fields, OrganizationField))
+        emit organizationChanged();
+    if (isChanged(fields, PlayCountField))
+        emit playCountChanged();
+    if (isChanged(fields, ResXField) || isChanged(fields, ResYField))
+        emit resolutionChanged();
+    if (isChanged(fields, ResumePositionField))
+        emit resumePositionChanged();
+    if (isChanged(fields, SizeField))
+        emit sizeChanged();
+    if (isChanged(fields, ThumbnailUrlField))
+        emit thumbnailUrlChanged();
+    if (isChanged(fields, TitleField))
+        emit titleChanged();
+    if (isChanged(fields, TrackNumberField))
+        emit trackNumberChanged();
+    if (isChanged(fields, UrlField))
+        emit urlChanged();
+    if (isChanged(fields, VideoBitRateField))
+        emit videoBitRateChanged();
+    if (isChanged(fields, VideoFrameRateField))
+        emit videoFrameRateChanged();
+    if (isChanged(fields, YearField))
+        emit yearChanged();
+
+    emit metadataChanged();
 }
 
 void MetadataWatcher::setMetadataFromRenderer(QString key, QVariant value)
 {
+    const Field field = fieldForKey(key);
+
 #ifdef MAFW_WORKAROUNDS
     // The renderer misreports duration of some UPnP media, so in this case give
     // priority to the source. setMetadataFromSource() implements the remaining
     // part of this workaround.
-    if (key == MAFW_METADATA_KEY_DURATION
+    if (field == DurationField
     &&  currentObjectId.startsWith("_uuid_"))
     {
         if (sourceMetadataPresent) {
-            QVariant &currentValue = currentMetadata[key];
-            if (currentValue.isNull()) {
-                currentValue = value;
-                emit metadataChanged();
-            }
+            if (currentMetadata[field].isNull())
+                setCurrentValue(field, key, value);
         } else {
-            QVariant &backupValue = backupMetadata[key];
-            if (backupValue.isNull())
-                backupValue = value;
-
-            QVariant &currentValue = currentMetadata[key];
-            if (currentValue != value) {
-                currentValue = value;
-                emit metadataChanged();
-            }
+            if (backupMetadata[field].isNull())
+                backupMetadata[field] = value;
+
+            setCurrentValue(field, key, value);
         }
         return;
     }
 #endif
 
     if (!sourceMetadataPresent)
-        backupMetadata[key] = value;
+        backupValue(field, key) = value;
 
-    QVariant &currentValue = currentMetadata[key];
-    if (currentValue != value) {
-        currentValue = value;
-        emit metadataChanged();
-    }
+    setCurrentValue(field, key, value);
 }
 
 void MetadataWatcher::setMetadataFromSource(QString key, QVariant value)
 {
+    const Field field = fieldForKey(key);
+
 #ifdef MAFW_WORKAROUNDS
     // Source's part of the workaround described in setMetadataFromRenderer()
-    if (key == MAFW_METADATA_KEY_DURATION
+    if (field == DurationField
     &&  currentObjectId.startsWith("_uuid_"))
     {
-        if (sourceMetadataPresent) {
-            QVariant &currentValue = currentMetadata[key];
-            if (currentValue != value) {
-                currentValue = value;
-                emit metadataChanged();
-            }
-        } else {
-            backupMetadata[key] = value;
-        }
+        if (sourceMetadataPresent)
+            setCurrentValue(field, key, value);
+        else
+            backupMetadata[field] = value;
         return;
     }
 #endif
@@ -244,15 +466,12 @@ void MetadataWatcher::setMetadataFromSource(QString key, QVariant value)
     if (sourceMetadataPresent) {
         // Consider source metadata less important than renderer metadata,
         // that is do not overwrite it.
-        QVariant &currentValue = currentMetadata[key];
-        if (currentValue.isNull()) {
-            currentValue = value;
-            emit metadataChanged();
-        }
+        if (currentValue(field, key).isNull())
+            setCurrentValue(field, key, value);
     } else {
-        QVariant &backupValue = backupMetadata[key];
-        if (backupValue.isNull())
-            backupValue = value;
+        QVariant &backup = backupValue(field, key);
+        if (backup.isNull())
+            backup = value;
     }
 }
 
@@ -270,18 +489,16 @@ void MetadataWatcher::onMediaChanged(int, char *objectId)
 {
     currentObjectId = QString::fromUtf8(objectId);
 
-    backupMetadata.clear();
+    clearBackupMetadata();
     sourceMetadataPresent = false;
     
     if (currentObjectId.isEmpty()) {
-        currentMetadata.clear();
-        emit metadataChanged();
+        clearCurrentMetadata();
         return;
     }
 
     // Reset the URI as soon as possible to avoid album art misdetection
-    if (currentMetadata.remove(MAFW_METADATA_KEY_URI))
-        emit metadataChanged();
+    setCurrentValue(UrlField, MAFW_METADATA_KEY_URI, QVariant());
 
     mafwRenderer->getCurrentMetadata();
 
@@ -335,15 +552,10 @@ void MetadataWatcher::onSourceMetadataReceived(QString objectId, GHashTable *met
             if (pausedPosition < 0)
                 pausedPosition = 0;
 
-            if (sourceMetadataPresent) {
-                QVariant &currentValue = currentMetadata[keyName];
-                if (currentValue != pausedPosition) {
-                    currentValue = pausedPosition;
-                    emit metadataChanged();
-                }
-            } else {
-                backupMetadata[keyName] = pausedPosition;
-            }
+            if (sourceMetadataPresent)
+                setCurrentValue(ResumePositionField, keyName, pausedPosition);
+            else
+                backupMetadata[ResumePositionField] = pausedPosition;
         }
         // Only one piece of cover art can be shown at a given time, so both
         // source- and renderer-provided images can be stored under the same
@@ -374,15 +586,12 @@ void MetadataWatcher::onSourceMetadataReceived(QString objectId, GHashTable *met
     if (!sourceMetadataPresent) {
         // The video window should always receive a position to resume from to
         // work properly.
-        if (backupMetadata.value(MAFW_METADATA_KEY_PAUSED_POSITION).isNull())
-            backupMetadata[MAFW_METADATA_KEY_PAUSED_POSITION] = 0;
+        if (backupMetadata[ResumePositionField].isNull())
+            backupMetadata[ResumePositionField] = 0;
 
-        currentMetadata = backupMetadata;
-        backupMetadata.clear();
+        restoreBackupMetadata();
 
         sourceMetadataPresent = true;
-
-        emit metadataChanged();
     }
 }
 
@@ -425,29 +634,8 @@ void MetadataWatcher::onRendererMetadataChanged(QString metadata, QVariant value
         // Update video thumbnail
         if (metadata == MAFW_METADATA_KEY_PAUSED_THUMBNAIL_URI && currentObjectId.startsWith("localtagfs::videos")) {
             QString thumbFile = value.toString();
-            if (thumbFile.contains("mafw-gst-renderer-")) {
-                QImage thumbnail(thumbFile);
-                if (thumbnail.width() > thumbnail.height()) {
-                    // Horizontal, fill height
-                    thumbnail = thumbnail.scaledToHeight(124, Qt::SmoothTransformation);
-                    thumbnail = thumbnail.copy((thumbnail.width()-124)/2, 0, 124, 124);
-                } else {
-                    // Vertical, fill width
-                    thumbnail = thumbnail.scaledToWidth(124, Qt::SmoothTransformation);
-                    thumbnail = thumbnail.copy(0, (thumbnail.height()-124)/2, 124, 124);
-                }
-
-                thumbFile = "/home/user/.fmp_pause_thumbnail/"
-                        + QCryptographicHash::hash(currentObjectId.toUtf8(), QCryptographicHash::Md5).toHex()
-                        + ".jpeg";
-
-                thumbnail.save(thumbFile, "JPEG");
-
-                GHashTable* metadata = mafw_metadata_new();
-                mafw_metadata_add_str(metadata, MAFW_METADATA_KEY_PAUSED_THUMBNAIL_URI, qstrdup(thumbFile.toUtf8()));
-                mafwTrackerSource->setMetadata(currentObjectId, metadata);
-                mafw_metadata_release(metadata);
-            }
+            if (thumbFile.contains("mafw-gst-renderer-"))
+                generatePauseThumbnail(currentObjectId, thumbFile);
 
             // It is not necessary to inform VideosWindow directly about the change,
             // because it should receive the notification from MAFW, although that
@@ -456,6 +644,64 @@ void MetadataWatcher::onRendererMetadataChanged(QString metadata, QVariant value
     }
 }
 
+// Scales, crops and saves the paused frame. This runs in a worker thread.
+static QString createPauseThumbnail(const QString &objectId, const QString &frameFile)
+{
+    QImage thumbnail(frameFile);
+    if (thumbnail.isNull())
+        return QString();
+
+    if (thumbnail.width() > thumbnail.height()) {
+        // Horizontal, fill height
+        thumbnail = thumbnail.scaledToHeight(124, Qt::SmoothTransformation);
+        thumbnail = thumbnail.copy((thumbnail.width()-124)/2, 0, 124, 124);
+    } else {
+        // Vertical, fill width
+        thumbnail = thumbnail.scaledToWidth(124, Qt::SmoothTransformation);
+        thumbnail = thumbnail.copy(0, (thumbnail.height()-124)/2, 124, 124);
+    }
+
+    QString thumbFile = "/home/user/.fmp_pause_thumbnail/"
+            + QCryptographicHash::hash(objectId.toUtf8(), QCryptographicHash::Md5).toHex()
+            + ".jpeg";
+
+    return thumbnail.save(thumbFile, "JPEG") ? thumbFile : QString();
+}
+
+void MetadataWatcher::generatePauseThumbnail(const QString &objectId, const QString &frameFile)
+{
+    // Only one thumbnail is generated at a time per object. If the video is paused
+    // again meanwhile, the most recent frame is processed once the current job is done.
+    if (thumbnailJobs.contains(objectId)) {
+        queuedThumbnails[objectId] = frameFile;
+        return;
+    }
+
+    QFutureWatcher<QString> *watcher = new QFutureWatcher<QString>(this);
+    thumbnailJobs.insert(objectId, watcher);
+    connect(watcher, SIGNAL(finished()), this, SLOT(onPauseThumbnailFinished()));
+    watcher->setFuture(QtConcurrent::run(createPauseThumbnail, objectId, frameFile));
+}
+
+void MetadataWatcher::onPauseThumbnailFinished()
+{
+    QFutureWatcher<QString> *watcher = static_cast<QFutureWatcher<QString>*>(sender());
+    const QString objectId = thumbnailJobs.key(watcher);
+    const QString thumbFile = watcher->result();
+    thumbnailJobs.remove(objectId);
+    watcher->deleteLater();
+
+    if (!thumbFile.isEmpty()) {
+        GHashTable* metadata = mafw_metadata_new();
+        mafw_metadata_add_str(metadata, MAFW_METADATA_KEY_PAUSED_THUMBNAIL_URI, qstrdup(thumbFile.toUtf8()));
+        mafwTrackerSource->setMetadata(objectId, metadata);
+        mafw_metadata_release(metadata);
+    }
+
+    if (queuedThumbnails.contains(objectId))
+        generatePauseThumbnail(objectId, queuedThumbnails.take(objectId));
+}
+
 QVariant MetadataWatcher::toQVariant(GValue *v)
 {
     switch (G_VALUE_TYPE(v)) {
@@ -2,43 +2,50 @@
 #define METADATAWATCHER_P_H
 
 #include <QObject>
+#include <QHash>
 #include <QSize>
+#include <QStringList>
 
 #include "mafw/mafwregistryadapter.h"
 
+template<typename T> class QFutureWatcher;
+
 class MetadataWatcher: public QObject
 {
     Q_OBJECT
     
-    Q_PROPERTY(QString albumArtist READ artist NOTIFY metadataChanged)
-    Q_PROPERTY(QString albumTitle READ albumTitle NOTIFY metadataChanged)
-    Q_PROPERTY(QString artist READ artist NOTIFY metadataChanged)
-    Q_PROPERTY(int audioBitRate READ audioBitRate NOTIFY metadataChanged)
-    Q_PROPERTY(QString audioCodec READ audioCodec NOTIFY metadataChanged)
-    Q_PROPERTY(QString comment READ comment NOTIFY metadataChanged)
-    Q_PROPERTY(QString composer READ composer NOTIFY metadataChanged)
-    Q_PROPERTY(QString copyright READ copyright NOTIFY metadataChanged)
-    Q_PROPERTY(QString coverArtUrl READ coverArtUrl NOTIFY metadataChanged)
-    Q_PROPERTY(qint64 date READ date NOTIFY metadataChanged)
-    Q_PROPERTY(QString description READ description NOTIFY metadataChanged)
-    Q_PROPERTY(QString genre READ genre NOTIFY metadataChanged)
-    Q_PROPERTY(QStringList keywords READ keywords NOTIFY metadataChanged)
-    Q_PROPERTY(qint64 lastPlayed READ lastPlayed NOTIFY metadataChanged)
-    Q_PROPERTY(QString lastThumbnailUrl READ lastThumbnailUrl NOTIFY metadataChanged)
-    Q_PROPERTY(QString lyrics READ lyrics NOTIFY metadataChanged)
-    Q_PROPERTY(QString mimeType READ mimeType NOTIFY metadataChanged)
-    Q_PROPERTY(QString organization READ organization NOTIFY metadataChanged)
-    Q_PROPERTY(int playCount READ playCount NOTIFY metadataChanged)
-    Q_PROPERTY(QSize resolution READ resolution NOTIFY metadataChanged)
-    Q_PROPERTY(int resumePosition READ resumePosition NOTIFY metadataChanged)
-    Q_PROPERTY(int size READ size NOTIFY metadataChanged)
-    Q_PROPERTY(QString thumbnailUrl READ thumbnailUrl NOTIFY metadataChanged)
-    Q_PROPERTY(QString title READ title NOTIFY metadataChanged)
-    Q_PROPERTY(int trackNumber READ trackNumber NOTIFY metadataChanged)
-    Q_PROPERTY(int videoBitRate READ videoBitRate NOTIFY metadataChanged)
-    Q_PROPERTY(QString videoCodec READ videoCodec NOTIFY metadataChanged)
-    Q_PROPERTY(qreal videoFrameRate READ videoFrameRate NOTIFY metadataChanged)
-    Q_PROPERTY(int year READ year NOTIFY metadataChanged)
+    Q_PROPERTY(QString albumArtist READ artist NOTIFY artistChanged)
+    Q_PROPERTY(QString albumTitle READ albumTitle NOTIFY albumTitleChanged)
+    Q_PROPERTY(QString artist READ artist NOTIFY artistChanged)
+    Q_PROPERTY(int audioBitRate READ audioBitRate NOTIFY audioBitRateChanged)
+    Q_PROPERTY(QString audioCodec READ audioCodec NOTIFY audioCodecChanged)
+    Q_PROPERTY(QString comment READ comment NOTIFY commentChanged)
+    Q_PROPERTY(QString composer READ composer NOTIFY composerChanged)
+    Q_PROPERTY(QString copyright READ copyright NOTIFY copyrightChanged)
+    Q_PROPERTY(QString coverArtUrl READ coverArtUrl NOTIFY coverArtUrlChanged)
+    Q_PROPERTY(qint64 date READ date NOTIFY dateChanged)
+    Q_PROPERTY(QString description READ description NOTIFY descriptionChanged)
+    Q_PROPERTY(int duration READ duration NOTIFY durationChanged)
+    Q_PROPERTY(QString genre READ genre NOTIFY genreChanged)
+    Q_PROPERTY(QStringList keywords READ keywords NOTIFY keywordsChanged)
+    Q_PROPERTY(qint64 lastPlayed READ lastPlayed NOTIFY lastPlayedChanged)
+    Q_PROPERTY(QString lastThumbnailUrl READ lastThumbnailUrl NOTIFY lastThumbnailUrlChanged)
+    Q_PROPERTY(QString lyrics READ lyrics NOTIFY lyricsChanged)
+    Q_PROPERTY(QString mimeType READ mimeType NOTIFY mimeTypeChanged)
+    Q_PROPERTY(QString organization READ organization NOTIFY organizationChanged)
+    Q_PROPERTY(int playCount READ playCount NOTIFY playCountChanged)
+    Q_PROPERTY(QSize resolution READ resolution NOTIFY resolutionChanged)
+    Q_PROPERTY(int resumePosition READ resumePosition NOTIFY resumePositionChanged)
+    Q_PROPERTY(bool seekable READ isSeekable NOTIFY seekableChanged)
+    Q_PROPERTY(int size READ size NOTIFY sizeChanged)
+    Q_PROPERTY(QString thumbnailUrl READ thumbnailUrl NOTIFY thumbnailUrlChanged)
+    Q_PROPERTY(QString title READ title NOTIFY titleChanged)
+    Q_PROPERTY(int trackNumber READ trackNumber NOTIFY trackNumberChanged)
+    Q_PROPERTY(QString url READ url NOTIFY urlChanged)
+    Q_PROPERTY(int videoBitRate READ videoBitRate NOTIFY videoBitRateChanged)
+    Q_PROPERTY(QString videoCodec READ videoCodec NOTIFY videoCodecChanged)
+    Q_PROPERTY(qreal videoFrameRate READ videoFrameRate NOTIFY videoFrameRateChanged)
+    Q_PROPERTY(int year READ year NOTIFY yearChanged)
 
 public:
     static MetadataWatcher* acquire();
@@ -53,6 +60,7 @@ public:
     QString coverArtUrl() const;
     qint64 date() const;
     QString description() const;
+    int duration() const;
     QString genre() const;
     QStringList keywords() const;
     qint64 lastPlayed() const;
@@ -63,10 +71,12 @@ public:
     int playCount() const;
     QSize resolution() const;
     int resumePosition() const;
+    bool isSeekable() const;
     int size() const;
     QString thumbnailUrl() const;
     QString title() const;
     int trackNumber() const;
+    QString url() const;
     int videoBitRate() const;
     QString videoCodec() const;
     qreal videoFrameRate() const;
@@ -76,9 +86,79 @@ public:
     QMap<QString,QVariant> metadata() const;
 
 signals:
+    void albumTitleChanged();
+    void artistChanged();
+    void audioBitRateChanged();
+    void audioCodecChanged();
+    void commentChanged();
+    void composerChanged();
+    void copyrightChanged();
+    void coverArtUrlChanged();
+    void dateChanged();
+    void descriptionChanged();
+    void durationChanged();
+    void genreChanged();
+    void keywordsChanged();
+    void lastPlayedChanged();
+    void lastThumbnailUrlChanged();
+    void lyricsChanged();
+    void mimeTypeChanged();
+    void organizationChanged();
+    void playCountChanged();
+    void resolutionChanged();
+    void resumePositionChanged();
+    void seekableChanged();
+    void sizeChanged();
+    void thumbnailUrlChanged();
+    void titleChanged();
+    void trackNumberChanged();
+    void urlChanged();
+    void videoBitRateChanged();
+    void videoCodecChanged();
+    void videoFrameRateChanged();
+    void yearChanged();
+
+    // emitted once after each group of per-field signals
     void metadataChanged();
 
 private:
+    enum Field {
+        AlbumTitleField = 0,
+        ArtistField,
+        AudioBitRateField,
+        AudioCodecField,
+        CommentField,
+        ComposerField,
+        CopyrightField,
+        CoverArtUrlField,
+        DateField,
+        DescriptionField,
+        DurationField,
+        GenreField,
+        IsSeekableField,
+        KeywordsField,
+        LastPlayedField,
+        LastThumbnailUrlField,
+        LyricsField,
+        MimeTypeField,
+        OrganizationField,
+        PlayCountField,
+        ResXField,
+        ResYField,
+        ResumePositionField,
+        SizeField,
+        ThumbnailUrlField,
+        TitleField,
+        TrackNumberField,
+        UrlField,
+        VideoBitRateField,
+        VideoCodecField,
+        VideoFrameRateField,
+        YearField,
+        FieldCount,
+        UnknownField = -1
+    };
+
     static MetadataWatcher *instance;
     
     MafwRegistryAdapter *mafwRegistry;
@@ -86,20 +166,45 @@ private:
     MafwSourceAdapter *mafwSource;
     MafwSourceAdapter *mafwTrackerSource;
 
-    QMap<QString,QVariant> currentMetadata;
-    QMap<QString,QVariant> backupMetadata;
+    // Known keys are stored by field, anything else the backends report is kept by key
+    QVariant currentMetadata[FieldCount];
+    QVariant backupMetadata[FieldCount];
+    QMap<QString,QVariant> currentOtherMetadata;
+    QMap<QString,QVariant> backupOtherMetadata;
     QString currentObjectId;
 
+    quint64 changedFields;
+    bool otherMetadataChanged;
+    bool changeNotificationPending;
+
     bool sourceMetadataPresent;
+
+    QHash<QString, QFutureWatcher<QString>*> thumbnailJobs;
+    QHash<QString, QString> queuedThumbnails;
     
     MetadataWatcher();
 
+    static Field fieldForKey(const QString &key);
+
+    QVariant& currentValue(Field field, const QString &key);
+    QVariant& backupValue(Field field, const QString &key);
+    void setCurrentValue(Field field, const QString &key, const QVariant &value);
+    void clearCurrentMetadata();
+    void clearBackupMetadata();
+    void restoreBackupMetadata();
+    void markChanged(Field field);
+
     void setMetadataFromSource(QString key, QVariant value);
     void setMetadataFromRenderer(QString key, QVariant value);
 
+    void generatePauseThumbnail(const QString &objectId, const QString &frameFile);
+
     static QVariant toQVariant(GValue *v);
 
 private slots:
+    void emitChanges();
+    void onPauseThumbnailFinished();
+
     void onStatusReceived(MafwPlaylist *, uint index, MafwPlayState, const char *objectId, QString);
 
     void onMediaChanged(int, char *objectId);
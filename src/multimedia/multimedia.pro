@@ -1,18 +1,38 @@
 TEMPLATE = lib
-CONFIG = qt plugin
-QT += declarative dbus
 
-CONFIG += link_pkgconfig
-PKGCONFIG += mafw mafw-shared glib-2.0 libplayback-1 gnome-vfs-2.0
+# qmake CONFIG+=mafw_stub builds against a simulated MAFW backend instead of the
+# device libraries, see mafw/stub/stub.pri and benchmark/
+mafw_stub {
+    CONFIG = qt plugin mafw_stub
+} else {
+    CONFIG = qt plugin
+}
 
-LIBS += -lgq-gconf
+QT += declarative dbus
 
 DEFINES += MAFW_WORKAROUNDS
 
 TARGET = qchmultimedia
 
-INCLUDEPATH += \
-    /usr/include/gq
+mafw_stub {
+    include(mafw/stub/stub.pri)
+} else {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += mafw mafw-shared glib-2.0 libplayback-1 gnome-vfs-2.0
+
+    LIBS += -lgq-gconf
+
+    INCLUDEPATH += \
+        /usr/include/gq
+
+    SOURCES += \
+        mafw/mafwrenderersignalhelper.cpp \
+        mafw/mafwsourceadapter.cpp \
+        mafw/mafwrendereradapter.cpp \
+        mafw/mafwplaylistadapter.cpp \
+        mafw/mafwplaylistmanageradapter.cpp \
+        mafw/mafwregistryadapter.cpp
+}
 
 HEADERS += \
     mafw/mafwrenderersignalhelper.h \
@@ -21,26 +41,28 @@ HEADERS += \
     mafw/mafwplaylistadapter.h \
     mafw/mafwplaylistmanageradapter.h \
     mafw/mafwregistryadapter.h \
+    mediaobjectid.h \
+    metadatacache.h \
     metadatawatcher.h \
     missioncontrol.h \
+    playbackstatistics.h \
     playlistquerymanager.h \
     qchaudioplayer.h \
+    qchmedialibrarymodel.h \
     qchmediastatus.h \
     qchmediatype.h \
     qchnowplayingmodel.h \
     qchplugin.h
 
 SOURCES += \
-    mafw/mafwrenderersignalhelper.cpp \
-    mafw/mafwsourceadapter.cpp \
-    mafw/mafwrendereradapter.cpp \
-    mafw/mafwplaylistadapter.cpp \
-    mafw/mafwplaylistmanageradapter.cpp \
-    mafw/mafwregistryadapter.cpp \
+    mediaobjectid.cpp \
+    metadatacache.cpp \
     metadatawatcher.cpp \
     missioncontrol.cpp \
+    playbackstatistics.cpp \
     playlistquerymanager.cpp \
     qchaudioplayer.cpp \
+    qchmedialibrarymodel.cpp \
     qchnowplayingmodel.cpp \
     qchplugin.cpp
 
@@ -0,0 +1,341 @@
+#include "playbackstatistics.h"
+#include "mediaobjectid.h"
+#include "metadatawatcher.h"
+#include "mafw/mafwregistryadapter.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QTimerEvent>
+
+// The number of most recent samples used for the statistics of each interval
+static const int SAMPLE_WINDOW = 32;
+
+// The renderer is called and signals several times per second while playing, so changes
+// of the counts are announced at most once per interval
+static const int COUNTS_NOTIFY_INTERVAL = 1000;
+
+// The name of each PlaybackStatistics::Interval, as exposed to QML
+static const char* const INTERVAL_NAMES[] = {
+    "playToTransitioning",
+    "transitioningToPlaying",
+    "playToPlaying",
+    "seek",
+    "sourceToMetadata"
+};
+
+static QVariantMap countsToMap(const QHash<QByteArray, int> &counts)
+{
+    QVariantMap map;
+    QHashIterator<QByteArray, int> iterator(counts);
+
+    while (iterator.hasNext()) {
+        iterator.next();
+        map[QString::fromLatin1(iterator.key())] = iterator.value();
+    }
+
+    return map;
+}
+
+PlaybackStatistics* PlaybackStatistics::instance = NULL;
+
+PlaybackStatistics* PlaybackStatistics::acquire()
+{
+    return instance ? instance : instance = new PlaybackStatistics();
+}
+
+PlaybackStatistics::PlaybackStatistics() :
+    QObject(),
+    mafwRenderer(MafwRegistryAdapter::get()->renderer()),
+    metadataWatcher(MetadataWatcher::acquire()),
+    countsTimerId(0),
+    callsChanged(false),
+    signalsChanged(false)
+{
+    for (int i = 0; i < IntervalCount; i++)
+        timers[i].invalidate();
+
+    connect(mafwRenderer, SIGNAL(stateChanged(int)), this, SLOT(onStateChanged(int)));
+    connect(mafwRenderer, SIGNAL(signalSetPosition(int,QString)), this, SLOT(onPositionSet(int,QString)));
+    connect(metadataWatcher, SIGNAL(metadataChanged()), this, SLOT(onMetadataChanged()));
+}
+
+void PlaybackStatistics::countRendererCall(const char *name)
+{
+    if (!instance)
+        return;
+
+    const QByteArray key(name);
+    instance->calls[key]++;
+
+    if (key == "play" || key == "playObject" || key == "playURI" || key == "resume") {
+        instance->start(PlayToTransitioning);
+        instance->start(PlayToPlaying);
+    } else if (key == "setPosition") {
+        instance->start(Seek);
+    }
+
+    instance->callsChanged = true;
+    instance->scheduleCountsChanged();
+}
+
+void PlaybackStatistics::countRendererSignal(const char *name)
+{
+    if (!instance)
+        return;
+
+    instance->notifications[QByteArray(name)]++;
+    instance->signalsChanged = true;
+    instance->scheduleCountsChanged();
+}
+
+// Returns a map of interval names to maps of count, last, average, minimum and maximum, in milliseconds
+QVariantMap PlaybackStatistics::latencies() const
+{
+    QVariantMap map;
+
+    for (int i = 0; i < IntervalCount; i++)
+        map[INTERVAL_NAMES[i]] = summary(Interval(i));
+
+    return map;
+}
+
+QVariantMap PlaybackStatistics::rendererCalls() const
+{
+    return countsToMap(calls);
+}
+
+QVariantMap PlaybackStatistics::rendererSignals() const
+{
+    return countsToMap(notifications);
+}
+
+QString PlaybackStatistics::logFileName() const
+{
+    return logFile;
+}
+
+void PlaybackStatistics::setLogFileName(const QString &fileName)
+{
+    if (fileName != logFile) {
+        logFile = fileName;
+        emit logFileNameChanged();
+    }
+}
+
+// The SourceToMetadata interval ends when the metadata of objectId is received
+void PlaybackStatistics::sourceAssigned(const QString &objectId)
+{
+    pendingSource = objectId;
+    start(SourceToMetadata);
+}
+
+void PlaybackStatistics::reset()
+{
+    for (int i = 0; i < IntervalCount; i++) {
+        timers[i].invalidate();
+        samples[i] = Samples();
+    }
+
+    pendingSource.clear();
+    calls.clear();
+    notifications.clear();
+    callsChanged = true;
+    signalsChanged = true;
+    emit latenciesChanged();
+    emitCountsChanged();
+}
+
+// Writes the current statistics to the log file, or to the debug output if no log file is set
+void PlaybackStatistics::dump()
+{
+    emitCountsChanged();
+
+    QStringList lines;
+
+    for (int i = 0; i < IntervalCount; i++) {
+        const QVariantMap map = summary(Interval(i));
+        lines << QString("%1: count %2, last %3 ms, average %4 ms, minimum %5 ms, maximum %6 ms")
+                 .arg(INTERVAL_NAMES[i]).arg(map["count"].toInt()).arg(map["last"].toLongLong())
+                 .arg(map["average"].toLongLong()).arg(map["minimum"].toLongLong())
+                 .arg(map["maximum"].toLongLong());
+    }
+
+    QMapIterator<QString, QVariant> callIterator(rendererCalls());
+
+    while (callIterator.hasNext()) {
+        callIterator.next();
+        lines << QString("call %1: %2").arg(callIterator.key()).arg(callIterator.value().toInt());
+    }
+
+    QMapIterator<QString, QVariant> signalIterator(rendererSignals());
+
+    while (signalIterator.hasNext()) {
+        signalIterator.next();
+        lines << QString("signal %1: %2").arg(signalIterator.key()).arg(signalIterator.value().toInt());
+    }
+
+    if (logFile.isEmpty()) {
+        foreach (const QString &line, lines)
+            qDebug() << "PlaybackStatistics:" << line;
+    } else {
+        writeLog(lines);
+    }
+}
+
+void PlaybackStatistics::start(Interval interval)
+{
+    timers[interval].start();
+}
+
+void PlaybackStatistics::finish(Interval interval)
+{
+    if (!timers[interval].isValid())
+        return;
+
+    const qint64 elapsed = timers[interval].elapsed();
+    timers[interval].invalidate();
+
+    Samples &s = samples[interval];
+
+    if (s.values.size() < SAMPLE_WINDOW)
+        s.values.append(elapsed);
+    else
+        s.values[s.next] = elapsed;
+
+    s.next = (s.next + 1) % SAMPLE_WINDOW;
+    s.last = elapsed;
+    s.count++;
+
+    if (!logFile.isEmpty())
+        writeLog(QStringList() << QString("%1 %2 ms").arg(INTERVAL_NAMES[interval]).arg(elapsed));
+
+    emit latenciesChanged();
+}
+
+void PlaybackStatistics::cancel(Interval interval)
+{
+    timers[interval].invalidate();
+}
+
+QVariantMap PlaybackStatistics::summary(Interval interval) const
+{
+    const Samples &s = samples[interval];
+    QVariantMap map;
+    map["count"] = s.count;
+
+    if (s.values.isEmpty()) {
+        map["last"] = 0;
+        map["average"] = 0;
+        map["minimum"] = 0;
+        map["maximum"] = 0;
+        return map;
+    }
+
+    qint64 total = 0;
+    qint64 minimum = s.values.first();
+    qint64 maximum = minimum;
+
+    foreach (qint64 value, s.values) {
+        total += value;
+        minimum = qMin(minimum, value);
+        maximum = qMax(maximum, value);
+    }
+
+    map["last"] = s.last;
+    map["average"] = total / s.values.size();
+    map["minimum"] = minimum;
+    map["maximum"] = maximum;
+    return map;
+}
+
+void PlaybackStatistics::scheduleCountsChanged()
+{
+    if (!countsTimerId)
+        countsTimerId = startTimer(COUNTS_NOTIFY_INTERVAL);
+}
+
+void PlaybackStatistics::emitCountsChanged()
+{
+    if (countsTimerId) {
+        killTimer(countsTimerId);
+        countsTimerId = 0;
+    }
+
+    if (callsChanged) {
+        callsChanged = false;
+        emit rendererCallsChanged();
+    }
+
+    if (signalsChanged) {
+        signalsChanged = false;
+        emit rendererSignalsChanged();
+    }
+}
+
+void PlaybackStatistics::writeLog(const QStringList &lines)
+{
+    QFile file(logFile);
+
+    if (!file.open(QFile::WriteOnly | QFile::Append | QFile::Text)) {
+        qDebug() << "PlaybackStatistics: cannot open" << logFile;
+        return;
+    }
+
+    QTextStream stream(&file);
+    const QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
+
+    foreach (const QString &line, lines)
+        stream << timestamp << " " << line << "\n";
+}
+
+void PlaybackStatistics::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == countsTimerId)
+        emitCountsChanged();
+    else
+        QObject::timerEvent(event);
+}
+
+void PlaybackStatistics::onStateChanged(int state)
+{
+    switch (state) {
+    case Transitioning:
+        finish(PlayToTransitioning);
+        start(TransitioningToPlaying);
+        break;
+    case Playing:
+        // Resuming goes straight to Playing, so there is no transitioning sample
+        cancel(PlayToTransitioning);
+        finish(TransitioningToPlaying);
+        finish(PlayToPlaying);
+        break;
+    default:
+        // Playback was stopped or paused before it started
+        cancel(PlayToTransitioning);
+        cancel(TransitioningToPlaying);
+        cancel(PlayToPlaying);
+        break;
+    }
+}
+
+void PlaybackStatistics::onPositionSet(int, const QString &error)
+{
+    if (error.isEmpty())
+        finish(Seek);
+    else
+        cancel(Seek);
+}
+
+// Metadata of the previous source may still arrive after a new one has been assigned
+void PlaybackStatistics::onMetadataChanged()
+{
+    if (pendingSource.isEmpty() || metadataWatcher->url().isEmpty())
+        return;
+
+    if (MediaObjectId::fromUri(metadataWatcher->url()) == pendingSource) {
+        pendingSource.clear();
+        finish(SourceToMetadata);
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef PLAYBACKSTATISTICS_P_H
+#define PLAYBACKSTATISTICS_P_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVariantMap>
+#include <QVector>
+
+class MafwRendererAdapter;
+class MetadataWatcher;
+
+// Collects playback latencies and MAFW renderer traffic. Latencies are kept as
+// rolling statistics over the most recent samples, calls and signals are counted
+// by name. Every completed latency sample can optionally be appended to a log file.
+class PlaybackStatistics : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QVariantMap latencies READ latencies NOTIFY latenciesChanged)
+    Q_PROPERTY(QVariantMap rendererCalls READ rendererCalls NOTIFY rendererCallsChanged)
+    Q_PROPERTY(QVariantMap rendererSignals READ rendererSignals NOTIFY rendererSignalsChanged)
+    Q_PROPERTY(QString logFileName READ logFileName WRITE setLogFileName NOTIFY logFileNameChanged)
+
+public:
+    static PlaybackStatistics* acquire();
+
+    // Called by MafwRendererAdapter, these do nothing until the statistics have been acquired
+    static void countRendererCall(const char *name);
+    static void countRendererSignal(const char *name);
+
+    QVariantMap latencies() const;
+    QVariantMap rendererCalls() const;
+    QVariantMap rendererSignals() const;
+
+    QString logFileName() const;
+    void setLogFileName(const QString &fileName);
+
+    void sourceAssigned(const QString &objectId);
+
+    Q_INVOKABLE void reset();
+    Q_INVOKABLE void dump();
+
+signals:
+    void latenciesChanged();
+    void rendererCallsChanged();
+    void rendererSignalsChanged();
+    void logFileNameChanged();
+
+private:
+    enum Interval {
+        PlayToTransitioning,
+        TransitioningToPlaying,
+        PlayToPlaying,
+        Seek,
+        SourceToMetadata,
+        IntervalCount
+    };
+
+    struct Samples
+    {
+        Samples() : last(0), count(0), next(0) {}
+
+        QVector<qint64> values;
+        qint64 last;
+        int count;
+        int next;
+    };
+
+    static PlaybackStatistics *instance;
+
+    MafwRendererAdapter *mafwRenderer;
+    MetadataWatcher *metadataWatcher;
+
+    QElapsedTimer timers[IntervalCount];
+    Samples samples[IntervalCount];
+
+    QHash<QByteArray, int> calls;
+    QHash<QByteArray, int> notifications;
+
+    QString pendingSource;
+
+    int countsTimerId;
+    bool callsChanged;
+    bool signalsChanged;
+
+    QString logFile;
+
+    PlaybackStatistics();
+
+    void start(Interval interval);
+    void finish(Interval interval);
+    void cancel(Interval interval);
+
+    QVariantMap summary(Interval interval) const;
+
+    void scheduleCountsChanged();
+    void emitCountsChanged();
+
+    void writeLog(const QStringList &lines);
+
+    virtual void timerEvent(QTimerEvent *event);
+
+private slots:
+    void onStateChanged(int state);
+    void onPositionSet(int position, const QString &error);
+    void onMetadataChanged();
+};
+
+#endif // PLAYBACKSTATISTICS_P_H
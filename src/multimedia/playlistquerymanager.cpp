@@ -3,7 +3,10 @@
 #define FIRST 0
 #define LAST 1
 #define BATCH_SIZE 100
+#define MIN_BATCH_SIZE 20
+#define MAX_BATCH_SIZE 250
 #define ITEM_HEIGHT 70
+#define LOOKAHEAD_TIME 500 // ms of scrolling to fetch ahead of the viewport
 
 PlaylistQueryManager::PlaylistQueryManager(QObject *parent, MafwPlaylistAdapter *playlist, MafwPlaylist *mafwplaylist) :
     QObject(parent)
@@ -11,7 +14,10 @@ PlaylistQueryManager::PlaylistQueryManager(QObject *parent, MafwPlaylistAdapter
     this->playlist = playlist;
     this->mafwplaylist = mafwplaylist;
     priority = 0;
+    batchSize = BATCH_SIZE;
+    metadataKeys = NULL;
     getItemsOp = NULL;
+    rangeInProgress = NULL;
     connect(playlist, SIGNAL(onGetItems(QString,GHashTable*,guint,gpointer)),
             this, SLOT(onGetItems(QString,GHashTable*,guint,gpointer)));
     connect(playlist, SIGNAL(getItemsComplete(gpointer)),
@@ -27,11 +33,47 @@ PlaylistQueryManager::~PlaylistQueryManager()
         delete requests.takeLast();
 }
 
+// keys must remain valid for the lifetime of the manager, NULL restores the default set of keys
+void PlaylistQueryManager::setMetadataKeys(const gchar* const *keys)
+{
+    metadataKeys = keys;
+}
+
 void PlaylistQueryManager::setPriority(int position)
 {
     priority = position/ITEM_HEIGHT;
 }
 
+// first and last are the visible rows, velocity is in rows per second (positive when scrolling towards the end)
+void PlaylistQueryManager::setViewport(int first, int last, qreal velocity)
+{
+    if (last < first)
+        return;
+
+    int visible = 1+last-first;
+    int ahead = qRound(qAbs(velocity) * LOOKAHEAD_TIME / 1000);
+
+    // centre the next batch on where the viewport is heading, and size it to cover the rows that
+    // will scroll into view before the following batch can arrive
+    if (velocity > 0) {
+        priority = (first+last)/2 + ahead;
+        batchSize = qBound(MIN_BATCH_SIZE, visible+ahead, MAX_BATCH_SIZE);
+        dropRequestsBefore(first-visible);
+    }
+    else if (velocity < 0) {
+        priority = (first+last)/2 - ahead;
+        batchSize = qBound(MIN_BATCH_SIZE, visible+ahead, MAX_BATCH_SIZE);
+        dropRequestsAfter(last+visible);
+    }
+    else {
+        priority = (first+last)/2;
+        batchSize = BATCH_SIZE;
+    }
+
+    if (!getItemsOp)
+        queryPlaylist();
+}
+
 void PlaylistQueryManager::getItems(int first, int last)
 {
     if (mafwplaylist == NULL) {
@@ -42,6 +84,16 @@ void PlaylistQueryManager::getItems(int first, int last)
         last = playlist->getSizeOf(mafwplaylist)-1;
     }
 
+    // skip rows that are already being fetched
+    if (getItemsOp) {
+        if (first >= rangeInProgress[FIRST] && last <= rangeInProgress[LAST])
+            return;
+        else if (first >= rangeInProgress[FIRST] && first <= rangeInProgress[LAST])
+            first = rangeInProgress[LAST]+1;
+        else if (last >= rangeInProgress[FIRST] && last <= rangeInProgress[LAST])
+            last = rangeInProgress[FIRST]-1;
+    }
+
     if (last < first)
         return;
 
@@ -98,11 +150,11 @@ void PlaylistQueryManager::queryPlaylist()
             best = requests.at(i);
 
     // try to fit a batch in the selected request
-    int first = qBound(best[FIRST], priority-(BATCH_SIZE-1)/2, best[LAST]);
-    int last = qBound(best[FIRST], priority+BATCH_SIZE/2, best[LAST]);
+    int first = qBound(best[FIRST], priority-(batchSize-1)/2, best[LAST]);
+    int last = qBound(best[FIRST], priority+batchSize/2, best[LAST]);
 
     // distribute remaining batch budget and update the list of requests
-    int pool = BATCH_SIZE - (1+last-first);
+    int pool = batchSize - (1+last-first);
 
     // left side filled
     if (first == best[FIRST]) {
@@ -137,9 +189,9 @@ void PlaylistQueryManager::queryPlaylist()
     }
 
     if (mafwplaylist == NULL)
-        getItemsOp = playlist->getItems(first, last);
+        getItemsOp = playlist->getItems(first, last, metadataKeys);
     else
-        getItemsOp = playlist->getItemsOf(mafwplaylist, first, last);
+        getItemsOp = playlist->getItemsOf(mafwplaylist, first, last, metadataKeys);
 
     // throw the range into the list of requests, in case of restart
     rangeInProgress = new int[2];
@@ -160,6 +212,8 @@ void PlaylistQueryManager::onRequestComplete(gpointer op)
     if (getItemsOp == op) {
         getItemsOp = NULL;
         requests.removeOne(rangeInProgress);
+        emit rangeFinished(rangeInProgress[FIRST], rangeInProgress[LAST]);
+        emit getItemsComplete();
         queryPlaylist();
     }
 }
@@ -236,6 +290,70 @@ void PlaylistQueryManager::itemsRemoved(int from, int amount)
     if (restartRequired) restart();
 }
 
+// drops the queued ranges that the viewport has already scrolled past
+void PlaylistQueryManager::dropRequestsBefore(int row)
+{
+    if (row <= 0)
+        return;
+
+    if (getItemsOp && rangeInProgress[LAST] < row)
+        cancelRangeInProgress();
+
+    for (int i = 0; i < requests.size(); i++)
+
+        // temporary entry
+        if (requests.at(i) == rangeInProgress) continue;
+
+        // completely passed
+        else if (requests.at(i)[LAST] < row) {
+            emit rangeFinished(requests.at(i)[FIRST], requests.at(i)[LAST]);
+            delete requests.takeAt(i);
+            --i;
+        }
+
+        // partially passed
+        else if (requests.at(i)[FIRST] < row) {
+            emit rangeFinished(requests.at(i)[FIRST], row-1);
+            requests.at(i)[FIRST] = row;
+        }
+}
+
+void PlaylistQueryManager::dropRequestsAfter(int row)
+{
+    if (getItemsOp && rangeInProgress[FIRST] > row)
+        cancelRangeInProgress();
+
+    for (int i = 0; i < requests.size(); i++)
+
+        // temporary entry
+        if (requests.at(i) == rangeInProgress) continue;
+
+        // completely passed
+        else if (requests.at(i)[FIRST] > row) {
+            emit rangeFinished(requests.at(i)[FIRST], requests.at(i)[LAST]);
+            delete requests.takeAt(i);
+            --i;
+        }
+
+        // partially passed
+        else if (requests.at(i)[LAST] > row) {
+            emit rangeFinished(row+1, requests.at(i)[LAST]);
+            requests.at(i)[LAST] = row;
+        }
+}
+
+// cancels the running query without re-queueing its range
+void PlaylistQueryManager::cancelRangeInProgress()
+{
+    mafw_playlist_cancel_get_items_md(getItemsOp);
+    getItemsOp = NULL;
+    requests.removeOne(rangeInProgress);
+    emit rangeFinished(rangeInProgress[FIRST], rangeInProgress[LAST]);
+    delete rangeInProgress;
+    rangeInProgress = NULL;
+    emit getItemsComplete();
+}
+
 void PlaylistQueryManager::restart()
 {
     if (getItemsOp) {
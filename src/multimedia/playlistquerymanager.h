@@ -16,15 +16,22 @@ public:
     void getItems(int first, int last);
     void itemsInserted(int from, int amount);
     void itemsRemoved(int from, int amount);
+    void setMetadataKeys(const gchar* const *keys);
 
 signals:
     void onGetItems(QString objectId, GHashTable *metadata, guint index);
+    void getItemsComplete();
+    void rangeFinished(int first, int last);
 
 public slots:
     void setPriority(int position);
+    void setViewport(int first, int last, qreal velocity);
 
 private:
     void mergeRequest(int first, int last);
+    void dropRequestsBefore(int row);
+    void dropRequestsAfter(int row);
+    void cancelRangeInProgress();
     void queryPlaylist();
     void restart();
 
@@ -33,6 +40,8 @@ private:
     QList<int*> requests;
     gpointer getItemsOp;
     int priority;
+    int batchSize;
+    const gchar* const *metadataKeys;
     int* rangeInProgress;
 
 private slots:
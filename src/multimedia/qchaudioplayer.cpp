@@ -15,13 +15,23 @@
  */
  
 #include "qchaudioplayer.h"
+#include "mediaobjectid.h"
 #include "metadatawatcher.h"
 #include "missioncontrol.h"
+#include "playbackstatistics.h"
 #include "mafw/mafwregistryadapter.h"
-#include <libgnomevfs/gnome-vfs-mime-utils.h>
 #include <QDBusConnection>
 #include <QDBusMessage>
 #include <QDeclarativeInfo>
+#include <QElapsedTimer>
+#include <QTimerEvent>
+#include <QVector>
+
+// The interval at which the interpolated position is checked against the renderer
+static const int POSITION_SYNC_INTERVAL = 10000;
+// The margin in milliseconds by which the interpolated position may differ from the renderer
+// before it is corrected. The renderer reports whole seconds, so the range is [pos - margin, pos + 1s + margin]
+static const int POSITION_DRIFT_MARGIN = 250;
 
 class QchAudioPlayerPrivate
 {
@@ -35,6 +45,7 @@ public:
         mafwTrackerSource(0),
         metadataWatcher(0),
         missionControl(0),
+        statistics(0),
         autoLoad(true),
         bufferProgress(0.0),
         seekable(true),
@@ -46,6 +57,10 @@ public:
         muteVolume(0),
         tickInterval(1000),
         positionTimerId(-1),
+        syncTimerId(-1),
+        anchorPosition(0),
+        emittedPosition(0),
+        interpolating(false),
         sourceLoaded(true),
         readyToPlay(false),
         playWhenReady(false)
@@ -53,37 +68,96 @@ public:
     }
     
     void loadSource() {
-        QString uriToPlay = source.startsWith("/") ? "file://" + source : source;
-        QString objectId = mafwTrackerSource->createObjectId(uriToPlay);
-        
-        if (uriToPlay.startsWith("file://")) {
-            QString mime(gnome_vfs_get_mime_type_for_name(uriToPlay.toUtf8()));
-            objectId = objectId.remove(0, 18) // "urisource::file://"
-                               .replace("/", "%2F")
-                               .prepend("localtagfs::music/songs/");
-        }
-        
         mafwPlaylist->assignAudioPlaylist();
         mafwPlaylist->clear();
+        const QString objectId = MediaObjectId::fromUri(source);
         mafwPlaylist->appendItem(objectId);
         sourceLoaded = true;
+        statistics->sourceAssigned(objectId);
+        resetPosition();
     }
     
     void startPositionTimer() {
-        if (positionTimerId == -1) {
-            Q_Q(QchAudioPlayer);
+        Q_Q(QchAudioPlayer);
+        
+        if ((positionTimerId == -1) && (tickInterval > 0)) {
             positionTimerId = q->startTimer(tickInterval);
         }
         
+        // Without position ticks nothing observes the drift, so there is nothing to resynchronize
+        if ((syncTimerId == -1) && (tickInterval > 0)) {
+            syncTimerId = q->startTimer(POSITION_SYNC_INTERVAL);
+        }
+        
         mafwRenderer->getPosition();
     }
     
     void stopPositionTimer() {
+        Q_Q(QchAudioPlayer);
+        
         if (positionTimerId != -1) {
-            Q_Q(QchAudioPlayer);
             q->killTimer(positionTimerId);
             positionTimerId = -1;
         }
+        
+        if (syncTimerId != -1) {
+            q->killTimer(syncTimerId);
+            syncTimerId = -1;
+        }
+    }
+    
+    // Returns the position in milliseconds, extrapolated from the last known position while playing
+    qint64 currentPosition() const {
+        qint64 pos = anchorPosition;
+        
+        if (interpolating) {
+            pos += clock.elapsed();
+            
+            if (duration > 0) {
+                pos = qMin(pos, qint64(duration) * 1000);
+            }
+        }
+        
+        return pos;
+    }
+    
+    void setAnchorPosition(qint64 pos) {
+        anchorPosition = pos;
+        
+        if (interpolating) {
+            clock.restart();
+        }
+    }
+    
+    // Discards the position of the previous media, so that it is not extrapolated into the new one
+    void resetPosition() {
+        setAnchorPosition(0);
+        updatePosition();
+    }
+    
+    void startInterpolation() {
+        if (!interpolating) {
+            interpolating = true;
+            clock.start();
+        }
+    }
+    
+    void stopInterpolation() {
+        if (interpolating) {
+            anchorPosition = currentPosition();
+            interpolating = false;
+        }
+    }
+    
+    void updatePosition() {
+        const qint64 pos = currentPosition();
+        
+        if (pos != emittedPosition) {
+            Q_Q(QchAudioPlayer);
+            emittedPosition = pos;
+            position = pos / 1000;
+            emit q->positionChanged();
+        }
     }
     
     void _q_onStatusReady(MafwPlaylist*, uint index, MafwPlayState state, const char*, const QString &error) {
@@ -102,9 +176,9 @@ public:
     
     void _q_onMetaDataChanged() {
         Q_Q(QchAudioPlayer);
-        int dur = metadataWatcher->metadata().value(MAFW_METADATA_KEY_DURATION).toInt();
-        bool seek = metadataWatcher->metadata().value(MAFW_METADATA_KEY_IS_SEEKABLE).toBool();
-        QString uri = metadataWatcher->metadata().value(MAFW_METADATA_KEY_URI).toString();
+        int dur = metadataWatcher->duration();
+        bool seek = metadataWatcher->isSeekable();
+        QString uri = metadataWatcher->url();
         
         if (dur != duration) {
             duration = dur;
@@ -119,6 +193,12 @@ public:
         if (uri != source) {
             source = uri;
             sourceLoaded = true;
+            resetPosition();
+            
+            if (interpolating) {
+                mafwRenderer->getPosition();
+            }
+            
             emit q->sourceChanged();
         }
     }
@@ -130,9 +210,15 @@ public:
     }
     
     void _q_onPositionChanged(int pos) {
-        Q_Q(QchAudioPlayer);
-        position = pos;
-        emit q->positionChanged();
+        // Only correct the interpolated position if it has drifted outside of the reported second
+        const qint64 current = currentPosition();
+        const qint64 reported = qint64(pos) * 1000;
+        
+        if ((current < reported - POSITION_DRIFT_MARGIN) || (current > reported + 1000 + POSITION_DRIFT_MARGIN)) {
+            setAnchorPosition(reported);
+        }
+        
+        updatePosition();
     }
     
     void _q_onVolumeChanged(int vol) {
@@ -149,14 +235,13 @@ public:
         case Transitioning:
             readyToPlay = false;
             status = QchMediaStatus::Loading;
+            stopInterpolation();
             break;
         case Playing:
             readyToPlay = false;
             status = QchMediaStatus::Playing;
-            
-            if (tickInterval > 0) {
-                startPositionTimer();
-            }
+            startInterpolation();
+            startPositionTimer();
             
             if (oldStatus == QchMediaStatus::Paused) {
                 emit q->resumed();
@@ -175,8 +260,9 @@ public:
             }
             else {
                 status = QchMediaStatus::Paused;
-                mafwRenderer->getPosition();
+                stopInterpolation();
                 stopPositionTimer();
+                mafwRenderer->getPosition();
                 emit q->paused();
             }
             
@@ -196,6 +282,9 @@ public:
                     status = QchMediaStatus::Stopped;
                 }
                 
+                interpolating = false;
+                anchorPosition = 0;
+                emittedPosition = 0;
                 position = 0;
                 stopPositionTimer();
                 emit q->positionChanged();
@@ -323,6 +412,7 @@ public:
     MafwSourceAdapter *mafwTrackerSource;
     MetadataWatcher *metadataWatcher;
     MissionControl *missionControl;
+    PlaybackStatistics *statistics;
     
     bool autoLoad;
     
@@ -347,6 +437,12 @@ public:
     int tickInterval;
     
     int positionTimerId;
+    int syncTimerId;
+    
+    QElapsedTimer clock;
+    qint64 anchorPosition;
+    qint64 emittedPosition;
+    bool interpolating;
     
     bool sourceLoaded;
     
@@ -379,6 +475,7 @@ QchAudioPlayer::QchAudioPlayer(QObject *parent) :
     d->mafwTrackerSource = d->mafwRegistry->source(MafwRegistryAdapter::Tracker);
     d->metadataWatcher = MetadataWatcher::acquire();
     d->missionControl = MissionControl::acquire();
+    d->statistics = PlaybackStatistics::acquire();
     
     connect(d->metadataWatcher, SIGNAL(metadataChanged()), this, SLOT(_q_onMetaDataChanged()));
     connect(d->mafwRenderer, SIGNAL(signalGetStatus(MafwPlaylist*,uint,MafwPlayState,const char*,QString)),
@@ -609,6 +706,10 @@ bool QchAudioPlayer::isSeekable() const {
 
 /*!
     \brief The current position in the audio stream, in seconds.
+    
+    While playing, the position is interpolated locally and periodically checked against the MAFW renderer.
+    
+    \sa precisePosition, tickInterval
 */
 int QchAudioPlayer::position() const {
     Q_D(const QchAudioPlayer);
@@ -618,11 +719,25 @@ int QchAudioPlayer::position() const {
 void QchAudioPlayer::setPosition(int pos) {
     if (pos != position()) {
         Q_D(QchAudioPlayer);
+        d->setAnchorPosition(qint64(pos) * 1000);
+        d->updatePosition();
         d->mafwRenderer->setPosition(SeekAbsolute, pos);
         d->mafwRenderer->getPosition();
     }
 }
 
+/*!
+    \brief The current position in the audio stream, in seconds, including fractions of a second.
+    
+    This property can be used together with a small tickInterval to provide smooth progress bars.
+    
+    \sa position, tickInterval
+*/
+qreal QchAudioPlayer::precisePosition() const {
+    Q_D(const QchAudioPlayer);
+    return d->emittedPosition / qreal(1000);
+}
+
 /*!
     \brief The duration of the audio stream, in seconds.
 */
@@ -653,6 +768,77 @@ void QchAudioPlayer::setSource(const QString &uri) {
     }
 }
 
+/*!
+    \brief Adds the sources with the specified \a uris to the end of the playlist.
+    
+    The sources are appended to the MAFW playlist in a single request, and are played in sequence 
+    after the items already in the playlist.
+    
+    \sa source, NowPlayingModel::appendSources()
+*/
+void QchAudioPlayer::appendSources(const QStringList &uris) {
+    const QList<QByteArray> ids = MediaObjectId::fromUris(uris);
+    
+    if (ids.isEmpty()) {
+        return;
+    }
+    
+    Q_D(QchAudioPlayer);
+    
+    if (!d->sourceLoaded) {
+        d->loadSource();
+    }
+    
+    QVector<const gchar*> oids;
+    oids.reserve(ids.size() + 1);
+    
+    foreach (const QByteArray &id, ids) {
+        oids.append(id.constData());
+    }
+    
+    oids.append(NULL);
+    d->mafwPlaylist->assignAudioPlaylist();
+    d->mafwPlaylist->appendItems(oids.data());
+}
+
+/*!
+    \brief Playback latency and MAFW renderer statistics.
+    
+    The statistics are shared by all Audio instances and provide the following properties:
+    
+    <table>
+        <tr>
+            <th>Name</th>
+            <th>Description</th>
+        </tr>
+        <tr>
+            <td>statistics.latencies</td>
+            <td>A map of the intervals \c playToTransitioning, \c transitioningToPlaying, \c playToPlaying, 
+            \c seek and \c sourceToMetadata to their \c count, \c last, \c average, \c minimum and 
+            \c maximum durations in milliseconds, over the most recent samples.</td>
+        </tr>
+        <tr>
+            <td>statistics.rendererCalls</td>
+            <td>A map of MAFW renderer operations to the number of times they have been called.</td>
+        </tr>
+        <tr>
+            <td>statistics.rendererSignals</td>
+            <td>A map of MAFW renderer signals and replies to the number of times they have been received.</td>
+        </tr>
+        <tr>
+            <td>statistics.logFileName</td>
+            <td>If set, each latency sample is appended to this file.</td>
+        </tr>
+    </table>
+    
+    statistics.reset() clears all statistics, and statistics.dump() writes them to the log file, or to the 
+    debug output if no log file is set.
+*/
+PlaybackStatistics* QchAudioPlayer::statistics() const {
+    Q_D(const QchAudioPlayer);
+    return d->statistics;
+}
+
 /*!
     \brief The current status of the audio stream.
     
@@ -697,6 +883,9 @@ QchMediaStatus::Status QchAudioPlayer::status() const {
 /*!
     \brief The frequency of position updates, in milliseconds.
     
+    Position updates are interpolated locally, so a small interval (e.g. 50) can be used for smooth 
+    progress bars without additional requests to the MAFW renderer.
+    
     Setting this property to 0 will suspend updates.
     
     The default value is 1000.
@@ -714,7 +903,7 @@ void QchAudioPlayer::setTickInterval(int interval) {
         
         d->stopPositionTimer();
         
-        if ((interval > 0) && (isPlaying())) {
+        if (isPlaying()) {
             d->startPositionTimer();
         }
     }
@@ -836,9 +1025,18 @@ void QchAudioPlayer::componentComplete() {
     }
 }
 
-void QchAudioPlayer::timerEvent(QTimerEvent *) {
+void QchAudioPlayer::timerEvent(QTimerEvent *event) {
     Q_D(QchAudioPlayer);
-    d->mafwRenderer->getPosition();
+    
+    if (event->timerId() == d->syncTimerId) {
+        d->mafwRenderer->getPosition();
+    }
+    else if (event->timerId() == d->positionTimerId) {
+        d->updatePosition();
+    }
+    else {
+        QObject::timerEvent(event);
+    }
 }
 
 #include "moc_qchaudioplayer.cpp"
@@ -19,11 +19,13 @@
 
 #include "qchmediastatus.h"
 #include <QObject>
+#include <QStringList>
 #include <QDeclarativeParserStatus>
 #include <qdeclarative.h>
 
 class QDBusMessage;
 class MetadataWatcher;
+class PlaybackStatistics;
 class QchAudioPlayerPrivate;
 
 class QchAudioPlayer : public QObject, public QDeclarativeParserStatus
@@ -39,8 +41,10 @@ class QchAudioPlayer : public QObject, public QDeclarativeParserStatus
     Q_PROPERTY(bool paused READ isPaused WRITE setPaused NOTIFY statusChanged)
     Q_PROPERTY(bool playing READ isPlaying WRITE setPlaying NOTIFY statusChanged)
     Q_PROPERTY(int position READ position WRITE setPosition NOTIFY positionChanged)
+    Q_PROPERTY(qreal precisePosition READ precisePosition NOTIFY positionChanged)
     Q_PROPERTY(bool seekable READ isSeekable NOTIFY seekableChanged)
     Q_PROPERTY(QString source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(PlaybackStatistics* statistics READ statistics CONSTANT)
     Q_PROPERTY(QchMediaStatus::Status status READ status NOTIFY statusChanged)
     Q_PROPERTY(int volume READ volume WRITE setVolume NOTIFY volumeChanged)
     Q_PROPERTY(int tickInterval READ tickInterval WRITE setTickInterval NOTIFY tickIntervalChanged)
@@ -76,11 +80,17 @@ public:
     int position() const;
     void setPosition(int pos);
     
+    qreal precisePosition() const;
+    
     int duration() const;
     
     QString source() const;
     void setSource(const QString &uri);
     
+    Q_INVOKABLE void appendSources(const QStringList &uris);
+    
+    PlaybackStatistics* statistics() const;
+    
     QchMediaStatus::Status status() const;
     
     int volume() const;
@@ -115,7 +125,7 @@ private:
     virtual void classBegin();
     virtual void componentComplete();
     
-    virtual void timerEvent(QTimerEvent *);
+    virtual void timerEvent(QTimerEvent *event);
     
     QScopedPointer<QchAudioPlayerPrivate> d_ptr;
     
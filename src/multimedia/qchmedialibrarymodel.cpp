@@ -0,0 +1,766 @@
+/*
+ * Copyright (C) 2016 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qchmedialibrarymodel.h"
+#include "mafw/mafwsourceadapter.h"
+#include <QDeclarativeInfo>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+// The default number of items requested by each browse operation
+static const int DEFAULT_PAGE_SIZE = 100;
+// The default number of pages kept in memory
+static const int DEFAULT_CACHED_PAGES = 10;
+
+static const int ROLE_COUNT = QchMediaLibraryModel::YearRole - QchMediaLibraryModel::AlbumTitleRole + 1;
+
+// The MAFW metadata key required by each role, indexed from AlbumTitleRole
+static const char* const ROLE_METADATA_KEYS[ROLE_COUNT] = {
+    MAFW_METADATA_KEY_ALBUM,                         // AlbumTitleRole
+    MAFW_METADATA_KEY_ARTIST,                        // ArtistRole
+    MAFW_METADATA_KEY_CHILDCOUNT_1,                  // ChildCountRole
+    MAFW_METADATA_KEY_ALBUM_ART_URI,                 // CoverArtUrlRole
+    MAFW_METADATA_KEY_DURATION,                      // DurationRole
+    MAFW_METADATA_KEY_GENRE,                         // GenreRole
+    0,                                               // IdRole
+    MAFW_METADATA_KEY_MIME,                          // MimeTypeRole
+    MAFW_METADATA_KEY_THUMBNAIL_URI,                 // ThumbnailUrlRole
+    MAFW_METADATA_KEY_TITLE,                         // TitleRole
+    MAFW_METADATA_KEY_TRACK,                         // TrackNumberRole
+    MAFW_METADATA_KEY_URI,                           // UrlRole
+    MAFW_METADATA_KEY_YEAR                           // YearRole
+};
+
+struct QchMediaLibraryItem
+{
+    QString id;
+    QVariant values[ROLE_COUNT];
+};
+
+typedef QVector<QchMediaLibraryItem> QchMediaLibraryPage;
+
+class QchMediaLibraryModelPrivate
+{
+
+public:
+    QchMediaLibraryModelPrivate(QchMediaLibraryModel *parent) :
+        q_ptr(parent),
+        source(0),
+        sourceId("localtagfs"),
+        objectId("localtagfs::music/songs"),
+        pageSize(DEFAULT_PAGE_SIZE),
+        cachedPages(DEFAULT_CACHED_PAGES),
+        count(0),
+        appendPage(-1),
+        atEnd(false),
+        fetchMorePending(false),
+        fetchPagesPending(false),
+        loading(false),
+        complete(false)
+    {
+        for (int i = 0; i < ROLE_COUNT; i++) {
+            if (ROLE_METADATA_KEYS[i]) {
+                metadataKeys.append(ROLE_METADATA_KEYS[i]);
+            }
+        }
+
+        metadataKeys.append(0);
+    }
+
+    static QVariant toVariant(GValue *v) {
+        if (!v) {
+            return QVariant();
+        }
+
+        switch (G_VALUE_TYPE(v)) {
+        case G_TYPE_STRING:
+            return QString::fromUtf8(g_value_get_string(v));
+        case G_TYPE_INT:
+            return g_value_get_int(v);
+        case G_TYPE_UINT:
+            return g_value_get_uint(v);
+        case G_TYPE_LONG:
+            return qlonglong(g_value_get_long(v));
+        case G_TYPE_INT64:
+            return qlonglong(g_value_get_int64(v));
+        case G_TYPE_BOOLEAN:
+            return bool(g_value_get_boolean(v));
+        case G_TYPE_DOUBLE:
+            return g_value_get_double(v);
+        default:
+            return QVariant();
+        }
+    }
+
+    void setSource(const QString &uuid) {
+        Q_Q(QchMediaLibraryModel);
+
+        cancelBrowses();
+
+        if (source) {
+            delete source;
+            source = 0;
+        }
+
+        if (!uuid.isEmpty()) {
+            source = new MafwSourceAdapter(uuid);
+            q->connect(source, SIGNAL(containerChanged(QString)), q, SLOT(_q_onContainerChanged(QString)));
+            q->connect(source, SIGNAL(browseResult(uint, int, uint, QString, GHashTable*, QString)),
+                       q, SLOT(_q_onBrowseResult(uint, int, uint, QString, GHashTable*, QString)));
+        }
+    }
+
+    void setRequiredRoles(const QStringList &names) {
+        Q_Q(QchMediaLibraryModel);
+
+        requiredRoles = names;
+        metadataKeys.clear();
+        const QHash<int, QByteArray> roles = q->roleNames();
+
+        for (int i = 0; i < ROLE_COUNT; i++) {
+            const char *key = ROLE_METADATA_KEYS[i];
+
+            if ((key) && ((names.isEmpty()) || (names.contains(QString::fromUtf8(roles.value(i + QchMediaLibraryModel::AlbumTitleRole)))))) {
+                metadataKeys.append(key);
+            }
+        }
+
+        foreach (const QString &name, names) {
+            if (!roles.values().contains(name.toUtf8())) {
+                qmlInfo(q) << QchMediaLibraryModel::tr("Role %1 does not exist").arg(name);
+            }
+        }
+
+        // MAFW treats an empty key list as a request for every key, so always ask for at least the title
+        if (metadataKeys.isEmpty()) {
+            metadataKeys.append(MAFW_METADATA_KEY_TITLE);
+        }
+
+        metadataKeys.append(0);
+    }
+
+    void cancelBrowses() {
+        if ((source) && (source->isReady())) {
+            foreach (uint browseId, browses.keys()) {
+                source->cancelBrowse(browseId);
+            }
+        }
+
+        browses.clear();
+        pendingPages.clear();
+        requestedPages.clear();
+        appendPage = -1;
+        fetchMorePending = false;
+        fetchPagesPending = false;
+    }
+
+    bool browse(int page) {
+        if ((!source) || (!source->isReady()) || (objectId.isEmpty())) {
+            return false;
+        }
+
+        const QByteArray filterString = filter.toUtf8();
+        const QByteArray sortString = sortCriteria.toUtf8();
+        const uint browseId = source->browse(objectId, false, filter.isEmpty() ? 0 : filterString.constData(),
+                                             sortCriteria.isEmpty() ? 0 : sortString.constData(),
+                                             metadataKeys.constData(), page * pageSize, pageSize);
+
+        if (browseId == MAFW_SOURCE_INVALID_BROWSE_ID) {
+            return false;
+        }
+
+        browses.insert(browseId, page);
+        pendingPages[browseId].reserve(pageSize);
+        setLoading(true);
+        return true;
+    }
+
+    void requestPage(int page) const {
+        if ((requestedPages.contains(page)) || (browses.values().contains(page))) {
+            return;
+        }
+
+        requestedPages.insert(page);
+
+        if (!fetchPagesPending) {
+            fetchPagesPending = true;
+            QMetaObject::invokeMethod(q_ptr, "_q_fetchPages", Qt::QueuedConnection);
+        }
+    }
+
+    void requestMore() const {
+        if ((!fetchMorePending) && (appendPage == -1) && (!atEnd)) {
+            fetchMorePending = true;
+            QMetaObject::invokeMethod(q_ptr, "_q_fetchMore", Qt::QueuedConnection);
+        }
+    }
+
+    const QchMediaLibraryItem* item(int row) const {
+        const int page = row / pageSize;
+        QHash<int, QchMediaLibraryPage>::const_iterator iterator = pages.constFind(page);
+
+        if (iterator == pages.constEnd()) {
+            requestPage(page);
+            return 0;
+        }
+
+        touchPage(page);
+        const int offset = row - page * pageSize;
+        return offset < iterator.value().size() ? &iterator.value().at(offset) : 0;
+    }
+
+    void touchPage(int page) const {
+        if ((pageOrder.isEmpty()) || (pageOrder.last() != page)) {
+            pageOrder.removeOne(page);
+            pageOrder.append(page);
+        }
+    }
+
+    void evictPages() {
+        while ((pages.size() > cachedPages) && (!pageOrder.isEmpty())) {
+            pages.remove(pageOrder.takeFirst());
+        }
+    }
+
+    void setLoading(bool isLoading) {
+        if (isLoading != loading) {
+            Q_Q(QchMediaLibraryModel);
+            loading = isLoading;
+            emit q->loadingChanged();
+        }
+    }
+
+    void reload() {
+        Q_Q(QchMediaLibraryModel);
+
+        cancelBrowses();
+        q->beginResetModel();
+        pages.clear();
+        pageOrder.clear();
+        const bool changed = (count != 0);
+        count = 0;
+        atEnd = false;
+        q->endResetModel();
+
+        if (changed) {
+            emit q->countChanged();
+        }
+
+        setLoading(false);
+        _q_fetchMore();
+    }
+
+    // A failed page is discarded, so that it is browsed again when it is next needed
+    void finishPage(uint browseId, bool failed = false) {
+        Q_Q(QchMediaLibraryModel);
+
+        const int page = browses.take(browseId);
+        QchMediaLibraryPage items = pendingPages.take(browseId);
+        const int first = page * pageSize;
+
+        if (failed) {
+            if (page == appendPage) {
+                appendPage = -1;
+            }
+        }
+        else if (page == appendPage) {
+            appendPage = -1;
+            atEnd = (items.size() < pageSize);
+
+            if (!items.isEmpty()) {
+                q->beginInsertRows(QModelIndex(), count, count + items.size() - 1);
+                pages.insert(page, items);
+                touchPage(page);
+                count += items.size();
+                q->endInsertRows();
+                emit q->countChanged();
+            }
+        }
+        else if (first < count) {
+            const int last = qMin(first + items.size(), count) - 1;
+            pages.insert(page, items);
+            touchPage(page);
+
+            if (last >= first) {
+                emit q->dataChanged(q->index(first, 0), q->index(last, 0));
+            }
+        }
+
+        evictPages();
+
+        if (browses.isEmpty()) {
+            setLoading(false);
+        }
+    }
+
+    void _q_onContainerChanged(const QString &id) {
+        if ((complete) && ((id == objectId) || ((source) && (id == source->uuid() + "::")))) {
+            reload();
+        }
+    }
+
+    void _q_onBrowseResult(uint browseId, int remainingCount, uint, const QString &id, GHashTable *metadata,
+                           const QString &error) {
+        if (!browses.contains(browseId)) {
+            return;
+        }
+
+        if (!error.isEmpty()) {
+            Q_Q(QchMediaLibraryModel);
+            qmlInfo(q) << error;
+            finishPage(browseId, true);
+            return;
+        }
+
+        if (!id.isEmpty()) {
+            QchMediaLibraryItem item;
+            item.id = id;
+
+            if (metadata) {
+                for (int i = 0; i < ROLE_COUNT; i++) {
+                    if (ROLE_METADATA_KEYS[i]) {
+                        item.values[i] = toVariant(mafw_metadata_first(metadata, ROLE_METADATA_KEYS[i]));
+                    }
+                }
+            }
+
+            pendingPages[browseId].append(item);
+        }
+
+        if (remainingCount == 0) {
+            finishPage(browseId);
+        }
+    }
+
+    void _q_fetchMore() {
+        fetchMorePending = false;
+
+        if ((appendPage != -1) || (atEnd)) {
+            return;
+        }
+
+        // Rows are only ever appended a whole page at a time, so the next page starts at count
+        const int page = count / pageSize;
+
+        if (browse(page)) {
+            appendPage = page;
+        }
+    }
+
+    void _q_fetchPages() {
+        fetchPagesPending = false;
+
+        foreach (int page, requestedPages) {
+            if ((!pages.contains(page)) && (page * pageSize < count)) {
+                browse(page);
+            }
+        }
+
+        requestedPages.clear();
+    }
+
+    QchMediaLibraryModel *q_ptr;
+
+    MafwSourceAdapter *source;
+
+    QString sourceId;
+    QString objectId;
+    QString filter;
+    QString sortCriteria;
+
+    QStringList requiredRoles;
+    QVector<const char*> metadataKeys;
+
+    int pageSize;
+    int cachedPages;
+    int count;
+    int appendPage;
+
+    QHash<int, QchMediaLibraryPage> pages;
+    mutable QList<int> pageOrder;
+
+    QHash<uint, int> browses;
+    QHash<uint, QchMediaLibraryPage> pendingPages;
+    mutable QSet<int> requestedPages;
+
+    bool atEnd;
+    mutable bool fetchMorePending;
+    mutable bool fetchPagesPending;
+    bool loading;
+    bool complete;
+
+    Q_DECLARE_PUBLIC(QchMediaLibraryModel)
+};
+
+/*!
+    \class MediaLibraryModel
+    \brief Provides the contents of a MAFW source container.
+
+    \ingroup multimedia
+
+    The MediaLibraryModel component browses a container of a MAFW source, such as the songs, albums or
+    videos of the media library. Items are requested from the source one page at a time as the view
+    approaches the end of the loaded rows, so large containers open without loading every item first.
+
+    Only a bounded number of pages (see cachedPages) is kept in memory. When a row of a page that has
+    been discarded is read again, that page is requested from the source again and the row is updated
+    when the results arrive.
+
+    Example:
+
+    \code
+    import QtQuick 1.0
+    import org.hildon.components 1.0
+    import org.hildon.multimedia 1.0
+
+    Window {
+        id: window
+
+        title: "Songs"
+        visible: true
+
+        ListView {
+            id: view
+
+            anchors.fill: parent
+            model: MediaLibraryModel {
+                id: library
+
+                objectId: "localtagfs::music/songs"
+                sortCriteria: "+title"
+                requiredRoles: ["title", "artist", "duration"]
+            }
+            delegate: ListItem {
+                Label {
+                    anchors {
+                        fill: parent
+                        margins: platformStyle.paddingMedium
+                    }
+                    verticalAlignment: Text.AlignVCenter
+                    text: title + " - " + artist
+                }
+            }
+        }
+    }
+    \endcode
+
+    \sa NowPlayingModel
+*/
+QchMediaLibraryModel::QchMediaLibraryModel(QObject *parent) :
+    QAbstractListModel(parent),
+    d_ptr(new QchMediaLibraryModelPrivate(this))
+{
+    QHash<int, QByteArray> roles;
+    roles[AlbumTitleRole] = "albumTitle";
+    roles[ArtistRole] = "artist";
+    roles[ChildCountRole] = "childCount";
+    roles[CoverArtUrlRole] = "coverArtUrl";
+    roles[DurationRole] = "duration";
+    roles[GenreRole] = "genre";
+    roles[IdRole] = "id";
+    roles[MimeTypeRole] = "mimeType";
+    roles[ThumbnailUrlRole] = "thumbnailUrl";
+    roles[TitleRole] = "title";
+    roles[TrackNumberRole] = "trackNumber";
+    roles[UrlRole] = "url";
+    roles[YearRole] = "year";
+    setRoleNames(roles);
+}
+
+QchMediaLibraryModel::~QchMediaLibraryModel() {
+    Q_D(QchMediaLibraryModel);
+
+    d->setSource(QString());
+}
+
+/*!
+    \property int MediaLibraryModel::count
+    \brief The number of items that have been loaded into the model.
+
+    This increases as further pages are requested from the source.
+*/
+
+/*!
+    \brief The UUID of the MAFW source to be browsed.
+
+    The default value is \c localtagfs (the media library).
+*/
+QString QchMediaLibraryModel::source() const {
+    Q_D(const QchMediaLibraryModel);
+
+    return d->sourceId;
+}
+
+void QchMediaLibraryModel::setSource(const QString &uuid) {
+    if (uuid != source()) {
+        Q_D(QchMediaLibraryModel);
+        d->sourceId = uuid;
+        emit sourceChanged();
+
+        if (d->complete) {
+            d->setSource(uuid);
+            d->reload();
+        }
+    }
+}
+
+/*!
+    \brief The id of the container to be browsed.
+
+    The default value is \c localtagfs::music/songs.
+*/
+QString QchMediaLibraryModel::objectId() const {
+    Q_D(const QchMediaLibraryModel);
+
+    return d->objectId;
+}
+
+void QchMediaLibraryModel::setObjectId(const QString &id) {
+    if (id != objectId()) {
+        Q_D(QchMediaLibraryModel);
+        d->objectId = id;
+        emit objectIdChanged();
+
+        if (d->complete) {
+            d->reload();
+        }
+    }
+}
+
+/*!
+    \brief The MAFW filter applied to the items of the container.
+
+    Example:
+
+    \code
+    MediaLibraryModel {
+        filter: "(artist=Queen)"
+    }
+    \endcode
+*/
+QString QchMediaLibraryModel::filter() const {
+    Q_D(const QchMediaLibraryModel);
+
+    return d->filter;
+}
+
+void QchMediaLibraryModel::setFilter(const QString &filter) {
+    if (filter != this->filter()) {
+        Q_D(QchMediaLibraryModel);
+        d->filter = filter;
+        emit filterChanged();
+
+        if (d->complete) {
+            d->reload();
+        }
+    }
+}
+
+/*!
+    \brief The MAFW sort criteria used to order the items of the container.
+
+    Example:
+
+    \code
+    MediaLibraryModel {
+        sortCriteria: "+artist,+title"
+    }
+    \endcode
+*/
+QString QchMediaLibraryModel::sortCriteria() const {
+    Q_D(const QchMediaLibraryModel);
+
+    return d->sortCriteria;
+}
+
+void QchMediaLibraryModel::setSortCriteria(const QString &criteria) {
+    if (criteria != sortCriteria()) {
+        Q_D(QchMediaLibraryModel);
+        d->sortCriteria = criteria;
+        emit sortCriteriaChanged();
+
+        if (d->complete) {
+            d->reload();
+        }
+    }
+}
+
+/*!
+    \brief The names of the roles that are loaded for every item.
+
+    Only the metadata needed for these roles is requested from the source. Roles that are not in the list
+    are left empty. An empty list (the default) loads all roles.
+*/
+QStringList QchMediaLibraryModel::requiredRoles() const {
+    Q_D(const QchMediaLibraryModel);
+
+    return d->requiredRoles;
+}
+
+void QchMediaLibraryModel::setRequiredRoles(const QStringList &roles) {
+    if (roles != requiredRoles()) {
+        Q_D(QchMediaLibraryModel);
+        d->setRequiredRoles(roles);
+        emit requiredRolesChanged();
+
+        if (d->complete) {
+            d->reload();
+        }
+    }
+}
+
+/*!
+    \brief The number of items requested from the source in each browse operation.
+
+    The default value is \c 100.
+*/
+int QchMediaLibraryModel::pageSize() const {
+    Q_D(const QchMediaLibraryModel);
+
+    return d->pageSize;
+}
+
+void QchMediaLibraryModel::setPageSize(int size) {
+    size = qMax(1, size);
+
+    if (size != pageSize()) {
+        Q_D(QchMediaLibraryModel);
+        d->pageSize = size;
+        emit pageSizeChanged();
+
+        if (d->complete) {
+            d->reload();
+        }
+    }
+}
+
+/*!
+    \brief The maximum number of pages that are kept in memory.
+
+    The least recently read pages are discarded first. The default value is \c 10.
+*/
+int QchMediaLibraryModel::cachedPages() const {
+    Q_D(const QchMediaLibraryModel);
+
+    return d->cachedPages;
+}
+
+void QchMediaLibraryModel::setCachedPages(int pages) {
+    pages = qMax(1, pages);
+
+    if (pages != cachedPages()) {
+        Q_D(QchMediaLibraryModel);
+        d->cachedPages = pages;
+        d->evictPages();
+        emit cachedPagesChanged();
+    }
+}
+
+/*!
+    \property bool MediaLibraryModel::loading
+    \brief Whether items are currently being requested from the source.
+*/
+bool QchMediaLibraryModel::isLoading() const {
+    Q_D(const QchMediaLibraryModel);
+
+    return d->loading;
+}
+
+int QchMediaLibraryModel::rowCount(const QModelIndex &parent) const {
+    Q_D(const QchMediaLibraryModel);
+
+    return parent.isValid() ? 0 : d->count;
+}
+
+QVariant QchMediaLibraryModel::data(const QModelIndex &index, int role) const {
+    Q_D(const QchMediaLibraryModel);
+
+    if ((!index.isValid()) || (index.row() >= d->count)) {
+        return QVariant();
+    }
+
+    // Request the next page before the view reaches the end of the loaded rows
+    if (index.row() >= d->count - d->pageSize / 2) {
+        d->requestMore();
+    }
+
+    const QchMediaLibraryItem *item = d->item(index.row());
+
+    if (!item) {
+        return QVariant();
+    }
+
+    if (role == Qt::DisplayRole) {
+        role = TitleRole;
+    }
+
+    if (role == IdRole) {
+        return item->id;
+    }
+
+    if ((role >= AlbumTitleRole) && (role <= YearRole)) {
+        return item->values[role - AlbumTitleRole];
+    }
+
+    return QVariant();
+}
+
+bool QchMediaLibraryModel::canFetchMore(const QModelIndex &parent) const {
+    Q_D(const QchMediaLibraryModel);
+
+    return (!parent.isValid()) && (d->complete) && (!d->atEnd);
+}
+
+void QchMediaLibraryModel::fetchMore(const QModelIndex &parent) {
+    if (!parent.isValid()) {
+        Q_D(QchMediaLibraryModel);
+        d->_q_fetchMore();
+    }
+}
+
+/*!
+    \brief Returns the value of the role with the specified \a name for the item at \a row.
+
+    If the page containing \a row has been discarded, an undefined value is returned and the page is
+    requested from the source again.
+*/
+QVariant QchMediaLibraryModel::property(int row, const QString &name) {
+    return data(index(row, 0), roleNames().key(name.toUtf8()));
+}
+
+/*!
+    \brief Discards all items and browses the container again from the start.
+*/
+void QchMediaLibraryModel::reload() {
+    Q_D(QchMediaLibraryModel);
+
+    if (d->complete) {
+        d->reload();
+    }
+}
+
+void QchMediaLibraryModel::classBegin() {}
+
+void QchMediaLibraryModel::componentComplete() {
+    Q_D(QchMediaLibraryModel);
+
+    d->complete = true;
+    d->setSource(d->sourceId);
+    d->reload();
+}
+
+#include "moc_qchmedialibrarymodel.cpp"
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2016 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QCHMEDIALIBRARYMODEL_H
+#define QCHMEDIALIBRARYMODEL_H
+
+#include <QAbstractListModel>
+#include <QDeclarativeParserStatus>
+#include <QStringList>
+#include <qdeclarative.h>
+
+class QchMediaLibraryModelPrivate;
+
+class QchMediaLibraryModel : public QAbstractListModel, public QDeclarativeParserStatus
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(QString source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(QString objectId READ objectId WRITE setObjectId NOTIFY objectIdChanged)
+    Q_PROPERTY(QString filter READ filter WRITE setFilter NOTIFY filterChanged)
+    Q_PROPERTY(QString sortCriteria READ sortCriteria WRITE setSortCriteria NOTIFY sortCriteriaChanged)
+    Q_PROPERTY(QStringList requiredRoles READ requiredRoles WRITE setRequiredRoles NOTIFY requiredRolesChanged)
+    Q_PROPERTY(int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged)
+    Q_PROPERTY(int cachedPages READ cachedPages WRITE setCachedPages NOTIFY cachedPagesChanged)
+    Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+
+    Q_INTERFACES(QDeclarativeParserStatus)
+
+public:
+    enum Roles {
+        AlbumTitleRole = Qt::UserRole + 1,
+        ArtistRole,
+        ChildCountRole,
+        CoverArtUrlRole,
+        DurationRole,
+        GenreRole,
+        IdRole,
+        MimeTypeRole,
+        ThumbnailUrlRole,
+        TitleRole,
+        TrackNumberRole,
+        UrlRole,
+        YearRole
+    };
+
+    explicit QchMediaLibraryModel(QObject *parent = 0);
+    ~QchMediaLibraryModel();
+
+    QString source() const;
+    void setSource(const QString &uuid);
+
+    QString objectId() const;
+    void setObjectId(const QString &id);
+
+    QString filter() const;
+    void setFilter(const QString &filter);
+
+    QString sortCriteria() const;
+    void setSortCriteria(const QString &criteria);
+
+    QStringList requiredRoles() const;
+    void setRequiredRoles(const QStringList &roles);
+
+    int pageSize() const;
+    void setPageSize(int size);
+
+    int cachedPages() const;
+    void setCachedPages(int pages);
+
+    bool isLoading() const;
+
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+    virtual bool canFetchMore(const QModelIndex &parent) const;
+    virtual void fetchMore(const QModelIndex &parent);
+
+    Q_INVOKABLE QVariant property(int row, const QString &name);
+
+public Q_SLOTS:
+    void reload();
+
+Q_SIGNALS:
+    void countChanged();
+    void sourceChanged();
+    void objectIdChanged();
+    void filterChanged();
+    void sortCriteriaChanged();
+    void requiredRolesChanged();
+    void pageSizeChanged();
+    void cachedPagesChanged();
+    void loadingChanged();
+
+private:
+    virtual void classBegin();
+    virtual void componentComplete();
+
+    QScopedPointer<QchMediaLibraryModelPrivate> d_ptr;
+
+    Q_DECLARE_PRIVATE(QchMediaLibraryModel)
+    Q_DISABLE_COPY(QchMediaLibraryModel)
+
+    Q_PRIVATE_SLOT(d_func(), void _q_onContainerChanged(QString))
+    Q_PRIVATE_SLOT(d_func(), void _q_onBrowseResult(uint,int,uint,QString,GHashTable*,QString))
+    Q_PRIVATE_SLOT(d_func(), void _q_fetchMore())
+    Q_PRIVATE_SLOT(d_func(), void _q_fetchPages())
+};
+
+QML_DECLARE_TYPE(QchMediaLibraryModel)
+
+#endif // QCHMEDIALIBRARYMODEL_H
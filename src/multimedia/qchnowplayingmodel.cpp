@@ -15,11 +15,204 @@
  */
  
 #include "qchnowplayingmodel.h"
+#include "mediaobjectid.h"
+#include "metadatacache.h"
 #include "playlistquerymanager.h"
 #include "mafw/mafwregistryadapter.h"
-#include <libgnomevfs/gnome-vfs-mime-utils.h>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDBusConnection>
+#include <QDeclarativeInfo>
+#include <QDir>
+#include <QSet>
+#include <QSize>
+#include <QTimerEvent>
+#include <QVector>
 #include <GConfItem>
+#ifdef NOWPLAYINGMODEL_DEBUG
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#endif
+
+// The maximum time that metadata results are held back before being announced, when a batch takes longer
+static const int UPDATE_INTERVAL = 100;
+// The delay before new metadata is written to the persistent cache
+static const int CACHE_SAVE_INTERVAL = 30000;
+// The age in seconds after which cached metadata is refreshed from MAFW
+static const uint CACHE_MAX_AGE = 86400;
+
+// The role mask of items for which every metadata key has been fetched
+static const quint32 ALL_ROLES = 0xffffffff;
+
+// The MAFW metadata keys required by each role, indexed from AlbumArtistRole
+static const char* const ROLE_METADATA_KEYS[][2] = {
+    { MAFW_METADATA_KEY_ARTIST, 0 },                 // AlbumArtistRole
+    { MAFW_METADATA_KEY_ALBUM, 0 },                  // AlbumTitleRole
+    { MAFW_METADATA_KEY_ARTIST, 0 },                 // ArtistRole
+    { MAFW_METADATA_KEY_AUDIO_BITRATE, 0 },          // AudioBitRateRole
+    { MAFW_METADATA_KEY_AUDIO_CODEC, 0 },            // AudioCodecRole
+    { MAFW_METADATA_KEY_COMMENT, 0 },                // CommentRole
+    { MAFW_METADATA_KEY_COMPOSER, 0 },               // ComposerRole
+    { MAFW_METADATA_KEY_COPYRIGHT, 0 },              // CopyrightRole
+    { MAFW_METADATA_KEY_ALBUM_ART_URI, 0 },          // CoverArtUrlRole
+    { MAFW_METADATA_KEY_MODIFIED, 0 },               // DateRole
+    { MAFW_METADATA_KEY_DESCRIPTION, 0 },            // DescriptionRole
+    { MAFW_METADATA_KEY_DURATION, 0 },               // DurationRole
+    { MAFW_METADATA_KEY_GENRE, 0 },                  // GenreRole
+    { 0, 0 },                                        // IdRole
+    { MAFW_METADATA_KEY_TAGS, 0 },                   // KeywordsRole
+    { MAFW_METADATA_KEY_LAST_PLAYED, 0 },            // LastPlayedRole
+    { MAFW_METADATA_KEY_PAUSED_THUMBNAIL_URI, 0 },   // LastThumbnailUrlRole
+    { MAFW_METADATA_KEY_LYRICS, 0 },                 // LyricsRole
+    { MAFW_METADATA_KEY_MIME, 0 },                   // MimeTypeRole
+    { MAFW_METADATA_KEY_ORGANIZATION, 0 },           // OrganizationRole
+    { MAFW_METADATA_KEY_PLAY_COUNT, 0 },             // PlayCountRole
+    { MAFW_METADATA_KEY_RES_X, MAFW_METADATA_KEY_RES_Y }, // ResolutionRole
+    { MAFW_METADATA_KEY_PAUSED_POSITION, 0 },        // ResumePositionRole
+    { MAFW_METADATA_KEY_FILESIZE, 0 },               // SizeRole
+    { MAFW_METADATA_KEY_THUMBNAIL_URI, 0 },          // ThumbnailUrlRole
+    { MAFW_METADATA_KEY_TITLE, 0 },                  // TitleRole
+    { MAFW_METADATA_KEY_TRACK, 0 },                  // TrackNumberRole
+    { MAFW_METADATA_KEY_URI, 0 },                    // UrlRole
+    { MAFW_METADATA_KEY_VIDEO_BITRATE, 0 },          // VideoBitRateRole
+    { MAFW_METADATA_KEY_VIDEO_CODEC, 0 },            // VideoCodecRole
+    { MAFW_METADATA_KEY_VIDEO_FRAMERATE, 0 },        // VideoFrameRateRole
+    { MAFW_METADATA_KEY_YEAR, 0 }                    // YearRole
+};
+
+static inline quint32 roleBit(int role) {
+    return 1u << (role - QchNowPlayingModel::AlbumArtistRole);
+}
+
+// The roles whose values change during playback, which are never trusted from the persistent cache
+static const quint32 VOLATILE_ROLES = roleBit(QchNowPlayingModel::LastPlayedRole)
+                                      | roleBit(QchNowPlayingModel::LastThumbnailUrlRole)
+                                      | roleBit(QchNowPlayingModel::PlayCountRole)
+                                      | roleBit(QchNowPlayingModel::ResumePositionRole);
+
+static MetadataCache *metadataCache = 0;
+
+static void deleteMetadataCache() {
+    delete metadataCache;
+    metadataCache = 0;
+}
+
+static MetadataCache* getMetadataCache() {
+    if (!metadataCache) {
+        metadataCache = new MetadataCache(QDir::homePath() + "/.cache/qchmultimedia/playlistmetadata");
+        qAddPostRoutine(deleteMetadataCache);
+    }
+    
+    return metadataCache;
+}
+
+#ifdef NOWPLAYINGMODEL_DEBUG
+// Returns the peak resident set size of the process in kB, as reported by the kernel
+static int peakMemoryUsage() {
+    QFile file("/proc/self/status");
+    
+    if (file.open(QFile::ReadOnly)) {
+        QByteArray line;
+        
+        while (!(line = file.readLine()).isEmpty()) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ').first().toInt();
+            }
+        }
+    }
+    
+    return 0;
+}
+#endif
+
+/*
+ * Rarely populated text fields. These are only allocated for tracks that actually carry one of them, 
+ * so that the common case costs a single null pointer per row.
+ */
+struct QchNowPlayingItemExtra
+{
+    QString comment;
+    QString composer;
+    QString copyright;
+    QString description;
+    QString keywords;
+    QString lyrics;
+    QString organization;
+};
+
+/*
+ * The per-row record. Strings that are typically shared between many tracks (artist, album, genre, 
+ * codecs and mime type) are interned by the model, so each distinct value is stored only once.
+ */
+struct QchNowPlayingItem
+{
+    QchNowPlayingItem(const QString &id) :
+        id(id),
+        extra(0),
+        date(0),
+        lastPlayed(0),
+        audioBitRate(0),
+        duration(0),
+        playCount(0),
+        resumePosition(0),
+        size(0),
+        videoBitRate(0),
+        resX(0),
+        resY(0),
+        trackNumber(0),
+        videoFrameRate(0),
+        year(0),
+        roles(0),
+        loaded(false),
+        lazyRequested(false)
+    {
+    }
+    
+    ~QchNowPlayingItem() {
+        delete extra;
+    }
+    
+    QString id;
+    QString title;
+    QString artist;
+    QString albumTitle;
+    QString genre;
+    QString audioCodec;
+    QString videoCodec;
+    QString mimeType;
+    QString url;
+    QString coverArtUrl;
+    QString thumbnailUrl;
+    QString lastThumbnailUrl;
+    
+    QchNowPlayingItemExtra *extra;
+    
+    qint64 date;
+    qint64 lastPlayed;
+    
+    int audioBitRate;
+    int duration;
+    int playCount;
+    int resumePosition;
+    int size;
+    int videoBitRate;
+    
+    quint16 resX;
+    quint16 resY;
+    quint16 trackNumber;
+    quint16 videoFrameRate;
+    quint16 year;
+    
+    quint32 roles;
+    
+    bool loaded;
+    bool lazyRequested;
+    
+private:
+    Q_DISABLE_COPY(QchNowPlayingItem)
+};
 
 class QchNowPlayingModelPrivate
 {
@@ -30,33 +223,192 @@ public:
         mafwRegistry(0),
         mafwRenderer(0),
         mafwPlaylist(0),
-        mafwTrackerSource(0),
         gconfItem(0),
         mediaType(QchMediaType::Audio),
         position(0),
+        updateTimerId(0),
+        cacheTimerId(0),
+        requiredMask(ALL_ROLES),
+        lazyFetchPending(false),
+#ifdef NOWPLAYINGMODEL_DEBUG
+        loadPending(0),
+        loadDataNotifications(0),
+        loadMetadataStarted(false),
+#endif
         repeat(false),
         shuffle(false),
         playlistAssigned(false),
         complete(false)
     {
     }
+    
+    ~QchNowPlayingModelPrivate() {
+        qDeleteAll(items);
+        
+        // After the application has quit, the cache has already been saved and deleted
+        if ((cacheTimerId) && (metadataCache)) {
+            metadataCache->save();
+        }
+    }
+    
+    QString intern(const QString &value) {
+        if (value.isEmpty()) {
+            return QString();
+        }
+        
+        QSet<QString>::const_iterator iterator = strings.constFind(value);
+        
+        if (iterator != strings.constEnd()) {
+            return *iterator;
+        }
+        
+        strings.insert(value);
+        return value;
+    }
+    
+    static QString metadataString(GHashTable *metadata, const char *key) {
+        GValue *v = mafw_metadata_first(metadata, key);
+        return v ? QString::fromUtf8(g_value_get_string(v)) : QString();
+    }
+    
+    static int metadataInt(GHashTable *metadata, const char *key) {
+        GValue *v = mafw_metadata_first(metadata, key);
+        return v ? g_value_get_int(v) : 0;
+    }
+    
+    static qint64 metadataInt64(GHashTable *metadata, const char *key) {
+        GValue *v = mafw_metadata_first(metadata, key);
+        return v ? g_value_get_int64(v) : 0;
+    }
+    
+    bool readCachedItem(QchNowPlayingItem *item) {
+        uint timestamp = 0;
+        const QByteArray data = getMetadataCache()->value(item->id, &timestamp);
+        
+        if (data.isEmpty()) {
+            return false;
+        }
+        
+        QDataStream stream(data);
+        QchNowPlayingItemExtra extra;
+        stream >> item->title >> item->artist >> item->albumTitle >> item->genre >> item->audioCodec
+               >> item->videoCodec >> item->mimeType >> item->url >> item->coverArtUrl >> item->thumbnailUrl
+               >> item->lastThumbnailUrl >> item->date >> item->lastPlayed >> item->audioBitRate >> item->duration
+               >> item->playCount >> item->resumePosition >> item->size >> item->videoBitRate >> item->resX
+               >> item->resY >> item->trackNumber >> item->videoFrameRate >> item->year >> extra.comment
+               >> extra.composer >> extra.copyright >> extra.description >> extra.keywords >> extra.lyrics
+               >> extra.organization >> item->roles;
+        
+        if (stream.status() != QDataStream::Ok) {
+            getMetadataCache()->remove(item->id);
+            return false;
+        }
+        
+        item->artist = intern(item->artist);
+        item->albumTitle = intern(item->albumTitle);
+        item->genre = intern(item->genre);
+        item->audioCodec = intern(item->audioCodec);
+        item->videoCodec = intern(item->videoCodec);
+        item->mimeType = intern(item->mimeType);
+        item->coverArtUrl = intern(item->coverArtUrl);
+        extra.composer = intern(extra.composer);
+        extra.organization = intern(extra.organization);
+        setItemExtra(item, extra);
+        // Volatile values are always fetched from MAFW, either with the row or lazily on access
+        item->lastThumbnailUrl = QString();
+        item->lastPlayed = 0;
+        item->playCount = 0;
+        item->resumePosition = 0;
+        item->roles &= ~VOLATILE_ROLES;
+        item->loaded = true;
+        return ((item->roles & requiredMask) == (requiredMask & ~VOLATILE_ROLES))
+               && (QDateTime::currentDateTime().toTime_t() - timestamp < CACHE_MAX_AGE);
+    }
+    
+    void writeCachedItem(const QchNowPlayingItem *item) {
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        const QchNowPlayingItemExtra extra = item->extra ? *item->extra : QchNowPlayingItemExtra();
+        stream << item->title << item->artist << item->albumTitle << item->genre << item->audioCodec
+               << item->videoCodec << item->mimeType << item->url << item->coverArtUrl << item->thumbnailUrl
+               << item->lastThumbnailUrl << item->date << item->lastPlayed << item->audioBitRate << item->duration
+               << item->playCount << item->resumePosition << item->size << item->videoBitRate << item->resX
+               << item->resY << item->trackNumber << item->videoFrameRate << item->year << extra.comment
+               << extra.composer << extra.copyright << extra.description << extra.keywords << extra.lyrics
+               << extra.organization << item->roles;
+        getMetadataCache()->insert(item->id, data);
+        
+        if (!cacheTimerId) {
+            Q_Q(QchNowPlayingModel);
+            cacheTimerId = q->startTimer(CACHE_SAVE_INTERVAL);
+        }
+    }
+    
+    static void setItemExtra(QchNowPlayingItem *item, const QchNowPlayingItemExtra &extra) {
+        if ((extra.comment.isEmpty()) && (extra.composer.isEmpty()) && (extra.copyright.isEmpty())
+            && (extra.description.isEmpty()) && (extra.keywords.isEmpty()) && (extra.lyrics.isEmpty())
+            && (extra.organization.isEmpty())) {
+            delete item->extra;
+            item->extra = 0;
+        }
+        else if (item->extra) {
+            *item->extra = extra;
+        }
+        else {
+            item->extra = new QchNowPlayingItemExtra(extra);
+        }
+    }
+    
+    void saveCache() {
+        if (cacheTimerId) {
+            Q_Q(QchNowPlayingModel);
+            q->killTimer(cacheTimerId);
+            cacheTimerId = 0;
+        }
+        
+        getMetadataCache()->save();
+    }
+    
+    void clear() {
+        Q_Q(QchNowPlayingModel);
+        
+        flushUpdates();
+        
+        if (items.isEmpty()) {
+            return;
+        }
+        
+        q->beginResetModel();
+        qDeleteAll(items);
+        items.clear();
+        strings.clear();
+        q->endResetModel();
+        emit q->countChanged();
+    }
    
-    QString uriToId(QString uri) const {
-        if (uri.startsWith("/")) {
-            uri.prepend("file://");
+    void enqueueSources(int row, const QStringList &uris) {
+        const QList<QByteArray> ids = MediaObjectId::fromUris(uris);
+        
+        if (ids.isEmpty()) {
+            return;
         }
         
-        QString objectId = mafwTrackerSource->createObjectId(uri);
+        QVector<const gchar*> oids;
+        oids.reserve(ids.size() + 1);
         
-        if (uri.startsWith("file://")) {
-            QString mime(gnome_vfs_get_mime_type_for_name(uri.toUtf8()));
-            objectId = objectId.remove(0, 18) // "urisource::file://"
-                               .replace("/", "%2F")
-                               .prepend(QString("localtagfs::%1/")
-                               .arg(mime.startsWith("video") ? "videos" : "music/songs"));
+        foreach (const QByteArray &id, ids) {
+            oids.append(id.constData());
         }
         
-        return objectId;
+        oids.append(NULL);
+        _q_assignPlaylist();
+        
+        if ((row < 0) || (row >= items.size())) {
+            mafwPlaylist->appendItems(oids.data());
+        }
+        else {
+            mafwPlaylist->insertItems(oids.data(), row);
+        }
     }
     
     void connectSignals() {
@@ -165,214 +517,403 @@ public:
         _q_onPositionChanged(gconfItem->value().toInt());
     }
     
-    void _q_onItemsReady(QString objectId, GHashTable* metadata, guint index) {
-        if (!metadata) {
+    void flushUpdates() {
+        Q_Q(QchNowPlayingModel);
+        
+        if (updateTimerId) {
+            q->killTimer(updateTimerId);
+            updateTimerId = 0;
+        }
+        
+        if (updatedRows.isEmpty()) {
+            return;
+        }
+        
+        QList<int> rows = updatedRows.toList();
+        updatedRows.clear();
+        qSort(rows);
+        
+        int first = rows.first();
+        int last = first;
+        
+        for (int i = 1; i < rows.size(); i++) {
+            const int row = rows.at(i);
+            
+            if (row != last + 1) {
+                emit q->dataChanged(q->index(first, 0), q->index(last, 0));
+#ifdef NOWPLAYINGMODEL_DEBUG
+                loadDataNotifications++;
+#endif
+                first = row;
+            }
+            
+            last = row;
+        }
+        
+        emit q->dataChanged(q->index(first, 0), q->index(last, 0));
+#ifdef NOWPLAYINGMODEL_DEBUG
+        loadDataNotifications++;
+#endif
+    }
+    
+    void setRequiredRoles(const QStringList &names) {
+        requiredRoles = names;
+        metadataKeys.clear();
+        
+        if (names.isEmpty()) {
+            requiredMask = ALL_ROLES;
+            queryManager->setMetadataKeys(0);
             return;
         }
         
         Q_Q(QchNowPlayingModel);
         
-        QStandardItem *item = q->item(index);
+        const QHash<int, QByteArray> roles = q->roleNames();
+        requiredMask = roleBit(QchNowPlayingModel::IdRole);
+        
+        foreach (const QString &name, names) {
+            const int role = roles.key(name.toUtf8(), -1);
+            
+            if (role == -1) {
+                qmlInfo(q) << QchNowPlayingModel::tr("Role %1 does not exist").arg(name);
+                continue;
+            }
+            
+            requiredMask |= roleBit(role);
+            
+            for (int i = 0; i < 2; i++) {
+                const char *key = ROLE_METADATA_KEYS[role - QchNowPlayingModel::AlbumArtistRole][i];
+                
+                if ((key) && (!metadataKeys.contains(key))) {
+                    metadataKeys.append(key);
+                }
+            }
+        }
+        
+        metadataKeys.append(0);
+        queryManager->setMetadataKeys(metadataKeys.constData());
+    }
+    
+    void requestRoles(int row) const {
+        QchNowPlayingItem *item = items.at(row);
+        
+        if (item->lazyRequested) {
+            return;
+        }
+        
+        item->lazyRequested = true;
+        lazyRows.insert(row);
+        
+        if (!lazyFetchPending) {
+            lazyFetchPending = true;
+            QMetaObject::invokeMethod(q_ptr, "_q_fetchLazyRows", Qt::QueuedConnection);
+        }
+    }
+    
+    void _q_fetchLazyRows() {
+        lazyFetchPending = false;
         
-        if (!item) {
+        if (lazyRows.isEmpty()) {
             return;
         }
         
-        QString album;
-        QString artist;
-        int audioBitRate;
-        QString audioCodec;
-        QString comment;
-        QString composer;
-        QString copyright;
-        QString coverArtUrl;
-        qint64 date;
-        QString description;
-        int duration;
-        QString genre;
-        QString keywords;
-        qint64 lastPlayed;
-        QString lastThumbnailUrl;
-        QString lyrics;
-        QString mimeType;
-        QString organization;
-        int playCount;
-        int resX;
-        int resY;
-        int resumePosition;
-        int size;
-        QString thumbnailUrl;
-        QString title;
-        int trackNumber;
-        QString url;
-        int videoBitRate;
-        QString videoCodec;
-        int videoFrameRate;
-        int year;
-        GValue *v;
+        QList<int> rows = lazyRows.toList();
+        lazyRows.clear();
+        qSort(rows);
         
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_ALBUM);
-        album = v ? QString::fromUtf8(g_value_get_string(v)) : "";
+        int first = rows.first();
+        int last = first;
         
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_ARTIST);
-        artist = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_AUDIO_BITRATE);
-        audioBitRate = v ? g_value_get_int (v) : 0;
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_AUDIO_CODEC);
-        audioCodec = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_COMMENT);
-        comment = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_COMPOSER);
-        composer = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_COPYRIGHT);
-        copyright = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_ALBUM_ART_URI);
-        coverArtUrl = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_MODIFIED);
-        date = v ? g_value_get_int64 (v) : 0;
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_DESCRIPTION);
-        description = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_DURATION);
-        duration = v ? g_value_get_int (v) : 0;
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_GENRE);
-        genre = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_TAGS);
-        keywords = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_LAST_PLAYED);
-        lastPlayed = v ? g_value_get_int64 (v) : 0;
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_PAUSED_THUMBNAIL_URI);
-        lastThumbnailUrl = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_LYRICS);
-        lyrics = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_MIME);
-        mimeType = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_ORGANIZATION);
-        organization = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_PLAY_COUNT);
-        playCount = v ? g_value_get_int (v) : 0;
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_RES_X);
-        resX = v ? g_value_get_int (v) : 0;
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_RES_Y);
-        resY = v ? g_value_get_int (v) : 0;
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_PAUSED_POSITION);
-        resumePosition = v ? g_value_get_int (v) : 0;
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_FILESIZE);
-        size = v ? g_value_get_int (v) : 0;
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_THUMBNAIL_URI);
-        thumbnailUrl = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_TITLE);
-        title = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_TRACK);
-        trackNumber = v ? g_value_get_int (v) : 0;
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_URI);
-        url = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_VIDEO_BITRATE);
-        videoBitRate = v ? g_value_get_int (v) : 0;
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_VIDEO_CODEC);
-        videoCodec = v ? QString::fromUtf8(g_value_get_string(v)) : "";
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_VIDEO_FRAMERATE);
-        videoFrameRate = v ? g_value_get_int (v) : 0;
-        
-        v = mafw_metadata_first(metadata, MAFW_METADATA_KEY_YEAR);
-        year = v ? g_value_get_int (v) : 0;
+        for (int i = 1; i < rows.size(); i++) {
+            const int row = rows.at(i);
+            
+            if (row != last + 1) {
+                lazyQueryManager->getItems(first, last);
+                first = row;
+            }
+            
+            last = row;
+        }
         
-        item->setText(title);
-        item->setData(artist, QchNowPlayingModel::AlbumArtistRole);
-        item->setData(album, QchNowPlayingModel::AlbumTitleRole);
-        item->setData(artist, QchNowPlayingModel::ArtistRole);
-        item->setData(audioBitRate, QchNowPlayingModel::AudioBitRateRole);
-        item->setData(audioCodec, QchNowPlayingModel::AudioCodecRole);
-        item->setData(comment, QchNowPlayingModel::CommentRole);
-        item->setData(composer, QchNowPlayingModel::ComposerRole);
-        item->setData(copyright, QchNowPlayingModel::CopyrightRole);
-        item->setData(coverArtUrl, QchNowPlayingModel::CoverArtUrlRole);
-        item->setData(date, QchNowPlayingModel::DateRole);
-        item->setData(description, QchNowPlayingModel::DescriptionRole);
-        item->setData(duration, QchNowPlayingModel::DurationRole);
-        item->setData(genre, QchNowPlayingModel::GenreRole);
-        item->setData(keywords, QchNowPlayingModel::KeywordsRole);
-        item->setData(lastPlayed, QchNowPlayingModel::LastPlayedRole);
-        item->setData(lastThumbnailUrl, QchNowPlayingModel::LastThumbnailUrlRole);
-        item->setData(lyrics, QchNowPlayingModel::LyricsRole);
-        item->setData(mimeType, QchNowPlayingModel::MimeTypeRole);
-        item->setData(organization, QchNowPlayingModel::OrganizationRole);
-        item->setData(playCount, QchNowPlayingModel::PlayCountRole);
-        item->setData(QSize(resX, resY), QchNowPlayingModel::ResolutionRole);
-        item->setData(resumePosition, QchNowPlayingModel::ResumePositionRole);
-        item->setData(size, QchNowPlayingModel::SizeRole);
-        item->setData(thumbnailUrl, QchNowPlayingModel::ThumbnailUrlRole);
-        item->setData(title, QchNowPlayingModel::TitleRole);
-        item->setData(trackNumber, QchNowPlayingModel::TrackNumberRole);
-        item->setData(url, QchNowPlayingModel::UrlRole);
-        item->setData(videoBitRate, QchNowPlayingModel::VideoBitRateRole);
-        item->setData(videoCodec, QchNowPlayingModel::VideoCodecRole);
-        item->setData(videoFrameRate, QchNowPlayingModel::VideoFrameRateRole);
-        item->setData(year, QchNowPlayingModel::YearRole);
-    };
+        lazyQueryManager->getItems(first, last);
+    }
+    
+    void updateItem(guint index, GHashTable *metadata, quint32 mask) {
+        if ((!metadata) || (index >= uint(items.size()))) {
+            return;
+        }
+        
+        Q_Q(QchNowPlayingModel);
+        
+        QchNowPlayingItem *item = items.at(index);
+        
+        if (mask & roleBit(QchNowPlayingModel::TitleRole)) {
+            item->title = metadataString(metadata, MAFW_METADATA_KEY_TITLE);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::ArtistRole)) {
+            item->artist = intern(metadataString(metadata, MAFW_METADATA_KEY_ARTIST));
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::AlbumTitleRole)) {
+            item->albumTitle = intern(metadataString(metadata, MAFW_METADATA_KEY_ALBUM));
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::GenreRole)) {
+            item->genre = intern(metadataString(metadata, MAFW_METADATA_KEY_GENRE));
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::AudioCodecRole)) {
+            item->audioCodec = intern(metadataString(metadata, MAFW_METADATA_KEY_AUDIO_CODEC));
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::VideoCodecRole)) {
+            item->videoCodec = intern(metadataString(metadata, MAFW_METADATA_KEY_VIDEO_CODEC));
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::MimeTypeRole)) {
+            item->mimeType = intern(metadataString(metadata, MAFW_METADATA_KEY_MIME));
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::UrlRole)) {
+            item->url = metadataString(metadata, MAFW_METADATA_KEY_URI);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::CoverArtUrlRole)) {
+            item->coverArtUrl = intern(metadataString(metadata, MAFW_METADATA_KEY_ALBUM_ART_URI));
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::ThumbnailUrlRole)) {
+            item->thumbnailUrl = metadataString(metadata, MAFW_METADATA_KEY_THUMBNAIL_URI);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::LastThumbnailUrlRole)) {
+            item->lastThumbnailUrl = metadataString(metadata, MAFW_METADATA_KEY_PAUSED_THUMBNAIL_URI);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::DateRole)) {
+            item->date = metadataInt64(metadata, MAFW_METADATA_KEY_MODIFIED);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::LastPlayedRole)) {
+            item->lastPlayed = metadataInt64(metadata, MAFW_METADATA_KEY_LAST_PLAYED);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::AudioBitRateRole)) {
+            item->audioBitRate = metadataInt(metadata, MAFW_METADATA_KEY_AUDIO_BITRATE);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::DurationRole)) {
+            item->duration = metadataInt(metadata, MAFW_METADATA_KEY_DURATION);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::PlayCountRole)) {
+            item->playCount = metadataInt(metadata, MAFW_METADATA_KEY_PLAY_COUNT);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::ResumePositionRole)) {
+            item->resumePosition = metadataInt(metadata, MAFW_METADATA_KEY_PAUSED_POSITION);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::SizeRole)) {
+            item->size = metadataInt(metadata, MAFW_METADATA_KEY_FILESIZE);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::VideoBitRateRole)) {
+            item->videoBitRate = metadataInt(metadata, MAFW_METADATA_KEY_VIDEO_BITRATE);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::ResolutionRole)) {
+            item->resX = metadataInt(metadata, MAFW_METADATA_KEY_RES_X);
+            item->resY = metadataInt(metadata, MAFW_METADATA_KEY_RES_Y);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::TrackNumberRole)) {
+            item->trackNumber = metadataInt(metadata, MAFW_METADATA_KEY_TRACK);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::VideoFrameRateRole)) {
+            item->videoFrameRate = metadataInt(metadata, MAFW_METADATA_KEY_VIDEO_FRAMERATE);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::YearRole)) {
+            item->year = metadataInt(metadata, MAFW_METADATA_KEY_YEAR);
+        }
+        
+        QchNowPlayingItemExtra extra = item->extra ? *item->extra : QchNowPlayingItemExtra();
+        
+        if (mask & roleBit(QchNowPlayingModel::CommentRole)) {
+            extra.comment = metadataString(metadata, MAFW_METADATA_KEY_COMMENT);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::ComposerRole)) {
+            extra.composer = intern(metadataString(metadata, MAFW_METADATA_KEY_COMPOSER));
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::CopyrightRole)) {
+            extra.copyright = metadataString(metadata, MAFW_METADATA_KEY_COPYRIGHT);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::DescriptionRole)) {
+            extra.description = metadataString(metadata, MAFW_METADATA_KEY_DESCRIPTION);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::KeywordsRole)) {
+            extra.keywords = metadataString(metadata, MAFW_METADATA_KEY_TAGS);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::LyricsRole)) {
+            extra.lyrics = metadataString(metadata, MAFW_METADATA_KEY_LYRICS);
+        }
+        
+        if (mask & roleBit(QchNowPlayingModel::OrganizationRole)) {
+            extra.organization = intern(metadataString(metadata, MAFW_METADATA_KEY_ORGANIZATION));
+        }
+        
+        setItemExtra(item, extra);
+        item->roles |= mask;
+        item->loaded = true;
+        writeCachedItem(item);
+        updatedRows.insert(index);
+        
+        if (!updateTimerId) {
+            updateTimerId = q->startTimer(UPDATE_INTERVAL);
+        }
+    }
+    
+    void _q_onItemsReady(QString, GHashTable* metadata, guint index) {
+        updateItem(index, metadata, requiredMask);
+#ifdef NOWPLAYINGMODEL_DEBUG
+        if (loadPending > 0) {
+            if (!loadMetadataStarted) {
+                loadMetadataStarted = true;
+                qDebug() << "QchNowPlayingModel: first metadata after" << loadTimer.elapsed() << "ms";
+            }
+            
+            if (--loadPending == 0) {
+                traceLoadComplete();
+            }
+        }
+#endif
+    }
+    
+    void _q_onLazyItemsReady(QString, GHashTable* metadata, guint index) {
+        updateItem(index, metadata, ALL_ROLES);
+    }
+    
+    // Rows whose lazy query completed without metadata, or was dropped, may be requested again
+    void _q_onLazyRangeFinished(int first, int last) {
+        last = qMin(last, items.size() - 1);
+        
+        for (int i = qMax(0, first); i <= last; i++) {
+            items.at(i)->lazyRequested = false;
+        }
+    }
+    
+    void _q_onItemsComplete() {
+        flushUpdates();
+    }
     
     void _q_onItemsChanged(guint from, guint nremove, guint nreplace) {
         Q_Q(QchNowPlayingModel);
+        
+        flushUpdates();
+        _q_fetchLazyRows();
 
         bool synthetic = from == (uint) -1;
 
         if (synthetic) {
-            q->clear();
+            clear();
             from = 0;
             nreplace = mafwPlaylist->getSize();
+#ifdef NOWPLAYINGMODEL_DEBUG
+            loadTimer.start();
+            loadPending = 0;
+            loadMetadataStarted = false;
+            loadDataNotifications = 0;
+#endif
         }
 
         if (nremove > 0) {
-            q->removeRows(from, nremove);
+            const int last = qMin<int>(from + nremove, items.size()) - 1;
+            
+            if (last >= int(from)) {
+                q->beginRemoveRows(QModelIndex(), from, last);
+                
+                for (int i = last; i >= int(from); i--) {
+                    delete items.takeAt(i);
+                }
+                
+                q->endRemoveRows();
+            }
+            
             emit q->countChanged();
             queryManager->itemsRemoved(from, nremove);
+            lazyQueryManager->itemsRemoved(from, nremove);
         }
         else if (nreplace > 0) {
-            gchar** items = mafw_playlist_get_items(mafwPlaylist->mafw_playlist, from, from + nreplace - 1, NULL);
+            gchar** ids = mafw_playlist_get_items(mafwPlaylist->mafw_playlist, from, from + nreplace - 1, NULL);
+            const int count = ids ? g_strv_length(ids) : 0;
+            from = qMin<int>(from, items.size());
+            QList<QchNowPlayingItem*> inserted;
+            QVector<bool> fresh(count);
+            inserted.reserve(count);
+            
+            // Rows found in the persistent cache are populated immediately
+            for (int i = 0; i < count; i++) {
+                QchNowPlayingItem *item = new QchNowPlayingItem(QString::fromUtf8(ids[i]));
+                fresh[i] = readCachedItem(item);
+                inserted.append(item);
+            }
             
-            for (int i = 0; items[i] != NULL; i++) {
-                QStandardItem *item = new QStandardItem;
-                item->setData(0, QchNowPlayingModel::DurationRole);
-                item->setData(QString::fromUtf8(items[i]), QchNowPlayingModel::IdRole);
-                q->insertRow(from + i, item);
+            if (count > 0) {
+                q->beginInsertRows(QModelIndex(), from, from + count - 1);
+                
+                for (int i = 0; i < count; i++) {
+                    items.insert(from + i, inserted.at(i));
+                }
+                
+                q->endInsertRows();
             }
             
             emit q->countChanged();
             
-            g_strfreev(items);
+            g_strfreev(ids);
+#ifdef NOWPLAYINGMODEL_DEBUG
+            if (synthetic) {
+                loadPending = fresh.count(false);
+                qDebug() << "QchNowPlayingModel:" << count << "rows inserted after" << loadTimer.elapsed() << "ms,"
+                         << count - loadPending << "from cache";
+                
+                if (loadPending == 0) {
+                    traceLoadComplete();
+                }
+            }
+#endif
 
             if (!synthetic) {
                 queryManager->itemsInserted(from, nreplace);
+                lazyQueryManager->itemsInserted(from, nreplace);
             }
             
-            queryManager->getItems(from, from + nreplace - 1);
+            // Only rows that are missing from the cache or stale are queried from MAFW
+            int start = -1;
+            
+            for (int i = 0; i < count; i++) {
+                if (!fresh.at(i)) {
+                    if (start == -1) {
+                        start = i;
+                    }
+                }
+                else if (start != -1) {
+                    queryManager->getItems(from + start, from + i - 1);
+                    start = -1;
+                }
+            }
+            
+            if (start != -1) {
+                queryManager->getItems(from + start, from + count - 1);
+            }
         }
 
         if (synthetic) {
@@ -382,16 +923,34 @@ public:
         mafwRenderer->getStatus();
     }
     
+#ifdef NOWPLAYINGMODEL_DEBUG
+    void traceLoadComplete() {
+        flushUpdates();
+        qDebug() << "QchNowPlayingModel:" << items.size() << "rows loaded after" << loadTimer.elapsed() << "ms,"
+                 << loadDataNotifications << "dataChanged notifications, peak memory" << peakMemoryUsage() << "kB";
+    }
+#endif
+    
     void _q_onItemMoved(guint from, guint to) {
         Q_Q(QchNowPlayingModel);
         
+        flushUpdates();
+        _q_fetchLazyRows();
         queryManager->itemsRemoved(from, 1);
         queryManager->itemsInserted(to, 1);
+        lazyQueryManager->itemsRemoved(from, 1);
+        lazyQueryManager->itemsInserted(to, 1);
+        
+        const int count = items.size();
 
-        if (QStandardItem *item = q->item(to)) {
-            if (item->data(QchNowPlayingModel::DurationRole) == 0) {
-                queryManager->getItems(to, to);
-            }
+        if ((from != to) && (from < uint(count)) && (to < uint(count))) {
+            q->beginMoveRows(QModelIndex(), from, from, QModelIndex(), to > from ? to + 1 : to);
+            items.move(from, to);
+            q->endMoveRows();
+        }
+
+        if ((to < uint(count)) && (!items.at(to)->loaded)) {
+            queryManager->getItems(to, to);
         }
 
         mafwRenderer->getStatus();
@@ -399,11 +958,15 @@ public:
     
     QchNowPlayingModel *q_ptr;
     
+    QList<QchNowPlayingItem*> items;
+    QSet<QString> strings;
+    QSet<int> updatedRows;
+    
     mutable MafwRegistryAdapter *mafwRegistry;
     mutable MafwRendererAdapter *mafwRenderer;
     mutable MafwPlaylistAdapter *mafwPlaylist;
-    mutable MafwSourceAdapter *mafwTrackerSource;
     mutable PlaylistQueryManager *queryManager;
+    mutable PlaylistQueryManager *lazyQueryManager;
     
     GConfItem *gconfItem;
     
@@ -411,6 +974,23 @@ public:
     
     int position;
     
+    int updateTimerId;
+    int cacheTimerId;
+    
+    QStringList requiredRoles;
+    QVector<const char*> metadataKeys;
+    quint32 requiredMask;
+    
+    mutable QSet<int> lazyRows;
+    mutable bool lazyFetchPending;
+    
+#ifdef NOWPLAYINGMODEL_DEBUG
+    QElapsedTimer loadTimer;
+    int loadPending;
+    int loadDataNotifications;
+    bool loadMetadataStarted;
+#endif
+    
     bool repeat;
     bool shuffle;
     
@@ -480,7 +1060,7 @@ public:
     \sa Audio
 */
 QchNowPlayingModel::QchNowPlayingModel(QObject *parent) :
-    QStandardItemModel(parent),
+    QAbstractListModel(parent),
     d_ptr(new QchNowPlayingModelPrivate(this))
 {
     Q_D(QchNowPlayingModel);
@@ -488,8 +1068,8 @@ QchNowPlayingModel::QchNowPlayingModel(QObject *parent) :
     d->mafwRegistry = MafwRegistryAdapter::get();
     d->mafwRenderer = d->mafwRegistry->renderer();
     d->mafwPlaylist = d->mafwRegistry->playlist();
-    d->mafwTrackerSource = d->mafwRegistry->source(MafwRegistryAdapter::Tracker);
     d->queryManager = new PlaylistQueryManager(this, d->mafwPlaylist);
+    d->lazyQueryManager = new PlaylistQueryManager(this, d->mafwPlaylist);
     d->gconfItem = new GConfItem("/apps/mediaplayer/last_playing_song", this);
     
     QHash<int, QByteArray> roles;
@@ -575,7 +1155,7 @@ void QchNowPlayingModel::setMediaType(QchMediaType::Type type) {
         emit mediaTypeChanged();
         
         if (d->complete) {
-            clear();
+            d->clear();
             d->_q_assignPlaylist();
         }
     }
@@ -640,6 +1220,124 @@ void QchNowPlayingModel::setShuffled(bool shuffled) {
     }
 }
 
+int QchNowPlayingModel::rowCount(const QModelIndex &parent) const {
+    Q_D(const QchNowPlayingModel);
+    
+    return parent.isValid() ? 0 : d->items.size();
+}
+
+QVariant QchNowPlayingModel::data(const QModelIndex &index, int role) const {
+    Q_D(const QchNowPlayingModel);
+    
+    if ((!index.isValid()) || (index.row() >= d->items.size())) {
+        return QVariant();
+    }
+    
+    const QchNowPlayingItem *item = d->items.at(index.row());
+    
+    if ((role >= AlbumArtistRole) && (role <= YearRole) && (!(item->roles & roleBit(role)))
+        && (!(d->requiredMask & ~VOLATILE_ROLES & roleBit(role)))) {
+        d->requestRoles(index.row());
+    }
+    
+    switch (role) {
+    case Qt::DisplayRole:
+    case TitleRole:
+        return item->title;
+    case AlbumArtistRole:
+    case ArtistRole:
+        return item->artist;
+    case AlbumTitleRole:
+        return item->albumTitle;
+    case AudioBitRateRole:
+        return item->audioBitRate;
+    case AudioCodecRole:
+        return item->audioCodec;
+    case CommentRole:
+        return item->extra ? item->extra->comment : QString();
+    case ComposerRole:
+        return item->extra ? item->extra->composer : QString();
+    case CopyrightRole:
+        return item->extra ? item->extra->copyright : QString();
+    case CoverArtUrlRole:
+        return item->coverArtUrl;
+    case DateRole:
+        return item->date;
+    case DescriptionRole:
+        return item->extra ? item->extra->description : QString();
+    case DurationRole:
+        return item->duration;
+    case GenreRole:
+        return item->genre;
+    case IdRole:
+        return item->id;
+    case KeywordsRole:
+        return item->extra ? item->extra->keywords : QString();
+    case LastPlayedRole:
+        return item->lastPlayed;
+    case LastThumbnailUrlRole:
+        return item->lastThumbnailUrl;
+    case LyricsRole:
+        return item->extra ? item->extra->lyrics : QString();
+    case MimeTypeRole:
+        return item->mimeType;
+    case OrganizationRole:
+        return item->extra ? item->extra->organization : QString();
+    case PlayCountRole:
+        return item->playCount;
+    case ResolutionRole:
+        return QSize(item->resX, item->resY);
+    case ResumePositionRole:
+        return item->resumePosition;
+    case SizeRole:
+        return item->size;
+    case ThumbnailUrlRole:
+        return item->thumbnailUrl;
+    case TrackNumberRole:
+        return int(item->trackNumber);
+    case UrlRole:
+        return item->url;
+    case VideoBitRateRole:
+        return item->videoBitRate;
+    case VideoCodecRole:
+        return item->videoCodec;
+    case VideoFrameRateRole:
+        return int(item->videoFrameRate);
+    case YearRole:
+        return int(item->year);
+    default:
+        return QVariant();
+    }
+}
+
+/*!
+    \brief The names of the roles that are loaded for every item.
+    
+    Only the metadata needed for these roles is requested when items are loaded. Other roles are loaded 
+    on demand when they are first read for an item. An empty list (the default) loads all roles.
+    
+    Example:
+    
+    \code
+    NowPlayingModel {
+        requiredRoles: ["title", "artist", "duration"]
+    }
+    \endcode
+*/
+QStringList QchNowPlayingModel::requiredRoles() const {
+    Q_D(const QchNowPlayingModel);
+    
+    return d->requiredRoles;
+}
+
+void QchNowPlayingModel::setRequiredRoles(const QStringList &roles) {
+    if (roles != requiredRoles()) {
+        Q_D(QchNowPlayingModel);
+        d->setRequiredRoles(roles);
+        emit requiredRolesChanged();
+    }
+}
+
 /*!
     \brief Adds the source with the specifed \a uri to the playlist.
     
@@ -648,9 +1346,21 @@ void QchNowPlayingModel::setShuffled(bool shuffled) {
     \sa appendItem()
 */
 void QchNowPlayingModel::appendSource(const QString &uri) {
+    appendItem(MediaObjectId::fromUri(uri));
+}
+
+/*!
+    \brief Adds the sources with the specified \a uris to the end of the playlist.
+    
+    All sources are added to the MAFW playlist in a single request, which is more efficient than calling 
+    appendSource() for each URI.
+    
+    \sa appendSource(), insertSources()
+*/
+void QchNowPlayingModel::appendSources(const QStringList &uris) {
     Q_D(QchNowPlayingModel);
     
-    appendItem(d->uriToId(uri));
+    d->enqueueSources(-1, uris);
 }
 
 /*!
@@ -675,9 +1385,18 @@ void QchNowPlayingModel::appendItem(const QString &id) {
     \sa insertItem()
 */
 void QchNowPlayingModel::insertSource(int row, const QString &uri) {
+    insertItem(row, MediaObjectId::fromUri(uri));
+}
+
+/*!
+    \brief Inserts the sources with the specified \a uris before \a row.
+    
+    \sa insertSource(), appendSources()
+*/
+void QchNowPlayingModel::insertSources(int row, const QStringList &uris) {
     Q_D(QchNowPlayingModel);
     
-    insertItem(row, d->uriToId(uri));
+    d->enqueueSources(row, uris);
 }
 
 /*!
@@ -714,6 +1433,69 @@ void QchNowPlayingModel::removeItem(int row) {
     d->mafwPlaylist->removeItem(row);
 }
 
+/*!
+    \brief Prioritises metadata loading for the rows between \a first and \a last.
+    
+    \a first and \a last should be the first and last rows visible in the view, and \a velocity 
+    the scrolling speed in rows per second (positive when scrolling towards the end of the playlist). 
+    Metadata is loaded ahead of the direction of travel, and pending requests for rows that have been 
+    scrolled past are cancelled.
+    
+    Example:
+    
+    \code
+    ListView {
+        id: view
+        
+        model: NowPlayingModel {
+            id: playlist
+        }
+        onContentYChanged: playlist.prefetch(indexAt(0, contentY), indexAt(0, contentY + height - 1),
+                                             verticalVelocity / 70)
+    }
+    \endcode
+*/
+void QchNowPlayingModel::prefetch(int first, int last, qreal velocity) {
+    Q_D(QchNowPlayingModel);
+    
+    const int count = d->items.size();
+    
+    if (count == 0) {
+        return;
+    }
+    
+    if (first < 0) {
+        first = 0;
+    }
+    
+    if ((last < first) || (last >= count)) {
+        last = count - 1;
+    }
+    
+    d->queryManager->setViewport(first, last, velocity);
+    
+    // Re-request rows around the viewport whose requests were previously cancelled
+    const int visible = last - first + 1;
+    const int end = qMin(count - 1, last + visible);
+    int start = -1;
+    
+    for (int i = qMax(0, first - visible); i <= end; i++) {
+        if (!d->items.at(i)->loaded) {
+            if (start == -1) {
+                start = i;
+            }
+        }
+        else if (start != -1) {
+            d->queryManager->getItems(start, i - 1);
+            start = -1;
+        }
+    }
+    
+    if (start != -1) {
+        d->queryManager->getItems(start, end);
+    }
+}
+
 /*!
     \brief Returns the value of the property with name \a name of the item at \a row.
     
@@ -839,7 +1621,7 @@ void QchNowPlayingModel::clearItems() {
 void QchNowPlayingModel::loadItems() {
     Q_D(QchNowPlayingModel);
     
-    clear();
+    d->clear();
     d->_q_assignPlaylist();
     d->_q_onItemsChanged(-1, 0, 0);
 }
@@ -883,6 +1665,11 @@ void QchNowPlayingModel::componentComplete() {
     
     connect(d->queryManager, SIGNAL(onGetItems(QString, GHashTable*, guint)), 
                   this, SLOT(_q_onItemsReady(QString, GHashTable*, guint)));
+    connect(d->queryManager, SIGNAL(getItemsComplete()), this, SLOT(_q_onItemsComplete()));
+    connect(d->lazyQueryManager, SIGNAL(onGetItems(QString, GHashTable*, guint)), 
+                  this, SLOT(_q_onLazyItemsReady(QString, GHashTable*, guint)));
+    connect(d->lazyQueryManager, SIGNAL(getItemsComplete()), this, SLOT(_q_onItemsComplete()));
+    connect(d->lazyQueryManager, SIGNAL(rangeFinished(int, int)), this, SLOT(_q_onLazyRangeFinished(int, int)));
                   
     connect(d->mafwPlaylist, SIGNAL(playlistChanged()), this, SLOT(_q_onPlaylistChanged()));
     
@@ -894,4 +1681,18 @@ void QchNowPlayingModel::componentComplete() {
     }
 }
 
+void QchNowPlayingModel::timerEvent(QTimerEvent *event) {
+    Q_D(QchNowPlayingModel);
+    
+    if (event->timerId() == d->updateTimerId) {
+        d->flushUpdates();
+    }
+    else if (event->timerId() == d->cacheTimerId) {
+        d->saveCache();
+    }
+    else {
+        QAbstractListModel::timerEvent(event);
+    }
+}
+
 #include "moc_qchnowplayingmodel.cpp"
@@ -18,19 +18,21 @@
 #define QCHPLAYBACKMODEL_H
 
 #include "qchmediatype.h"
-#include <QStandardItemModel>
+#include <QAbstractListModel>
+#include <QStringList>
 #include <QDeclarativeParserStatus>
 #include <qdeclarative.h>
 
 class QchNowPlayingModelPrivate;
 
-class QchNowPlayingModel : public QStandardItemModel, public QDeclarativeParserStatus
+class QchNowPlayingModel : public QAbstractListModel, public QDeclarativeParserStatus
 {
     Q_OBJECT
     
     Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
     Q_PROPERTY(QchMediaType::Type mediaType READ mediaType WRITE setMediaType NOTIFY mediaTypeChanged)
     Q_PROPERTY(int position READ position WRITE setPosition NOTIFY positionChanged)
+    Q_PROPERTY(QStringList requiredRoles READ requiredRoles WRITE setRequiredRoles NOTIFY requiredRolesChanged)
     Q_PROPERTY(bool repeat READ isRepeat WRITE setRepeat NOTIFY repeatChanged)
     Q_PROPERTY(bool shuffle READ isShuffled WRITE setShuffled NOTIFY shuffledChanged)
     
@@ -81,18 +83,29 @@ public:
     int position() const;
     void setPosition(int pos);
     
+    QStringList requiredRoles() const;
+    void setRequiredRoles(const QStringList &roles);
+    
     bool isRepeat() const;
     void setRepeat(bool repeat);
     
     bool isShuffled() const;
     void setShuffled(bool shuffle);
     
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    
     Q_INVOKABLE void appendSource(const QString &uri);
+    Q_INVOKABLE void appendSources(const QStringList &uris);
     Q_INVOKABLE void appendItem(const QString &id);
     Q_INVOKABLE void insertSource(int row, const QString &uri);
+    Q_INVOKABLE void insertSources(int row, const QStringList &uris);
     Q_INVOKABLE void insertItem(int row, const QString &id);
     Q_INVOKABLE void moveItem(int from, int to);
     Q_INVOKABLE void removeItem(int row);
+    
+    Q_INVOKABLE void prefetch(int first, int last, qreal velocity = 0);
         
     Q_INVOKABLE QVariant property(int row, const QString &name);
     
@@ -108,6 +121,7 @@ Q_SIGNALS:
     void mediaTypeChanged();
     void positionChanged();
     void ready();
+    void requiredRolesChanged();
     void repeatChanged();
     void shuffledChanged();
     
@@ -115,6 +129,8 @@ private:
     virtual void classBegin();
     virtual void componentComplete();
     
+    virtual void timerEvent(QTimerEvent *event);
+    
     QScopedPointer<QchNowPlayingModelPrivate> d_ptr;
     
     Q_DECLARE_PRIVATE(QchNowPlayingModel)
@@ -127,6 +143,10 @@ private:
     Q_PRIVATE_SLOT(d_func(), void _q_onStatusChanged(MafwPlaylist*,uint,MafwPlayState,const char*,QString))
     Q_PRIVATE_SLOT(d_func(), void _q_onGConfValueChanged());
     Q_PRIVATE_SLOT(d_func(), void _q_onItemsReady(QString,GHashTable*,guint))
+    Q_PRIVATE_SLOT(d_func(), void _q_onLazyItemsReady(QString,GHashTable*,guint))
+    Q_PRIVATE_SLOT(d_func(), void _q_onLazyRangeFinished(int,int))
+    Q_PRIVATE_SLOT(d_func(), void _q_onItemsComplete())
+    Q_PRIVATE_SLOT(d_func(), void _q_fetchLazyRows())
     Q_PRIVATE_SLOT(d_func(), void _q_onItemsChanged(guint,guint,guint))
     Q_PRIVATE_SLOT(d_func(), void _q_onItemMoved(guint,guint))
 };
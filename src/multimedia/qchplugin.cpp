@@ -16,7 +16,9 @@
 
 #include "qchplugin.h"
 #include "metadatawatcher.h"
+#include "playbackstatistics.h"
 #include "qchaudioplayer.h"
+#include "qchmedialibrarymodel.h"
 #include "qchnowplayingmodel.h"
 #include <QDeclarativeEngine>
 #include <libmafw/mafw-log.h>
@@ -36,8 +38,10 @@ void QchPlugin::registerTypes(const char *uri) {
     qmlRegisterUncreatableType<QchMediaStatus>(uri, 1, 0, "MediaStatus", "");
     qmlRegisterUncreatableType<QchMediaType>(uri, 1, 0, "MediaType", "");
     qmlRegisterUncreatableType<MetadataWatcher>(uri, 1, 0, "MetadataWatcher", "");
+    qmlRegisterUncreatableType<PlaybackStatistics>(uri, 1, 0, "PlaybackStatistics", "");
 
     qmlRegisterType<QchAudioPlayer>(uri, 1, 0, "Audio");
+    qmlRegisterType<QchMediaLibraryModel>(uri, 1, 0, "MediaLibraryModel");
     qmlRegisterType<QchNowPlayingModel>(uri, 1, 0, "NowPlayingModel");
 }
 
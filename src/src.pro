@@ -6,4 +6,6 @@ SUBDIRS = \
     settings \
     utils \
     webkit \
-    components
\ No newline at end of file
+    components
+
+mafw_stub: SUBDIRS += multimedia/benchmark